@@ -0,0 +1,476 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "CoreMinimal.h"
+#include "Misc/AutomationTest.h"
+#include "Misc/PackageName.h"
+#include "Misc/ScopeExit.h"
+#include "UObject/Package.h"
+#include "UObject/Script.h"
+#include "UObject/UnrealType.h"
+#include "GameFramework/Actor.h"
+#include "Engine/Blueprint.h"
+#include "Engine/BlueprintGeneratedClass.h"
+#include "EdGraph/EdGraph.h"
+#include "EdGraphSchema_K2.h"
+#include "K2Node_CallFunction.h"
+#include "K2Node_FunctionEntry.h"
+#include "K2Node_FunctionResult.h"
+#include "K2Node_IfThenElse.h"
+#include "K2Node_VariableGet.h"
+#include "K2Node_VariableSet.h"
+#include "Kismet/KismetMathLibrary.h"
+#include "Kismet2/BlueprintEditorUtils.h"
+#include "Kismet2/KismetEditorUtilities.h"
+#include "Kismet2/CompilerResultsLog.h"
+#include "KismetCompiler.h"
+#include "KismetCompilerModule.h"
+#include "KismetCompiledFunctionContext.h"
+#include "BlueprintCompiledStatement.h"
+#include "BlueprintCompilerCppBackendBytecode.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+/*******************************************************************************
+ * BPBytecodeTranslatorTestsImpl
+ ******************************************************************************/
+
+namespace BPBytecodeTranslatorTestsImpl
+{
+	// The function list of the compiler is protected
+	class FKismetCompilerContextExt : public FKismetCompilerContext
+	{
+	public:
+		TIndirectArray<FKismetFunctionContext>& GetFunctionList() { return FunctionList; }
+	};
+
+	static const FName CounterVariableName(TEXT("Counter"));
+	static const FName IntervalVariableName(TEXT("Interval"));
+	static const FName CountParamName(TEXT("Count"));
+	static const FName BranchFunctionName(TEXT("BranchFunction"));
+	static const FName ConstantFunctionName(TEXT("ConstantFunction"));
+
+	static UBlueprint* CreateTestBlueprint();
+	static void AddBranchFunction(UBlueprint* Blueprint);
+	static void AddConstantFunction(UBlueprint* Blueprint);
+
+	/** Describes the statements of a function the way the VM sees them: no debug sites, jump targets as indices of the described statements. */
+	static TArray<FString> DescribeFunction(const FKismetFunctionContext& FunctionContext);
+	static FString DescribeTerm(const FBPTerminal* Term);
+
+	/** Compiles a duplicate of the Blueprint with the Kismet compiler, as FBlueprintNativeCodeGenUtils::GenerateCppCode does when the bytecode cannot be translated. */
+	static bool DescribeRecompiledFunctions(UBlueprint* Blueprint, TMap<FName, TArray<FString>>& OutFunctions);
+	static bool DescribeTranslatedFunctions(UBlueprint* Blueprint, FAutomationTestBase& Test, TMap<FName, TArray<FString>>& OutFunctions);
+}
+
+//------------------------------------------------------------------------------
+static UBlueprint* BPBytecodeTranslatorTestsImpl::CreateTestBlueprint()
+{
+	const FName PackageName = MakeUniqueObjectName(nullptr, UPackage::StaticClass(), TEXT("/Temp/BPBytecodeTranslatorTests/BP_BytecodeTest"));
+	UPackage* Package = CreatePackage(*PackageName.ToString());
+	UBlueprint* Blueprint = FKismetEditorUtilities::CreateBlueprint(AActor::StaticClass(), Package, *FPackageName::GetShortName(PackageName)
+		, BPTYPE_Normal, UBlueprint::StaticClass(), UBlueprintGeneratedClass::StaticClass());
+	check(Blueprint);
+
+	// the default events would create an ubergraph, which is never translated
+	for (UEdGraph* UbergraphPage : Blueprint->UbergraphPages)
+	{
+		const TArray<UEdGraphNode*> Nodes = UbergraphPage->Nodes;
+		for (UEdGraphNode* Node : Nodes)
+		{
+			FBlueprintEditorUtils::RemoveNode(Blueprint, Node, /*bDontRecompile=*/true);
+		}
+	}
+
+	FEdGraphPinType IntType;
+	IntType.PinCategory = UEdGraphSchema_K2::PC_Int;
+	ensure(FBlueprintEditorUtils::AddMemberVariable(Blueprint, CounterVariableName, IntType));
+
+	FEdGraphPinType RealType;
+	RealType.PinCategory = UEdGraphSchema_K2::PC_Real;
+	RealType.PinSubCategory = UEdGraphSchema_K2::PC_Double;
+	ensure(FBlueprintEditorUtils::AddMemberVariable(Blueprint, IntervalVariableName, RealType));
+
+	AddBranchFunction(Blueprint);
+	AddConstantFunction(Blueprint);
+
+	FBlueprintEditorUtils::MarkBlueprintAsStructurallyModified(Blueprint);
+	FKismetEditorUtilities::CompileBlueprint(Blueprint, EBlueprintCompileOptions::SkipGarbageCollection);
+	return Blueprint;
+}
+
+//------------------------------------------------------------------------------
+static void BPBytecodeTranslatorTestsImpl::AddBranchFunction(UBlueprint* Blueprint)
+{
+	// int BranchFunction(int Count)
+	// {
+	//	if (Count > 5) { Counter = Count + 1; }
+	//	else { SetActorTickInterval(Interval); }	// Interval is a double, the parameter a float
+	//	return Counter;
+	// }
+	const UEdGraphSchema_K2* Schema = GetDefault<UEdGraphSchema_K2>();
+	UEdGraph* Graph = FBlueprintEditorUtils::CreateNewGraph(Blueprint, BranchFunctionName, UEdGraph::StaticClass(), UEdGraphSchema_K2::StaticClass());
+	FBlueprintEditorUtils::AddFunctionGraph<UClass>(Blueprint, Graph, /*bIsUserCreated=*/true, nullptr);
+
+	FEdGraphPinType IntType;
+	IntType.PinCategory = UEdGraphSchema_K2::PC_Int;
+
+	TArray<UK2Node_FunctionEntry*> EntryNodes;
+	Graph->GetNodesOfClass(EntryNodes);
+	check(EntryNodes.Num() == 1);
+	UK2Node_FunctionEntry* EntryNode = EntryNodes[0];
+	EntryNode->CreateUserDefinedPin(CountParamName, IntType, EGPD_Output);
+	UK2Node_FunctionResult* ResultNode = FBlueprintEditorUtils::FindOrCreateFunctionResultNode(EntryNode);
+	check(ResultNode);
+	ResultNode->CreateUserDefinedPin(UEdGraphSchema_K2::PN_ReturnValue, IntType, EGPD_Input);
+
+	FGraphNodeCreator<UK2Node_CallFunction> GreaterNodeCreator(*Graph);
+	UK2Node_CallFunction* GreaterNode = GreaterNodeCreator.CreateNode();
+	GreaterNode->SetFromFunction(UKismetMathLibrary::StaticClass()->FindFunctionByName(GET_FUNCTION_NAME_CHECKED(UKismetMathLibrary, Greater_IntInt)));
+	GreaterNodeCreator.Finalize();
+
+	FGraphNodeCreator<UK2Node_IfThenElse> BranchNodeCreator(*Graph);
+	UK2Node_IfThenElse* BranchNode = BranchNodeCreator.CreateNode();
+	BranchNodeCreator.Finalize();
+
+	FGraphNodeCreator<UK2Node_CallFunction> AddNodeCreator(*Graph);
+	UK2Node_CallFunction* AddNode = AddNodeCreator.CreateNode();
+	AddNode->SetFromFunction(UKismetMathLibrary::StaticClass()->FindFunctionByName(GET_FUNCTION_NAME_CHECKED(UKismetMathLibrary, Add_IntInt)));
+	AddNodeCreator.Finalize();
+
+	FGraphNodeCreator<UK2Node_VariableSet> SetCounterNodeCreator(*Graph);
+	UK2Node_VariableSet* SetCounterNode = SetCounterNodeCreator.CreateNode();
+	SetCounterNode->VariableReference.SetSelfMember(CounterVariableName);
+	SetCounterNodeCreator.Finalize();
+
+	FGraphNodeCreator<UK2Node_VariableGet> GetIntervalNodeCreator(*Graph);
+	UK2Node_VariableGet* GetIntervalNode = GetIntervalNodeCreator.CreateNode();
+	GetIntervalNode->VariableReference.SetSelfMember(IntervalVariableName);
+	GetIntervalNodeCreator.Finalize();
+
+	FGraphNodeCreator<UK2Node_CallFunction> TickIntervalNodeCreator(*Graph);
+	UK2Node_CallFunction* TickIntervalNode = TickIntervalNodeCreator.CreateNode();
+	TickIntervalNode->SetFromFunction(AActor::StaticClass()->FindFunctionByName(GET_FUNCTION_NAME_CHECKED(AActor, SetActorTickInterval)));
+	TickIntervalNodeCreator.Finalize();
+
+	FGraphNodeCreator<UK2Node_VariableGet> GetCounterNodeCreator(*Graph);
+	UK2Node_VariableGet* GetCounterNode = GetCounterNodeCreator.CreateNode();
+	GetCounterNode->VariableReference.SetSelfMember(CounterVariableName);
+	GetCounterNodeCreator.Finalize();
+
+	// data
+	GreaterNode->FindPinChecked(TEXT("B"))->DefaultValue = TEXT("5");
+	AddNode->FindPinChecked(TEXT("B"))->DefaultValue = TEXT("1");
+	ensure(Schema->TryCreateConnection(EntryNode->FindPinChecked(CountParamName), GreaterNode->FindPinChecked(TEXT("A"))));
+	ensure(Schema->TryCreateConnection(EntryNode->FindPinChecked(CountParamName), AddNode->FindPinChecked(TEXT("A"))));
+	ensure(Schema->TryCreateConnection(GreaterNode->GetReturnValuePin(), BranchNode->GetConditionPin()));
+	ensure(Schema->TryCreateConnection(AddNode->GetReturnValuePin(), SetCounterNode->FindPinChecked(CounterVariableName, EGPD_Input)));
+	ensure(Schema->TryCreateConnection(GetIntervalNode->GetValuePin(), TickIntervalNode->FindPinChecked(TEXT("TickInterval"))));
+	ensure(Schema->TryCreateConnection(GetCounterNode->GetValuePin(), ResultNode->FindPinChecked(UEdGraphSchema_K2::PN_ReturnValue)));
+
+	// execution, both branches meet in the Counter assignment, so one of them has to jump
+	ensure(Schema->TryCreateConnection(EntryNode->FindPinChecked(UEdGraphSchema_K2::PN_Then), BranchNode->GetExecPin()));
+	ensure(Schema->TryCreateConnection(BranchNode->GetThenPin(), SetCounterNode->GetExecPin()));
+	ensure(Schema->TryCreateConnection(BranchNode->GetElsePin(), TickIntervalNode->GetExecPin()));
+	ensure(Schema->TryCreateConnection(TickIntervalNode->GetThenPin(), SetCounterNode->GetExecPin()));
+	ensure(Schema->TryCreateConnection(SetCounterNode->GetThenPin(), ResultNode->GetExecPin()));
+}
+
+//------------------------------------------------------------------------------
+static void BPBytecodeTranslatorTestsImpl::AddConstantFunction(UBlueprint* Blueprint)
+{
+	// int ConstantFunction() { return 0; }, its bytecode is replaced by the test
+	UEdGraph* Graph = FBlueprintEditorUtils::CreateNewGraph(Blueprint, ConstantFunctionName, UEdGraph::StaticClass(), UEdGraphSchema_K2::StaticClass());
+	FBlueprintEditorUtils::AddFunctionGraph<UClass>(Blueprint, Graph, /*bIsUserCreated=*/true, nullptr);
+
+	FEdGraphPinType IntType;
+	IntType.PinCategory = UEdGraphSchema_K2::PC_Int;
+
+	TArray<UK2Node_FunctionEntry*> EntryNodes;
+	Graph->GetNodesOfClass(EntryNodes);
+	check(EntryNodes.Num() == 1);
+	UK2Node_FunctionResult* ResultNode = FBlueprintEditorUtils::FindOrCreateFunctionResultNode(EntryNodes[0]);
+	check(ResultNode);
+	ResultNode->CreateUserDefinedPin(UEdGraphSchema_K2::PN_ReturnValue, IntType, EGPD_Input);
+	ensure(GetDefault<UEdGraphSchema_K2>()->TryCreateConnection(EntryNodes[0]->FindPinChecked(UEdGraphSchema_K2::PN_Then), ResultNode->GetExecPin()));
+}
+
+//------------------------------------------------------------------------------
+static FString BPBytecodeTranslatorTestsImpl::DescribeTerm(const FBPTerminal* Term)
+{
+	if (!Term)
+	{
+		return TEXT("none");
+	}
+	if (const FBlueprintCompiledStatement* InlineCall = Term->InlineGeneratedParameter)
+	{
+		return FString::Printf(TEXT("Call(%s)"), InlineCall->FunctionToCall ? *InlineCall->FunctionToCall->GetName() : TEXT("?"));
+	}
+	if (Term->bIsLiteral)
+	{
+		// the values are formatted differently by the compiler and by the bytecode, only the types are compared
+		return (Term->Type.PinSubCategory == UEdGraphSchema_K2::PSC_Self) ? FString(TEXT("self")) : FString::Printf(TEXT("Literal(%s)"), *Term->Type.PinCategory.ToString());
+	}
+	return Term->Name;
+}
+
+//------------------------------------------------------------------------------
+static TArray<FString> BPBytecodeTranslatorTestsImpl::DescribeFunction(const FKismetFunctionContext& FunctionContext)
+{
+	auto IsIgnored = [](const FBlueprintCompiledStatement& Statement)
+	{
+		switch (Statement.Type)
+		{
+		case KCST_Nop:
+		case KCST_Comment:
+		case KCST_DebugSite:
+		case KCST_WireTraceSite:
+		// the VM backend appends the final return itself
+		case KCST_Return:
+			return true;
+		default:
+			return false;
+		}
+	};
+
+	// jumps to an ignored statement land on the next described one
+	TArray<const FBlueprintCompiledStatement*> Described;
+	TMap<const FBlueprintCompiledStatement*, int32> TargetIndices;
+	TArray<const FBlueprintCompiledStatement*> PendingTargets;
+	for (UEdGraphNode* Node : FunctionContext.LinearExecutionList)
+	{
+		const TArray<FBlueprintCompiledStatement*>* NodeStatements = FunctionContext.StatementsPerNode.Find(Node);
+		if (!NodeStatements)
+		{
+			continue;
+		}
+		for (const FBlueprintCompiledStatement* Statement : *NodeStatements)
+		{
+			PendingTargets.Add(Statement);
+			if (IsIgnored(*Statement))
+			{
+				continue;
+			}
+			for (const FBlueprintCompiledStatement* Pending : PendingTargets)
+			{
+				TargetIndices.Add(Pending, Described.Num());
+			}
+			PendingTargets.Reset();
+			Described.Add(Statement);
+		}
+	}
+	for (const FBlueprintCompiledStatement* Pending : PendingTargets)
+	{
+		TargetIndices.Add(Pending, Described.Num());
+	}
+	// a return at the end of the function does nothing
+	while (Described.Num() && (Described.Last()->Type == KCST_GotoReturn))
+	{
+		Described.Pop();
+	}
+
+	TArray<FString> Result;
+	for (const FBlueprintCompiledStatement* Statement : Described)
+	{
+		const int32* TargetIndex = Statement->TargetLabel ? TargetIndices.Find(Statement->TargetLabel) : nullptr;
+		const bool bJumpsToEnd = !TargetIndex || (*TargetIndex >= Described.Num());
+		switch (Statement->Type)
+		{
+		case KCST_CallFunction:
+		{
+			TArray<FString> Params;
+			for (const FBPTerminal* Param : Statement->RHS)
+			{
+				Params.Add(DescribeTerm(Param));
+			}
+			Result.Add(FString::Printf(TEXT("%s = %s(%s)"), *DescribeTerm(Statement->LHS)
+				, Statement->FunctionToCall ? *Statement->FunctionToCall->GetName() : TEXT("?"), *FString::Join(Params, TEXT(", "))));
+			break;
+		}
+		case KCST_Assignment:
+			Result.Add(FString::Printf(TEXT("%s = %s"), *DescribeTerm(Statement->LHS), *DescribeTerm(Statement->RHS.Num() ? Statement->RHS[0] : nullptr)));
+			break;
+		case KCST_UnconditionalGoto:
+		case KCST_GotoReturn:
+			Result.Add(bJumpsToEnd ? FString(TEXT("goto return")) : FString::Printf(TEXT("goto %d"), *TargetIndex));
+			break;
+		case KCST_GotoIfNot:
+		case KCST_GotoReturnIfNot:
+			Result.Add(bJumpsToEnd
+				? FString::Printf(TEXT("if not %s goto return"), *DescribeTerm(Statement->LHS))
+				: FString::Printf(TEXT("if not %s goto %d"), *DescribeTerm(Statement->LHS), *TargetIndex));
+			break;
+		default:
+			Result.Add(FString::Printf(TEXT("statement %d"), (int32)Statement->Type));
+			break;
+		}
+	}
+	return Result;
+}
+
+//------------------------------------------------------------------------------
+static bool BPBytecodeTranslatorTestsImpl::DescribeRecompiledFunctions(UBlueprint* Blueprint, TMap<FName, TArray<FString>>& OutFunctions)
+{
+	UPackage* TempPackage = CreatePackage(*FString::Printf(TEXT("/Temp/__TEMP_BP__%s"), *Blueprint->GetOutermost()->GetPathName()));
+	UBlueprint* DuplicateBP = nullptr;
+	{
+		FBlueprintDuplicationScopeFlags BPDuplicationFlags(FBlueprintDuplicationScopeFlags::NoExtraCompilation
+			| FBlueprintDuplicationScopeFlags::TheSameTimelineGuid
+			| FBlueprintDuplicationScopeFlags::ValidatePinsUsingSourceClass
+			| FBlueprintDuplicationScopeFlags::TheSameNodeGuid);
+		DuplicateBP = DuplicateObject<UBlueprint>(Blueprint, TempPackage, *Blueprint->GetName());
+	}
+	ON_SCOPE_EXIT
+	{
+		IKismetCompilerInterface& Compiler = FModuleManager::LoadModuleChecked<IKismetCompilerInterface>(KISMET_COMPILER_MODULENAME);
+		Compiler.RemoveBlueprintGeneratedClasses(DuplicateBP);
+		DuplicateBP->MarkAsGarbage();
+		TempPackage->MarkAsGarbage();
+	};
+
+	FCompilerResultsLog ResultsLog(false);
+	FKismetCompilerOptions CompilerOptions;
+	TSharedPtr<FKismetCompilerContext> CompilerContext = FKismetCompilerContext::GetCompilerForBP(DuplicateBP, ResultsLog, CompilerOptions);
+	DuplicateBP->bBeingCompiled = true;
+	CompilerContext->CompileClassLayout(EInternalCompilerFlags::PostponeLocalsGenerationUntilPhaseTwo);
+	CompilerContext->CompileFunctions(EInternalCompilerFlags::PostponeLocalsGenerationUntilPhaseTwo);
+	DuplicateBP->bBeingCompiled = false;
+
+	for (const FKismetFunctionContext& FunctionContext : static_cast<FKismetCompilerContextExt&>(*CompilerContext).GetFunctionList())
+	{
+		if (FunctionContext.Function)
+		{
+			OutFunctions.Add(FunctionContext.Function->GetFName(), DescribeFunction(FunctionContext));
+		}
+	}
+	return ResultsLog.NumErrors == 0;
+}
+
+//------------------------------------------------------------------------------
+static bool BPBytecodeTranslatorTestsImpl::DescribeTranslatedFunctions(UBlueprint* Blueprint, FAutomationTestBase& Test, TMap<FName, TArray<FString>>& OutFunctions)
+{
+	FBlueprintBytecodeTranslator Translator(CastChecked<UBlueprintGeneratedClass>(Blueprint->GeneratedClass));
+	TIndirectArray<FKismetFunctionContext> FunctionList;
+	if (!Translator.Translate(FunctionList))
+	{
+		Test.AddError(FString::Printf(TEXT("Cannot translate the bytecode: %s"), *Translator.GetFailureReason()));
+		return false;
+	}
+	for (const FKismetFunctionContext& FunctionContext : FunctionList)
+	{
+		OutFunctions.Add(FunctionContext.Function->GetFName(), DescribeFunction(FunctionContext));
+	}
+	return true;
+}
+
+/*******************************************************************************
+ * Tests
+ ******************************************************************************/
+
+static const uint32 BytecodeTranslatorTestFlags = EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter;
+
+/** Translates the bytecode of a Blueprint with a branch, a jump, assignments, calls, a return value and a double to float cast, and compares the statements with the ones the Kismet compiler generates. */
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FBPBytecodeTranslatorMatchesRecompileTest, "Project.Blueprints.NativeBackend.BytecodeTranslator.MatchesRecompile", BytecodeTranslatorTestFlags)
+bool FBPBytecodeTranslatorMatchesRecompileTest::RunTest(const FString& Parameters)
+{
+	using namespace BPBytecodeTranslatorTestsImpl;
+
+	UBlueprint* Blueprint = CreateTestBlueprint();
+	ON_SCOPE_EXIT
+	{
+		Blueprint->GetOutermost()->MarkAsGarbage();
+		Blueprint->MarkAsGarbage();
+		CollectGarbage(GARBAGE_COLLECTION_KEEPFLAGS);
+	};
+	if (!TestTrue(TEXT("Test Blueprint compiles"), (Blueprint->Status != BS_Error) && (Blueprint->GeneratedClass != nullptr)))
+	{
+		return false;
+	}
+
+	TMap<FName, TArray<FString>> TranslatedFunctions;
+	if (!DescribeTranslatedFunctions(Blueprint, *this, TranslatedFunctions))
+	{
+		return false;
+	}
+	TMap<FName, TArray<FString>> RecompiledFunctions;
+	if (!TestTrue(TEXT("Duplicate Blueprint recompiles"), DescribeRecompiledFunctions(Blueprint, RecompiledFunctions)))
+	{
+		return false;
+	}
+
+	const TArray<FString>* BranchFunction = TranslatedFunctions.Find(BranchFunctionName);
+	if (!TestNotNull(TEXT("BranchFunction is translated"), BranchFunction))
+	{
+		return false;
+	}
+	const FString BranchFunctionText = FString::Join(*BranchFunction, TEXT("\n"));
+	TestTrue(TEXT("Branch is a conditional jump"), BranchFunctionText.Contains(TEXT("if not ")));
+	TestTrue(TEXT("Merged branches need an unconditional jump"), BranchFunctionText.Contains(TEXT("goto ")));
+	TestTrue(TEXT("Int constant keeps its type"), BranchFunctionText.Contains(TEXT("Greater_IntInt(Count, Literal(int))")));
+	TestTrue(TEXT("Double to float cast is left to the generated code"), BranchFunctionText.Contains(TEXT("SetActorTickInterval(Interval)")));
+	TestTrue(TEXT("Return value is assigned"), BranchFunctionText.Contains(TEXT("ReturnValue = Counter")));
+
+	for (const TPair<FName, TArray<FString>>& Translated : TranslatedFunctions)
+	{
+		const TArray<FString>* Recompiled = RecompiledFunctions.Find(Translated.Key);
+		if (!TestNotNull(*FString::Printf(TEXT("%s is recompiled"), *Translated.Key.ToString()), Recompiled))
+		{
+			continue;
+		}
+		TestEqual(*FString::Printf(TEXT("Statements of %s"), *Translated.Key.ToString())
+			, FString::Join(Translated.Value, TEXT("\n")), FString::Join(*Recompiled, TEXT("\n")));
+	}
+	return true;
+}
+
+/** EX_IntConstByte holds an int32 in a single byte, the literal must not be typed as a byte. */
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FBPBytecodeTranslatorIntConstByteTest, "Project.Blueprints.NativeBackend.BytecodeTranslator.IntConstByte", BytecodeTranslatorTestFlags)
+bool FBPBytecodeTranslatorIntConstByteTest::RunTest(const FString& Parameters)
+{
+	using namespace BPBytecodeTranslatorTestsImpl;
+
+	UBlueprint* Blueprint = CreateTestBlueprint();
+	ON_SCOPE_EXIT
+	{
+		Blueprint->GetOutermost()->MarkAsGarbage();
+		Blueprint->MarkAsGarbage();
+		CollectGarbage(GARBAGE_COLLECTION_KEEPFLAGS);
+	};
+	UFunction* Function = Blueprint->GeneratedClass ? Blueprint->GeneratedClass->FindFunctionByName(ConstantFunctionName) : nullptr;
+	FProperty* ReturnProperty = Function ? FindFProperty<FIntProperty>(Function, UEdGraphSchema_K2::PN_ReturnValue) : nullptr;
+	if (!TestNotNull(TEXT("ConstantFunction returns an int"), ReturnProperty))
+	{
+		return false;
+	}
+
+	// ReturnValue = 7; return;
+	TArray<uint8> Script;
+	auto Write = [&Script](const auto& Value)
+	{
+		Script.Append((const uint8*)&Value, sizeof(Value));
+	};
+	Write((uint8)EX_Let);
+	Write((ScriptPointerType)(UPTRINT)ReturnProperty);
+	Write((uint8)EX_LocalOutVariable);
+	Write((ScriptPointerType)(UPTRINT)ReturnProperty);
+	Write((uint8)EX_IntConstByte);
+	Write((uint8)7);
+	Write((uint8)EX_Return);
+	Write((uint8)EX_Nothing);
+	Write((uint8)EX_EndOfScript);
+	Function->Script = MoveTemp(Script);
+
+	TMap<FName, TArray<FString>> TranslatedFunctions;
+	if (!DescribeTranslatedFunctions(Blueprint, *this, TranslatedFunctions))
+	{
+		return false;
+	}
+	const TArray<FString>* ConstantFunction = TranslatedFunctions.Find(ConstantFunctionName);
+	if (!TestNotNull(TEXT("ConstantFunction is translated"), ConstantFunction))
+	{
+		return false;
+	}
+	TestEqual(TEXT("Statements of ConstantFunction"), FString::Join(*ConstantFunction, TEXT("\n")), FString(TEXT("ReturnValue = Literal(int)")));
+	return true;
+}
+
+#endif // WITH_DEV_AUTOMATION_TESTS
@@ -0,0 +1,102 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "CoreMinimal.h"
+#include "Misc/AutomationTest.h"
+#include "Misc/ScopeExit.h"
+#include "Async/Async.h"
+#include "UObject/Package.h"
+#include "GameFramework/Actor.h"
+#include "GameFramework/Pawn.h"
+#include "Components/SceneComponent.h"
+#include "IBlueprintCompilerCppBackendModule.h"
+#include "BlueprintCompilerCppBackendUtils.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+/*******************************************************************************
+ * BPDependencyRecordsTestsImpl
+ ******************************************************************************/
+
+namespace BPDependencyRecordsTestsImpl
+{
+	static TArray<FString> CreateObjectRefStrings(const UObject* Object)
+	{
+		TArray<FString> Strings;
+		Strings.Init(Object->GetName(), FDependenciesGlobalMapHelper::NumObjectRefStrings);
+		return Strings;
+	}
+
+	/** Emits the record indices of the objects as a comma separated list, like the generated code does. */
+	static FString EmitRecordIndices(const TArray<const UObject*>& Objects)
+	{
+		FString Code;
+		for (const UObject* Object : Objects)
+		{
+			Code += FString::Printf(TEXT("%s%s"), Code.IsEmpty() ? TEXT("") : TEXT(", "), *FDependenciesGlobalMapHelper::EmitRecordIndex(Object, [Object]() { return CreateObjectRefStrings(Object); }));
+		}
+		return Code;
+	}
+
+	/** Like EmitRecordIndices, but the records are deferred and the code is emitted on a worker thread. */
+	static FString EmitDeferredRecordIndices(const TArray<const UObject*>& Objects, FDeferredDependencyRecords& OutRecords)
+	{
+		return Async(EAsyncExecution::TaskGraph, [&Objects, &OutRecords]()
+		{
+			FDependenciesGlobalMapHelper::DeferRecords(&OutRecords);
+			ON_SCOPE_EXIT
+			{
+				FDependenciesGlobalMapHelper::DeferRecords(nullptr);
+			};
+			return EmitRecordIndices(Objects);
+		}).Get();
+	}
+}
+
+/*******************************************************************************
+ * Tests
+ ******************************************************************************/
+
+static const uint32 DependencyRecordsTestFlags = EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter;
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FBPDependencyRecordsDeferredTest, "Project.Blueprints.NativeBackend.DependencyRecords.Deferred", DependencyRecordsTestFlags)
+bool FBPDependencyRecordsDeferredTest::RunTest(const FString& Parameters)
+{
+	using namespace BPDependencyRecordsTestsImpl;
+
+	IBlueprintCompilerCppBackendModule& BackEndModule = (IBlueprintCompilerCppBackendModule&)IBlueprintCompilerCppBackendModule::Get();
+	TSharedPtr<FNativizationSummary> PreviousSummary = BackEndModule.NativizationSummary();
+	TSharedPtr<FNativizationSummary> NativizationSummary(new FNativizationSummary());
+	BackEndModule.NativizationSummary() = NativizationSummary;
+	ON_SCOPE_EXIT
+	{
+		BackEndModule.NativizationSummary() = PreviousSummary;
+	};
+
+	const UObject* ActorClass = AActor::StaticClass();
+	const UObject* PawnClass = APawn::StaticClass();
+	const UObject* ComponentClass = USceneComponent::StaticClass();
+	const UObject* PackageClass = UPackage::StaticClass();
+
+	TestEqual(TEXT("Records emitted on the game thread get their index at once"), EmitRecordIndices({ ActorClass, PawnClass, ActorClass }), FString(TEXT("0, 1, 0")));
+
+	// The second class is emitted first, its records must still come after the ones of the first class.
+	FDeferredDependencyRecords SecondRecords;
+	FString SecondCode = EmitDeferredRecordIndices({ PackageClass, ComponentClass }, SecondRecords);
+	FDeferredDependencyRecords FirstRecords;
+	FString FirstCode = EmitDeferredRecordIndices({ PawnClass, ComponentClass, PawnClass }, FirstRecords);
+	TestEqual(TEXT("Deferred records are not added to the global map"), NativizationSummary->DependenciesGlobalMap.Num(), 2);
+
+	BackEndModule.ResolveDeferredDependencies(FirstRecords, FirstCode);
+	BackEndModule.ResolveDeferredDependencies(SecondRecords, SecondCode);
+	TestEqual(TEXT("Resolved indices of the first class"), FirstCode, FString(TEXT("1, 2, 1")));
+	TestEqual(TEXT("Resolved indices of the second class"), SecondCode, FString(TEXT("3, 2")));
+
+	const FNativizationSummary::FDependencyRecord* PackageRecord = NativizationSummary->DependenciesGlobalMap.Find(FSoftObjectPath(PackageClass));
+	if (TestNotNull(TEXT("Record of a deferred object"), PackageRecord))
+	{
+		TestTrue(TEXT("Object ref strings of a deferred record"), PackageRecord->ObjectRefStrings == CreateObjectRefStrings(PackageClass));
+	}
+	return true;
+}
+
+#endif // WITH_DEV_AUTOMATION_TESTS
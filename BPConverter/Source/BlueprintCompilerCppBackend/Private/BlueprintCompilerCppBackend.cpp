@@ -14,8 +14,13 @@
 #include "KismetCompilerMisc.h"
 #include "KismetCompiler.h"
 #include "BlueprintCompilerCppBackendUtils.h"
+#include "BlueprintCompilerCppBackendControlFlow.h"
 #include "Kismet/KismetNodeHelperLibrary.h"
 #include "Kismet/KismetArrayLibrary.h"
+#include "Kismet/KismetMathLibrary.h"
+#include "Kismet/KismetStringLibrary.h"
+#include "Kismet2/BlueprintEditorUtils.h"
+#include "UObject/StructOnScope.h"
 #include "Templates/UniquePtr.h"
 
 #include "BPConverterDebugHelper.h"
@@ -100,14 +105,12 @@ void FBlueprintCompilerCppBackend::EmitCallStatment(FEmitterLocalContext& Emitte
 
 	FString CalledNamePostfix;
 
-	auto UnsortedSeparateExecutionGroups = FKismetCompilerUtilities::FindUnsortedSeparateExecutionGroups(FunctionContext.LinearExecutionList);
-
-	if (Statement.TargetLabel && UberGraphContext && (UberGraphContext->Function == Statement.FunctionToCall) && UnsortedSeparateExecutionGroups.Num())
+	if (Statement.TargetLabel && UberGraphContext && (UberGraphContext->Function == Statement.FunctionToCall) && GetExecutionGroupInfo(*UberGraphContext).HasExecutionGroups())
 	{
-		int32* ExecutionGroupIndexPtr = UberGraphStatementToExecutionGroup.Find(Statement.TargetLabel);
-		if (ensure(ExecutionGroupIndexPtr))
+		const int32 ExecutionGroupIndex = FindUberGraphExecutionGroup(Statement.TargetLabel);
+		if (ensure(ExecutionGroupIndex != INDEX_NONE))
 		{
-			CalledNamePostfix = FString::Printf(TEXT("_%d"), *ExecutionGroupIndexPtr);
+			CalledNamePostfix = FString::Printf(TEXT("_%d"), ExecutionGroupIndex);
 		}
 	}
 
@@ -158,7 +161,7 @@ struct FSetterExpressionBuilder
 	}
 };
 
-void FBlueprintCompilerCppBackend::EmitAssignmentStatment(FEmitterLocalContext& EmitterContext, FKismetFunctionContext& FunctionContext, FBlueprintCompiledStatement& Statement)
+FString FBlueprintCompilerCppBackend::EmitAssignmentExpression(FEmitterLocalContext& EmitterContext, FBlueprintCompiledStatement& Statement)
 {
 	check(Statement.LHS && Statement.RHS[0]);
 
@@ -169,13 +172,18 @@ void FBlueprintCompilerCppBackend::EmitAssignmentStatment(FEmitterLocalContext&
 
 	const FString SourceExpression = TermToText(EmitterContext, SrcTermParams);
 	FSetterExpressionBuilder SetterExpression(*this, EmitterContext, Statement.LHS);
-	FSafeContextScopedEmmitter SafeContextScope(EmitterContext, Statement.LHS->Context, *this);
 
 	FString BeginCast;
 	FString EndCast;
 	FEmitHelper::GenerateAutomaticCast(EmitterContext, Statement.LHS->Type, Statement.RHS[0]->Type, Statement.LHS->AssociatedVarProperty, Statement.RHS[0]->AssociatedVarProperty, BeginCast, EndCast);
-	const FString RHS = FString::Printf(TEXT("%s%s%s"), *BeginCast, *SourceExpression, *EndCast);
-	EmitterContext.AddLine(SetterExpression.BuildFull(RHS));
+	return FString::Printf(TEXT("%s%s%s%s%s"), *SetterExpression.BuildStart(), *BeginCast, *SourceExpression, *EndCast, *SetterExpression.BuildEnd(false));
+}
+
+void FBlueprintCompilerCppBackend::EmitAssignmentStatment(FEmitterLocalContext& EmitterContext, FKismetFunctionContext& FunctionContext, FBlueprintCompiledStatement& Statement)
+{
+	const FString Assignment = EmitAssignmentExpression(EmitterContext, Statement);
+	FSafeContextScopedEmmitter SafeContextScope(EmitterContext, Statement.LHS->Context, *this);
+	EmitterContext.AddLine(Assignment + TEXT(";"));
 }
 
 void FBlueprintCompilerCppBackend::EmitCastObjToInterfaceStatement(FEmitterLocalContext& EmitterContext, FKismetFunctionContext& FunctionContext, FBlueprintCompiledStatement& Statement)
@@ -746,11 +754,11 @@ struct FCastWildCard
 	}
 };
 
-FString FBlueprintCompilerCppBackend::EmitMethodInputParameterList(FEmitterLocalContext& EmitterContext, FBlueprintCompiledStatement& Statement)
+TArray<FString> FBlueprintCompilerCppBackend::EmitMethodInputParameters(FEmitterLocalContext& EmitterContext, FBlueprintCompiledStatement& Statement, bool bMarkOutParams)
 {
 	FCastWildCard CastWildCard(Statement);
 
-	FString Result;
+	TArray<FString> Result;
 	int32 NumParams = 0;
 
 	for (TFieldIterator<FProperty> PropIt(Statement.FunctionToCall); PropIt && (PropIt->PropertyFlags & CPF_Parm); ++PropIt)
@@ -759,11 +767,6 @@ FString FBlueprintCompilerCppBackend::EmitMethodInputParameterList(FEmitterLocal
 
 		if (!FuncParamProperty->HasAnyPropertyFlags(CPF_ReturnParm))
 		{
-			if (NumParams > 0)
-			{
-				Result += TEXT(", ");
-			}
-
 			FString VarName;
 
 			FBPTerminal* Term = Statement.RHS[NumParams];
@@ -782,7 +785,7 @@ FString FBlueprintCompilerCppBackend::EmitMethodInputParameterList(FEmitterLocal
 				else
 				{
 					// Ubergraph entry point case
-					VarName = FString::FromInt(StateMapPerFunction[0].StatementToStateIndex(Statement.TargetLabel));
+					VarName = FString::FromInt(UberGraphStatementToStateIndex(Statement.TargetLabel));
 				}
 			}
 			else
@@ -806,11 +809,11 @@ FString FBlueprintCompilerCppBackend::EmitMethodInputParameterList(FEmitterLocal
 				VarName += CloseCast;
 			}
 
-			if (FuncParamProperty->HasAnyPropertyFlags(CPF_OutParm) && !FuncParamProperty->HasAnyPropertyFlags(CPF_ConstParm))
+			if (bMarkOutParams && FuncParamProperty->HasAnyPropertyFlags(CPF_OutParm) && !FuncParamProperty->HasAnyPropertyFlags(CPF_ConstParm))
 			{
-				Result += TEXT("/*out*/ ");
+				VarName = TEXT("/*out*/ ") + VarName;
 			}
-			Result += *VarName;
+			Result.Add(MoveTemp(VarName));
 
 			NumParams++;
 		}
@@ -827,18 +830,18 @@ FString FBlueprintCompilerCppBackend::EmitMethodInputParameterList(FEmitterLocal
 			FBPTerminal* Term = Statement.RHS[NumParams];
 			check(Term);
 
-			if (NumParams > 0)
-			{
-				Result += TEXT(", ");
-			}
-
-			Result += TermToText(EmitterContext, Term, ENativizedTermUsage::UnspecifiedOrReference);
+			Result.Add(TermToText(EmitterContext, Term, ENativizedTermUsage::UnspecifiedOrReference));
 		}
 	}
 
 	return Result;
 }
 
+FString FBlueprintCompilerCppBackend::EmitMethodInputParameterList(FEmitterLocalContext& EmitterContext, FBlueprintCompiledStatement& Statement)
+{
+	return FString::Join(EmitMethodInputParameters(EmitterContext, Statement, true), TEXT(", "));
+}
+
 static FString CustomThunkFunctionPostfix(FBlueprintCompiledStatement& Statement)
 {
 	/* Some native structures have no operator==. There are special versions of array functions for them (see GeneratedCodeHelpers.h). */
@@ -887,6 +890,162 @@ static FString CustomThunkFunctionPostfix(FBlueprintCompiledStatement& Statement
 	return FString();
 }
 
+/* Library functions, whose native implementation is a single operator or TArray member call, are emitted as that expression.
+The compiler can inline them, and array functions skip the generic thunk layer. "{N}" is the N-th input parameter. */
+struct FLibraryCallIntrinsics
+{
+	static const TMap<FName, const TCHAR*>& MathIntrinsics()
+	{
+		static const TMap<FName, const TCHAR*> Intrinsics = {
+			{ GET_FUNCTION_NAME_CHECKED(UKismetMathLibrary, Add_IntInt), TEXT("(({0}) + ({1}))") },
+			{ GET_FUNCTION_NAME_CHECKED(UKismetMathLibrary, Subtract_IntInt), TEXT("(({0}) - ({1}))") },
+			{ GET_FUNCTION_NAME_CHECKED(UKismetMathLibrary, Multiply_IntInt), TEXT("(({0}) * ({1}))") },
+			{ GET_FUNCTION_NAME_CHECKED(UKismetMathLibrary, Less_IntInt), TEXT("(({0}) < ({1}))") },
+			{ GET_FUNCTION_NAME_CHECKED(UKismetMathLibrary, Greater_IntInt), TEXT("(({0}) > ({1}))") },
+			{ GET_FUNCTION_NAME_CHECKED(UKismetMathLibrary, LessEqual_IntInt), TEXT("(({0}) <= ({1}))") },
+			{ GET_FUNCTION_NAME_CHECKED(UKismetMathLibrary, GreaterEqual_IntInt), TEXT("(({0}) >= ({1}))") },
+			{ GET_FUNCTION_NAME_CHECKED(UKismetMathLibrary, EqualEqual_IntInt), TEXT("(({0}) == ({1}))") },
+			{ GET_FUNCTION_NAME_CHECKED(UKismetMathLibrary, NotEqual_IntInt), TEXT("(({0}) != ({1}))") },
+			{ GET_FUNCTION_NAME_CHECKED(UKismetMathLibrary, Max), TEXT("FMath::Max<int32>({0}, {1})") },
+			{ GET_FUNCTION_NAME_CHECKED(UKismetMathLibrary, Min), TEXT("FMath::Min<int32>({0}, {1})") },
+			{ GET_FUNCTION_NAME_CHECKED(UKismetMathLibrary, Clamp), TEXT("FMath::Clamp<int32>({0}, {1}, {2})") },
+			{ GET_FUNCTION_NAME_CHECKED(UKismetMathLibrary, Abs_Int), TEXT("FMath::Abs<int32>({0})") },
+
+			{ GET_FUNCTION_NAME_CHECKED(UKismetMathLibrary, Add_Int64Int64), TEXT("(({0}) + ({1}))") },
+			{ GET_FUNCTION_NAME_CHECKED(UKismetMathLibrary, Subtract_Int64Int64), TEXT("(({0}) - ({1}))") },
+			{ GET_FUNCTION_NAME_CHECKED(UKismetMathLibrary, Multiply_Int64Int64), TEXT("(({0}) * ({1}))") },
+
+			{ GET_FUNCTION_NAME_CHECKED(UKismetMathLibrary, Add_DoubleDouble), TEXT("(({0}) + ({1}))") },
+			{ GET_FUNCTION_NAME_CHECKED(UKismetMathLibrary, Subtract_DoubleDouble), TEXT("(({0}) - ({1}))") },
+			{ GET_FUNCTION_NAME_CHECKED(UKismetMathLibrary, Multiply_DoubleDouble), TEXT("(({0}) * ({1}))") },
+			{ GET_FUNCTION_NAME_CHECKED(UKismetMathLibrary, Less_DoubleDouble), TEXT("(({0}) < ({1}))") },
+			{ GET_FUNCTION_NAME_CHECKED(UKismetMathLibrary, Greater_DoubleDouble), TEXT("(({0}) > ({1}))") },
+			{ GET_FUNCTION_NAME_CHECKED(UKismetMathLibrary, LessEqual_DoubleDouble), TEXT("(({0}) <= ({1}))") },
+			{ GET_FUNCTION_NAME_CHECKED(UKismetMathLibrary, GreaterEqual_DoubleDouble), TEXT("(({0}) >= ({1}))") },
+			{ GET_FUNCTION_NAME_CHECKED(UKismetMathLibrary, EqualEqual_DoubleDouble), TEXT("(({0}) == ({1}))") },
+			{ GET_FUNCTION_NAME_CHECKED(UKismetMathLibrary, NotEqual_DoubleDouble), TEXT("(({0}) != ({1}))") },
+			{ GET_FUNCTION_NAME_CHECKED(UKismetMathLibrary, FMax), TEXT("FMath::Max<double>({0}, {1})") },
+			{ GET_FUNCTION_NAME_CHECKED(UKismetMathLibrary, FMin), TEXT("FMath::Min<double>({0}, {1})") },
+			{ GET_FUNCTION_NAME_CHECKED(UKismetMathLibrary, FClamp), TEXT("FMath::Clamp<double>({0}, {1}, {2})") },
+			{ GET_FUNCTION_NAME_CHECKED(UKismetMathLibrary, Abs), TEXT("FMath::Abs<double>({0})") },
+			{ GET_FUNCTION_NAME_CHECKED(UKismetMathLibrary, Lerp), TEXT("FMath::Lerp<double>({0}, {1}, {2})") },
+
+			{ GET_FUNCTION_NAME_CHECKED(UKismetMathLibrary, Not_PreBool), TEXT("(!({0}))") },
+			{ GET_FUNCTION_NAME_CHECKED(UKismetMathLibrary, EqualEqual_BoolBool), TEXT("(({0}) == ({1}))") },
+			{ GET_FUNCTION_NAME_CHECKED(UKismetMathLibrary, NotEqual_BoolBool), TEXT("(({0}) != ({1}))") },
+
+			{ GET_FUNCTION_NAME_CHECKED(UKismetMathLibrary, EqualEqual_NameName), TEXT("(({0}) == ({1}))") },
+			{ GET_FUNCTION_NAME_CHECKED(UKismetMathLibrary, NotEqual_NameName), TEXT("(({0}) != ({1}))") },
+
+			{ GET_FUNCTION_NAME_CHECKED(UKismetMathLibrary, MakeVector), TEXT("FVector({0}, {1}, {2})") },
+			{ GET_FUNCTION_NAME_CHECKED(UKismetMathLibrary, Add_VectorVector), TEXT("(({0}) + ({1}))") },
+			{ GET_FUNCTION_NAME_CHECKED(UKismetMathLibrary, Subtract_VectorVector), TEXT("(({0}) - ({1}))") },
+			{ GET_FUNCTION_NAME_CHECKED(UKismetMathLibrary, Multiply_VectorVector), TEXT("(({0}) * ({1}))") },
+			{ GET_FUNCTION_NAME_CHECKED(UKismetMathLibrary, Multiply_VectorFloat), TEXT("(({0}) * ({1}))") },
+			{ GET_FUNCTION_NAME_CHECKED(UKismetMathLibrary, NegateVector), TEXT("(-({0}))") },
+			{ GET_FUNCTION_NAME_CHECKED(UKismetMathLibrary, Dot_VectorVector), TEXT("FVector::DotProduct({0}, {1})") },
+			{ GET_FUNCTION_NAME_CHECKED(UKismetMathLibrary, Cross_VectorVector), TEXT("FVector::CrossProduct({0}, {1})") },
+			{ GET_FUNCTION_NAME_CHECKED(UKismetMathLibrary, VSize), TEXT("({0}).Size()") },
+			{ GET_FUNCTION_NAME_CHECKED(UKismetMathLibrary, VSizeSquared), TEXT("({0}).SizeSquared()") },
+			{ GET_FUNCTION_NAME_CHECKED(UKismetMathLibrary, Vector_Distance), TEXT("FVector::Dist({0}, {1})") },
+			{ GET_FUNCTION_NAME_CHECKED(UKismetMathLibrary, Vector_DistanceSquared), TEXT("FVector::DistSquared({0}, {1})") },
+			{ GET_FUNCTION_NAME_CHECKED(UKismetMathLibrary, VLerp), TEXT("FMath::Lerp({0}, {1}, {2})") },
+		};
+		// Division and modulo are not listed: the library versions guard against a zero divisor.
+		return Intrinsics;
+	}
+
+	static const TMap<FName, const TCHAR*>& ArrayIntrinsics()
+	{
+		static const TMap<FName, const TCHAR*> Intrinsics = {
+			{ GET_FUNCTION_NAME_CHECKED(UKismetArrayLibrary, Array_Length), TEXT("({0}).Num()") },
+			{ GET_FUNCTION_NAME_CHECKED(UKismetArrayLibrary, Array_LastIndex), TEXT("(({0}).Num() - 1)") },
+			{ GET_FUNCTION_NAME_CHECKED(UKismetArrayLibrary, Array_IsValidIndex), TEXT("({0}).IsValidIndex({1})") },
+			{ GET_FUNCTION_NAME_CHECKED(UKismetArrayLibrary, Array_Add), TEXT("({0}).Add({1})") },
+			{ GET_FUNCTION_NAME_CHECKED(UKismetArrayLibrary, Array_Append), TEXT("({0}).Append({1})") },
+			{ GET_FUNCTION_NAME_CHECKED(UKismetArrayLibrary, Array_Clear), TEXT("({0}).Empty()") },
+			{ GET_FUNCTION_NAME_CHECKED(UKismetArrayLibrary, Array_Contains), TEXT("({0}).Contains({1})") },
+			{ GET_FUNCTION_NAME_CHECKED(UKismetArrayLibrary, Array_Find), TEXT("({0}).Find({1})") },
+			{ GET_FUNCTION_NAME_CHECKED(UKismetArrayLibrary, Array_RemoveItem), TEXT("(({0}).Remove({1}) > 0)") },
+		};
+		// Get, Set, Insert, Remove and Resize are not listed: the library versions validate the index.
+		// AddUnique is not listed: the library version returns INDEX_NONE for an existing item.
+		return Intrinsics;
+	}
+
+	static bool ElementTypeSupportsEquality(const FEdGraphPinType& ArrayType)
+	{
+		// FText and most structures have no operator==, see CustomThunkFunctionPostfix.
+		const FName Category = ArrayType.PinCategory;
+		return (Category == UEdGraphSchema_K2::PC_Boolean)
+			|| (Category == UEdGraphSchema_K2::PC_Byte)
+			|| (Category == UEdGraphSchema_K2::PC_Int)
+			|| (Category == UEdGraphSchema_K2::PC_Int64)
+			|| (Category == UEdGraphSchema_K2::PC_Real)
+			|| (Category == UEdGraphSchema_K2::PC_Name)
+			|| (Category == UEdGraphSchema_K2::PC_String)
+			|| (Category == UEdGraphSchema_K2::PC_Object)
+			|| (Category == UEdGraphSchema_K2::PC_Class);
+	}
+
+	static const TCHAR* Find(const FBlueprintCompiledStatement& Statement)
+	{
+		static const FBoolConfigValueHelper DontUseLibraryIntrinsics(TEXT("BlueprintNativizationSettings"), TEXT("bDontUseLibraryIntrinsics"));
+		if (DontUseLibraryIntrinsics || Statement.bIsParentContext || !Statement.FunctionToCall->HasAnyFunctionFlags(FUNC_Static))
+		{
+			return nullptr;
+		}
+
+		const UClass* OwnerClass = Statement.FunctionToCall->GetOuterUClass();
+		const bool bMathLibrary = (OwnerClass == UKismetMathLibrary::StaticClass());
+		const bool bArrayLibrary = (OwnerClass == UKismetArrayLibrary::StaticClass());
+		const TCHAR* const* Pattern = bMathLibrary ? MathIntrinsics().Find(Statement.FunctionToCall->GetFName())
+			: (bArrayLibrary ? ArrayIntrinsics().Find(Statement.FunctionToCall->GetFName()) : nullptr);
+		if (!Pattern)
+		{
+			return nullptr;
+		}
+
+		int32 NumParams = 0;
+		for (TFieldIterator<FProperty> PropIt(Statement.FunctionToCall); PropIt && (PropIt->PropertyFlags & CPF_Parm); ++PropIt)
+		{
+			if (!PropIt->HasAnyPropertyFlags(CPF_ReturnParm))
+			{
+				// Only the target array may be passed by non-const reference.
+				const bool bOutput = PropIt->HasAnyPropertyFlags(CPF_OutParm) && !PropIt->HasAnyPropertyFlags(CPF_ConstParm);
+				if (bOutput && !(bArrayLibrary && (NumParams == 0) && PropIt->HasAnyPropertyFlags(CPF_ReferenceParm)))
+				{
+					return nullptr;
+				}
+				NumParams++;
+			}
+		}
+		if (NumParams != Statement.RHS.Num())
+		{
+			return nullptr;
+		}
+
+		if (bArrayLibrary)
+		{
+			const FBPTerminal* ArrayTerm = Statement.RHS[0];
+			if (!ArrayTerm || !ArrayTerm->Type.IsArray())
+			{
+				return nullptr;
+			}
+			const FName FunctionName = Statement.FunctionToCall->GetFName();
+			const bool bUsesEquality = (FunctionName == GET_FUNCTION_NAME_CHECKED(UKismetArrayLibrary, Array_Contains))
+				|| (FunctionName == GET_FUNCTION_NAME_CHECKED(UKismetArrayLibrary, Array_Find))
+				|| (FunctionName == GET_FUNCTION_NAME_CHECKED(UKismetArrayLibrary, Array_RemoveItem));
+			if (bUsesEquality && !ElementTypeSupportsEquality(ArrayTerm->Type))
+			{
+				return nullptr;
+			}
+		}
+
+		return *Pattern;
+	}
+};
+
 FString FBlueprintCompilerCppBackend::EmitCallStatmentInner(FEmitterLocalContext& EmitterContext, FBlueprintCompiledStatement& Statement, bool bInline, FString PostFix)
 {
 	check(Statement.FunctionToCall != nullptr);
@@ -970,8 +1129,18 @@ FString FBlueprintCompilerCppBackend::EmitCallStatmentInner(FEmitterLocalContext
 	FNativizationSummaryHelper::FunctionUsed(CurrentClass, Statement.FunctionToCall);
 
 	UClass* FunctionOwner = Statement.FunctionToCall->GetOwnerClass();
+	const TCHAR* IntrinsicPattern = bInterfaceCallExecute ? nullptr : FLibraryCallIntrinsics::Find(Statement);
+	if (IntrinsicPattern)
+	{
+		FStringFormatOrderedArguments Arguments;
+		for (FString& Argument : EmitMethodInputParameters(EmitterContext, Statement, false))
+		{
+			Arguments.Add(MoveTemp(Argument));
+		}
+		Result += FString::Format(IntrinsicPattern, Arguments);
+	}
 	// Emit object to call the method on
-	if (bInterfaceCallExecute)
+	else if (bInterfaceCallExecute)
 	{
 		// now that we call execute even on self, we might not have a FunctionContext. So we get the scope name for the call from the interface itself, instead of the context
 		// we also need to pass "this" if calling on self
@@ -1051,13 +1220,16 @@ FString FBlueprintCompilerCppBackend::EmitCallStatmentInner(FEmitterLocalContext
 		// Emit method parameter list
 		Result += TEXT("(");
 	}
-	const FString ParameterList = EmitMethodInputParameterList(EmitterContext, Statement);
-	if (bInterfaceCallExecute && !ParameterList.IsEmpty())
+	if (!IntrinsicPattern)
 	{
-		Result += TEXT(", ");
+		const FString ParameterList = EmitMethodInputParameterList(EmitterContext, Statement);
+		if (bInterfaceCallExecute && !ParameterList.IsEmpty())
+		{
+			Result += TEXT(", ");
+		}
+		Result += ParameterList;
+		Result += TEXT(")");
 	}
-	Result += ParameterList;
-	Result += TEXT(")");
 
 	Result += CloseCast;
 	if (SetterExpression)
@@ -1084,6 +1256,214 @@ FString FBlueprintCompilerCppBackend::EmitArrayGetByRef(FEmitterLocalContext& Em
 	return Result;
 }
 
+static bool IsFoldableConstantType(const FProperty* Property)
+{
+	if (Property->ArrayDim != 1)
+	{
+		return false;
+	}
+	if (const FStructProperty* StructProperty = CastField<FStructProperty>(Property))
+	{
+		return (StructProperty->Struct == TBaseStructure<FVector>::Get()) || (StructProperty->Struct == TBaseStructure<FRotator>::Get());
+	}
+	return Property->IsA<FBoolProperty>()
+		|| Property->IsA<FIntProperty>()
+		|| Property->IsA<FInt64Property>()
+		|| Property->IsA<FFloatProperty>()
+		|| Property->IsA<FDoubleProperty>()
+		|| Property->IsA<FNameProperty>()
+		|| Property->IsA<FStrProperty>();
+}
+
+/* Pure math and string library functions with constant inputs are evaluated while generating code. Functions with a state-dependent result (random streams) are never folded. */
+static bool CanFoldConstantCall(const UFunction* Function)
+{
+	static const FBoolConfigValueHelper DontFoldConstantCalls(TEXT("BlueprintNativizationSettings"), TEXT("bDontFoldConstantCalls"));
+	const UClass* OwnerClass = Function->GetOuterUClass();
+	if (DontFoldConstantCalls
+		|| !Function->HasAllFunctionFlags(FUNC_Static | FUNC_Native | FUNC_BlueprintPure)
+		|| ((OwnerClass != UKismetMathLibrary::StaticClass()) && (OwnerClass != UKismetStringLibrary::StaticClass()))
+		|| Function->HasMetaData(FBlueprintMetadata::MD_NotThreadSafe)
+		|| Function->GetName().StartsWith(TEXT("Random")))
+	{
+		return false;
+	}
+
+	for (TFieldIterator<FProperty> PropIt(Function); PropIt && (PropIt->PropertyFlags & CPF_Parm); ++PropIt)
+	{
+		const bool bOutput = PropIt->HasAnyPropertyFlags(CPF_OutParm) && !PropIt->HasAnyPropertyFlags(CPF_ConstParm | CPF_ReturnParm);
+		if (bOutput || !IsFoldableConstantType(*PropIt))
+		{
+			return false;
+		}
+	}
+	return Function->GetReturnProperty() != nullptr;
+}
+
+// Exports the value in the pin default value format. Reals keep their full precision.
+static bool ExportConstantValue(const FProperty* Property, const uint8* ValuePtr, FString& OutValue)
+{
+	if (const FDoubleProperty* DoubleProperty = CastField<FDoubleProperty>(Property))
+	{
+		const double Value = DoubleProperty->GetPropertyValue(ValuePtr);
+		OutValue = FString::Printf(TEXT("%.17g"), Value);
+		return FMath::IsFinite(Value);
+	}
+	if (const FFloatProperty* FloatProperty = CastField<FFloatProperty>(Property))
+	{
+		const float Value = FloatProperty->GetPropertyValue(ValuePtr);
+		OutValue = FString::Printf(TEXT("%.9g"), Value);
+		return FMath::IsFinite(Value);
+	}
+	if (const FStructProperty* StructProperty = CastField<FStructProperty>(Property))
+	{
+		if (StructProperty->Struct == TBaseStructure<FVector>::Get())
+		{
+			const FVector& Value = *reinterpret_cast<const FVector*>(ValuePtr);
+			OutValue = FString::Printf(TEXT("%.17g,%.17g,%.17g"), Value.X, Value.Y, Value.Z);
+			return !Value.ContainsNaN();
+		}
+		if (StructProperty->Struct == TBaseStructure<FRotator>::Get())
+		{
+			const FRotator& Value = *reinterpret_cast<const FRotator*>(ValuePtr);
+			OutValue = FString::Printf(TEXT("%.17g,%.17g,%.17g"), Value.Pitch, Value.Yaw, Value.Roll);
+			return !Value.ContainsNaN();
+		}
+	}
+	return FBlueprintEditorUtils::PropertyValueToString_Direct(Property, ValuePtr, OutValue);
+}
+
+static FString ConstantValueToCpp(FEmitterLocalContext& EmitterContext, const FBPTerminal* Term, const FString& Value)
+{
+	auto RealLiteral = [](const FString& RealValue) -> FString
+	{
+		return (RealValue.Contains(TEXT(".")) || RealValue.Contains(TEXT("e"))) ? RealValue : (RealValue + TEXT(".0"));
+	};
+
+	const FProperty* ReturnProperty = Term->InlineGeneratedParameter->FunctionToCall->GetReturnProperty();
+	if (ReturnProperty->IsA<FDoubleProperty>())
+	{
+		return RealLiteral(Value);
+	}
+	if (ReturnProperty->IsA<FFloatProperty>())
+	{
+		return RealLiteral(Value) + TEXT("f");
+	}
+	if (const FStructProperty* StructProperty = CastField<FStructProperty>(ReturnProperty))
+	{
+		TArray<FString> Components;
+		Value.ParseIntoArray(Components, TEXT(","));
+		if (ensure(Components.Num() == 3))
+		{
+			return FString::Printf(TEXT("%s(%s, %s, %s)"), *FEmitHelper::GetCppName(StructProperty->Struct)
+				, *RealLiteral(Components[0]), *RealLiteral(Components[1]), *RealLiteral(Components[2]));
+		}
+	}
+
+	FEmitHelper::FLiteralTermParams LiteralTermParams;
+	LiteralTermParams.Type = Term->Type;
+	LiteralTermParams.CustomValue = Value;
+	return FEmitHelper::LiteralTerm(EmitterContext, LiteralTermParams);
+}
+
+bool FBlueprintCompilerCppBackend::FoldConstantCall(const FBPTerminal* Term, FString& OutValue)
+{
+	if (const TOptional<FString>* KnownValue = ConstantCallValues.Find(Term))
+	{
+		if (KnownValue->IsSet())
+		{
+			OutValue = KnownValue->GetValue();
+		}
+		return KnownValue->IsSet();
+	}
+
+	// ProcessEvent on the shared CDO is not thread safe. When the code is emitted on a worker thread, the calls were folded by FoldConstantCalls.
+	if (!IsInGameThread())
+	{
+		return false;
+	}
+
+	TOptional<FString> Value;
+	const FBlueprintCompiledStatement* Call = Term->InlineGeneratedParameter;
+	UFunction* Function = (Call && (KCST_CallFunction == Call->Type)) ? Call->FunctionToCall : nullptr;
+	if (Function && CanFoldConstantCall(Function))
+	{
+		FStructOnScope Parameters(Function);
+		bool bInputsAreConstant = true;
+		int32 NumParams = 0;
+		for (TFieldIterator<FProperty> PropIt(Function); bInputsAreConstant && PropIt && (PropIt->PropertyFlags & CPF_Parm); ++PropIt)
+		{
+			if (PropIt->HasAnyPropertyFlags(CPF_ReturnParm))
+			{
+				continue;
+			}
+
+			// Inputs are literals or other folded calls
+			const FBPTerminal* Input = Call->RHS.IsValidIndex(NumParams) ? Call->RHS[NumParams] : nullptr;
+			FString InputValue;
+			if (Input && Input->bIsLiteral)
+			{
+				InputValue = Input->Name;
+			}
+			else if (!Input || !FoldConstantCall(Input, InputValue))
+			{
+				bInputsAreConstant = false;
+				break;
+			}
+			bInputsAreConstant = FBlueprintEditorUtils::PropertyValueFromString_Direct(*PropIt, InputValue, PropIt->ContainerPtrToValuePtr<uint8>(Parameters.GetStructMemory()));
+			NumParams++;
+		}
+
+		UObject* FunctionOwnerCDO = Function->GetOuterUClass()->GetDefaultObject(false);
+		if (bInputsAreConstant && (NumParams == Call->RHS.Num()) && FunctionOwnerCDO)
+		{
+			FunctionOwnerCDO->ProcessEvent(Function, Parameters.GetStructMemory());
+
+			const FProperty* ReturnProperty = Function->GetReturnProperty();
+			FString ReturnValue;
+			if (ExportConstantValue(ReturnProperty, ReturnProperty->ContainerPtrToValuePtr<uint8>(Parameters.GetStructMemory()), ReturnValue))
+			{
+				Value = MoveTemp(ReturnValue);
+			}
+		}
+	}
+
+	ConstantCallValues.Add(Term, Value);
+	if (Value.IsSet())
+	{
+		OutValue = Value.GetValue();
+	}
+	return Value.IsSet();
+}
+
+void FBlueprintCompilerCppBackend::FoldConstantCalls(const TIndirectArray<FKismetFunctionContext>& Functions)
+{
+	check(IsInGameThread());
+
+	auto FoldTerm = [this](const FBPTerminal* Term)
+	{
+		FString UnusedValue;
+		if (Term && Term->InlineGeneratedParameter)
+		{
+			FoldConstantCall(Term, UnusedValue);
+		}
+	};
+
+	// Every statement, inline calls included, is owned by its function context
+	for (const FKismetFunctionContext& FunctionContext : Functions)
+	{
+		for (const FBlueprintCompiledStatement& Statement : FunctionContext.AllGeneratedStatements)
+		{
+			FoldTerm(Statement.LHS);
+			FoldTerm(Statement.FunctionContext);
+			for (const FBPTerminal* Term : Statement.RHS)
+			{
+				FoldTerm(Term);
+			}
+		}
+	}
+}
+
 FString FBlueprintCompilerCppBackend::TermToText(FEmitterLocalContext& EmitterContext, const FTermToTextParams& Params)
 {
 	const FBPTerminal* Term = Params.Term;
@@ -1099,6 +1479,11 @@ FString FBlueprintCompilerCppBackend::TermToText(FEmitterLocalContext& EmitterCo
 	const FString PSC_Self(TEXT("self"));
 	if (Term->bIsLiteral)
 	{
+		if (const FString* LiteralConstant = EmitterContext.LiteralConstants.Find(Term))
+		{
+			return *LiteralConstant;
+		}
+
 		FEmitHelper::FLiteralTermParams LiteralTermParams;
 		LiteralTermParams.Type = Term->Type;
 		LiteralTermParams.CustomValue = Term->Name;
@@ -1110,6 +1495,16 @@ FString FBlueprintCompilerCppBackend::TermToText(FEmitterLocalContext& EmitterCo
 	}
 	else if (Term->InlineGeneratedParameter)
 	{
+		FString ConstantValue;
+		if (FoldConstantCall(Term, ConstantValue))
+		{
+			return ConstantValueToCpp(EmitterContext, Term, ConstantValue);
+		}
+		if (const FString* CommonSubexpression = EmitterContext.CommonSubexpressions.Find(Term))
+		{
+			return *CommonSubexpression;
+		}
+
 		if (KCST_SwitchValue == Term->InlineGeneratedParameter->Type)
 		{
 			return EmitSwitchValueStatmentInner(EmitterContext, *Term->InlineGeneratedParameter);
@@ -1308,17 +1703,16 @@ FString FBlueprintCompilerCppBackend::LatentFunctionInfoTermToText(FEmitterLocal
 	LiteralTermParams.Type = Term->Type;
 	LiteralTermParams.CustomValue = Term->Name;
 
-	// Index 0 is always the ubergraph
-	const int32 TargetStateIndex = StateMapPerFunction[0].StatementToStateIndex(TargetLabel);
+	const int32 TargetStateIndex = UberGraphStatementToStateIndex(TargetLabel);
 	const int32 LinkageTermStartIdx = LiteralTermParams.CustomValue.Find(FixupTermName);
 	check(LinkageTermStartIdx != INDEX_NONE);
 	LiteralTermParams.CustomValue.ReplaceInline(*FString::Printf(TEXT("%s=-1"), *FixupTermName), *FString::Printf(TEXT("%s=%d"), *FixupTermName, TargetStateIndex));
 
-	int32* ExecutionGroupPtr = UberGraphStatementToExecutionGroup.Find(TargetLabel);
-	if (ExecutionGroupPtr && UberGraphContext)
+	const int32 ExecutionGroupIndex = FindUberGraphExecutionGroup(TargetLabel);
+	if (ExecutionGroupIndex != INDEX_NONE)
 	{
 		const FString OldExecutionFunctionName = UEdGraphSchema_K2::FN_ExecuteUbergraphBase.ToString() + TEXT("_") + UberGraphContext->Blueprint->GetName();
-		const FString NewExecutionFunctionName = OldExecutionFunctionName + FString::Printf(TEXT("_%d"), *ExecutionGroupPtr);
+		const FString NewExecutionFunctionName = OldExecutionFunctionName + FString::Printf(TEXT("_%d"), ExecutionGroupIndex);
 		LiteralTermParams.CustomValue = LiteralTermParams.CustomValue.Replace(*OldExecutionFunctionName, *NewExecutionFunctionName);
 	}
 
@@ -1326,6 +1720,34 @@ FString FBlueprintCompilerCppBackend::LatentFunctionInfoTermToText(FEmitterLocal
 }
 
 
+// FKismetFunctionContext::MustUseSwitchState is gone in UE5. Returns if any statement of the function requires a jump.
+static bool MustUseSwitchState(const TArray<FBlueprintCompiledStatement*>& Statements)
+{
+	return Statements.ContainsByPredicate([](const FBlueprintCompiledStatement* Statement)->bool
+	{
+		return Statement && (Statement->Type == KCST_UnconditionalGoto
+			|| Statement->Type == KCST_PushState
+			|| Statement->Type == KCST_GotoIfNot
+			|| Statement->Type == KCST_ComputedGoto
+			|| Statement->Type == KCST_EndOfThread
+			|| Statement->Type == KCST_EndOfThreadIfNot
+			|| Statement->Type == KCST_GotoReturn
+			|| Statement->Type == KCST_GotoReturnIfNot);
+	});
+}
+
+// Indices of all nodes of the linear execution list
+static TArray<int32> AllNodeIndices(int32 NumNodes)
+{
+	TArray<int32> NodeIndices;
+	NodeIndices.Reserve(NumNodes);
+	for (int32 NodeIndex = 0; NodeIndex < NumNodes; ++NodeIndex)
+	{
+		NodeIndices.Add(NodeIndex);
+	}
+	return NodeIndices;
+}
+
 bool FBlueprintCompilerCppBackend::InnerFunctionImplementation(FKismetFunctionContext& FunctionContext, FEmitterLocalContext& EmitterContext, int32 ExecutionGroup)
 {
 	EmitterContext.ResetPropertiesForInaccessibleStructs();
@@ -1333,18 +1755,14 @@ bool FBlueprintCompilerCppBackend::InnerFunctionImplementation(FKismetFunctionCo
 	bUseExecutionGroup = ExecutionGroup >= 0;
 	ensure(FunctionContext.bIsUbergraph || !bUseExecutionGroup); // currently we split only ubergraphs
 
+	FFlatFunction& FlatFunction = GetFlatFunction(FunctionContext);
 	auto DoesUseFlowStack = [&]() -> bool
 	{
-		auto UnsortedSeparateExecutionGroups = FKismetCompilerUtilities::FindUnsortedSeparateExecutionGroups(FunctionContext.LinearExecutionList);
-
-		for (UEdGraphNode* Node : UnsortedSeparateExecutionGroups[ExecutionGroup])
+		const FExecutionGroupInfo& ExecutionGroupInfo = GetExecutionGroupInfo(FunctionContext);
+		for (int32 StatementIndex = 0; StatementIndex < FlatFunction.Statements.Num(); ++StatementIndex)
 		{
-			TArray<FBlueprintCompiledStatement*>* StatementList = FunctionContext.StatementsPerNode.Find(Node);
-			const bool bFlowStackIsRequired = StatementList && StatementList->ContainsByPredicate([](const FBlueprintCompiledStatement* Statement)->bool
-			{
-				return Statement && (Statement->Type == KCST_PushState);
-			});
-			if (bFlowStackIsRequired)
+			const FBlueprintCompiledStatement* Statement = FlatFunction.Statements[StatementIndex];
+			if (Statement && (Statement->Type == KCST_PushState) && ExecutionGroupInfo.IsInExecutionGroup(FlatFunction.StatementNodes[StatementIndex], ExecutionGroup))
 			{
 				return true;
 			}
@@ -1353,23 +1771,70 @@ bool FBlueprintCompilerCppBackend::InnerFunctionImplementation(FKismetFunctionCo
 	};
 	bUseFlowStack =  bUseExecutionGroup ? DoesUseFlowStack() : FunctionContext.bUseFlowStack;
 
+	// Jumps are rebuilt into if/else, loops and early returns when possible. The switch is kept for irreducible flow.
+	static const FBoolConfigValueHelper DontReconstructControlFlow(TEXT("BlueprintNativizationSettings"), TEXT("bDontReconstructControlFlow"));
+	const bool bReconstructControlFlow = !DontReconstructControlFlow;
+
 	UEdGraphNode* TheOnlyEntryPoint = nullptr;
-	TArray<UEdGraphNode*> LocalLinearExecutionList;
+	TArray<int32> LocalLinearExecutionList;
+	FStructuredControlFlow StructuredControlFlow;
+	bool bUseStructuredControlFlow = false;
 	//TODO: unify ubergraph and function handling
 	if (bUseExecutionGroup)
 	{
-		const bool bCanUseWithoutGotoState = PrepareToUseExecutionGroupWithoutGoto(FunctionContext, ExecutionGroup, TheOnlyEntryPoint);
+		const bool bCanUseWithoutGotoState = PrepareToUseExecutionGroupWithoutGoto(FunctionContext, ExecutionGroup, TheOnlyEntryPoint, bReconstructControlFlow) && TheOnlyEntryPoint;
 		const bool bSortedWithoutCycles = bCanUseWithoutGotoState && SortNodesInUberGraphExecutionGroup(FunctionContext, TheOnlyEntryPoint, ExecutionGroup, LocalLinearExecutionList);
-		bUseGotoState = !bSortedWithoutCycles;
+		if (bReconstructControlFlow && bCanUseWithoutGotoState)
+		{
+			if (!bSortedWithoutCycles)
+			{
+				// loops cannot be sorted, try the original order (it must start with the entry point)
+				LocalLinearExecutionList.Reset();
+				const FExecutionGroupInfo& ExecutionGroupInfo = GetExecutionGroupInfo(FunctionContext);
+				for (int32 NodeIndex = 0; NodeIndex < FlatFunction.NumNodes(); ++NodeIndex)
+				{
+					if (ExecutionGroupInfo.IsInExecutionGroup(NodeIndex, ExecutionGroup))
+					{
+						LocalLinearExecutionList.Add(NodeIndex);
+					}
+				}
+			}
+
+			if (LocalLinearExecutionList.Num() && (LocalLinearExecutionList[0] == FlatFunction.FindNode(TheOnlyEntryPoint)))
+			{
+				TArray<FBlueprintCompiledStatement*> Statements;
+				GatherStatements(FunctionContext, ExecutionGroup, LocalLinearExecutionList, Statements);
+				bUseStructuredControlFlow = StructuredControlFlow.Build(Statements);
+			}
+			bUseGotoState = !bUseStructuredControlFlow;
+		}
+		else
+		{
+			bUseGotoState = !bSortedWithoutCycles;
+		}
+	}
+	else if (!FunctionContext.bIsUbergraph)
+	{
+		if (bReconstructControlFlow)
+		{
+			// without execution groups all statements are used, in their original order
+			bUseStructuredControlFlow = StructuredControlFlow.Build(FlatFunction.Statements);
+		}
+		bUseGotoState = !bUseStructuredControlFlow && MustUseSwitchState(FlatFunction.Statements);
 	}
 	else
 	{
-		// TODO  @zhouminyi
-		BP_CONVERTER_DEBUG("Cannot handle GotoState for non-ubergraph functions");
-		//bUseGotoState = FunctionContext. (nullptr) || FunctionContext.bIsUbergraph;
+		// the ubergraph is entered by a computed goto
+		bUseGotoState = true;
+	}
+	if (bUseStructuredControlFlow)
+	{
+		// the pushed states were resolved statically, see FStructuredControlFlow::ResolveFlowStack
+		bUseFlowStack = false;
 	}
 	ensureMsgf(!bUseFlowStack || bUseGotoState, TEXT("FBlueprintCompilerCppBackend::InnerFunctionImplementation - %s"), *GetPathNameSafe(FunctionContext.Function));
-	TArray<UEdGraphNode*>* ActualLinearExecutionList = &FunctionContext.LinearExecutionList;
+	TArray<int32> FullLinearExecutionList = AllNodeIndices(FlatFunction.NumNodes());
+	TArray<int32>* ActualLinearExecutionList = &FullLinearExecutionList;
 	if (bUseGotoState)
 	{
 		if (bUseFlowStack)
@@ -1382,14 +1847,8 @@ bool FBlueprintCompilerCppBackend::InnerFunctionImplementation(FKismetFunctionCo
 		}
 		else
 		{
-			FBlueprintCompiledStatement* FirstStatement = nullptr;
-			for (int32 NodeIndex = 0; (NodeIndex < FunctionContext.LinearExecutionList.Num()) && (!FirstStatement); ++NodeIndex)
-			{
-				UEdGraphNode* ItNode = FunctionContext.LinearExecutionList[NodeIndex];
-				TArray<FBlueprintCompiledStatement*>* FirstStatementList = ItNode ? FunctionContext.StatementsPerNode.Find(ItNode) : nullptr;
-				FirstStatement = (FirstStatementList && FirstStatementList->Num()) ? (*FirstStatementList)[0] : nullptr;
-			}
-			const int32 FirstIndex = FirstStatement ? StatementToStateIndex(FunctionContext, FirstStatement) : 0;
+			// the first statement is the first one of the first node having any
+			const int32 FirstIndex = FlatFunction.Statements.Num() ? FlatFunction.StatementToStateIndex(0) : 0;
 			EmitterContext.AddLine(FString::Printf(TEXT("int32 __CurrentState = %d;"), FirstIndex));
 		}
 		EmitterContext.AddLine(TEXT("do"));
@@ -1402,15 +1861,28 @@ bool FBlueprintCompilerCppBackend::InnerFunctionImplementation(FKismetFunctionCo
 	{
 		if (ensure(TheOnlyEntryPoint))
 		{
-			TArray<FBlueprintCompiledStatement*>* FirstStatementList = FunctionContext.StatementsPerNode.Find(TheOnlyEntryPoint);
-			FBlueprintCompiledStatement* FirstStatement = (FirstStatementList && FirstStatementList->Num()) ? (*FirstStatementList)[0] : nullptr;
-			const int32 UberGraphOnlyEntryPoint = ensure(FirstStatement) ? StatementToStateIndex(FunctionContext, FirstStatement) : -1;
+			const TArrayView<FBlueprintCompiledStatement* const> FirstStatementList = FlatFunction.GetNodeStatements(TheOnlyEntryPoint);
+			const int32 UberGraphOnlyEntryPoint = ensure(FirstStatementList.Num()) ? FlatFunction.StatementToStateIndex(FirstStatementList[0]) : -1;
 			EmitterContext.AddLine(FString::Printf(TEXT("check(bpp__EntryPoint__pf == %d);"), UberGraphOnlyEntryPoint));
 			ActualLinearExecutionList = &LocalLinearExecutionList;
 		}
 	}
 
-	const bool bIsNotReducible = EmitAllStatements(FunctionContext, ExecutionGroup, EmitterContext, *ActualLinearExecutionList);
+	bool bIsNotReducible = false;
+	if (bUseStructuredControlFlow)
+	{
+		TArray<FBlueprintCompiledStatement*> Statements;
+		GatherStatements(FunctionContext, ExecutionGroup, *ActualLinearExecutionList, Statements);
+		for (const FBlueprintCompiledStatement* Statement : Statements)
+		{
+			bIsNotReducible |= !FKismetCompilerUtilities::IsStatementReducible(Statement->Type);
+		}
+		EmitStructuredNodes(StructuredControlFlow, StructuredControlFlow.GetRootNodes(), EmitterContext, FunctionContext);
+	}
+	else
+	{
+		bIsNotReducible = EmitAllStatements(FunctionContext, ExecutionGroup, EmitterContext, *ActualLinearExecutionList);
+	}
 
 	if (bUseGotoState)
 	{
@@ -1433,19 +1905,21 @@ bool FBlueprintCompilerCppBackend::InnerFunctionImplementation(FKismetFunctionCo
 	return bIsNotReducible;
 }
 
-bool FBlueprintCompilerCppBackend::SortNodesInUberGraphExecutionGroup(FKismetFunctionContext &FunctionContext, UEdGraphNode* TheOnlyEntryPoint, int32 ExecutionGroup, TArray<UEdGraphNode*> &LocalLinearExecutionList)
+bool FBlueprintCompilerCppBackend::SortNodesInUberGraphExecutionGroup(FKismetFunctionContext &FunctionContext, UEdGraphNode* TheOnlyEntryPoint, int32 ExecutionGroup, TArray<int32> &LocalLinearExecutionList)
 {	
-	ensure(FunctionContext.LinearExecutionList.Contains(TheOnlyEntryPoint));
+	const FFlatFunction& FlatFunction = GetFlatFunction(FunctionContext);
+	const int32 EntryPointIndex = FlatFunction.FindNode(TheOnlyEntryPoint);
+	ensure(EntryPointIndex != INDEX_NONE);
+
+	const FExecutionGroupInfo& ExecutionGroupInfo = GetExecutionGroupInfo(FunctionContext);
 
 	TArray<int32> ExecutionIndiceQueue;
 	int32 EntryIndiceIndex = INDEX_NONE;
-	for (int32 NodeIndex = 0; NodeIndex < FunctionContext.LinearExecutionList.Num(); ++NodeIndex)
+	for (int32 NodeIndex = 0; NodeIndex < FlatFunction.NumNodes(); ++NodeIndex)
 	{
-		UEdGraphNode* Node = FunctionContext.LinearExecutionList[NodeIndex];
-		auto UnsortedSeparateExecutionGroups = FKismetCompilerUtilities::FindUnsortedSeparateExecutionGroups(FunctionContext.LinearExecutionList);
-		if (UnsortedSeparateExecutionGroups[ExecutionGroup].Contains(Node))
+		if (ExecutionGroupInfo.IsInExecutionGroup(NodeIndex, ExecutionGroup))
 		{
-			if (Node == TheOnlyEntryPoint)
+			if (NodeIndex == EntryPointIndex)
 			{
 				EntryIndiceIndex = ExecutionIndiceQueue.Num();
 			}
@@ -1461,70 +1935,61 @@ bool FBlueprintCompilerCppBackend::SortNodesInUberGraphExecutionGroup(FKismetFun
 		// pop this from the execution queue (so we can detect if a separate statement requires a loop, jumping back to this one)
 		ExecutionIndiceQueue.RemoveAt(IndiceIndex, /*Count =*/1, /*bAllowShrinking =*/EAllowShrinking::No);
 
-		UEdGraphNode* CurrentNode = FunctionContext.LinearExecutionList[NodeIndex];
 		// here we're defining the (possibly new) execution order
-		LocalLinearExecutionList.Push(CurrentNode);
+		LocalLinearExecutionList.Push(NodeIndex);
 
 		int32 NextIndiceIndex = INDEX_NONE;
 		bool  bReturnExpected = false;
 
-		TArray<FBlueprintCompiledStatement*>* StatementList = FunctionContext.StatementsPerNode.Find(CurrentNode);
-		if (StatementList)
+		const TArrayView<FBlueprintCompiledStatement* const> StatementList = FlatFunction.GetNodeStatements(NodeIndex);
+		for (int32 StatementIndex = 0; StatementIndex < StatementList.Num() && !bDetectedCyclicalLogic; ++StatementIndex)
 		{
-			for (int32 StatementIndex = 0; StatementIndex < StatementList->Num() && !bDetectedCyclicalLogic; ++StatementIndex)
+			FBlueprintCompiledStatement& Statement = *StatementList[StatementIndex];
+			switch (Statement.Type)
 			{
-				FBlueprintCompiledStatement& Statement = *((*StatementList)[StatementIndex]);
-				switch (Statement.Type)
+			case KCST_ComputedGoto:
 				{
-				case KCST_ComputedGoto:
-					{
-						// sanity checking, that is all
-						ensure(!bFoundComputedGoto);
-						bFoundComputedGoto = true;
-						ensure(CurrentNode == TheOnlyEntryPoint);
-					}
-					break;
+					// sanity checking, that is all
+					ensure(!bFoundComputedGoto);
+					bFoundComputedGoto = true;
+					ensure(NodeIndex == EntryPointIndex);
+				}
+				break;
 
-				case KCST_UnconditionalGoto:
+			case KCST_UnconditionalGoto:
+				{
+					ensure(StatementIndex == (StatementList.Num() - 1)); // it should be the last statement generated from the node
+					ensure(Statement.TargetLabel);
+
+					// the node containing the statement we're supposed to jump to
+					const int32 JumpTarget = FlatFunction.JumpTargets[FlatFunction.NodeFirstStatement[NodeIndex] + StatementIndex];
+					const int32 TargetNodeIndex = (JumpTarget != INDEX_NONE) ? FlatFunction.StatementNodes[JumpTarget] : INDEX_NONE;
+					int32 TargetIndiceIndex = ExecutionIndiceQueue.Find(TargetNodeIndex);
+					if (TargetIndiceIndex == INDEX_NONE)
 					{
-						ensure(StatementIndex == (StatementList->Num() - 1)); // it should be the last statement generated from the node
-						ensure(Statement.TargetLabel);
-
-						int32 TargetIndiceIndex = 0;
-						for ( ; TargetIndiceIndex < ExecutionIndiceQueue.Num(); ++TargetIndiceIndex)
-						{
-							int32 TargetNodeIndex = ExecutionIndiceQueue[TargetIndiceIndex];
-							UEdGraphNode* RemainingNode = FunctionContext.LinearExecutionList[TargetNodeIndex];
-							
-							TArray<FBlueprintCompiledStatement*>* TargetStatementList = FunctionContext.StatementsPerNode.Find(RemainingNode);
-							// check and see if the statement we're supposed to jump to is contained within this node
-							if (TargetStatementList && TargetStatementList->Contains(Statement.TargetLabel))
-							{
-								break;
-							}
-						}
-						NextIndiceIndex = TargetIndiceIndex;
-
-						// if we couldn't find the target node (it was likely already processed - implying cyclical logic)
-						if (TargetIndiceIndex >= ExecutionIndiceQueue.Num())
-						{
-							bDetectedCyclicalLogic = true;
-						}
+						TargetIndiceIndex = ExecutionIndiceQueue.Num();
 					}
-					break;
+					NextIndiceIndex = TargetIndiceIndex;
 
-				case KCST_GotoReturn:
-				case KCST_EndOfThread:
+					// if we couldn't find the target node (it was likely already processed - implying cyclical logic)
+					if (TargetIndiceIndex >= ExecutionIndiceQueue.Num())
 					{
-						ensure(StatementIndex == (StatementList->Num() - 1)); // it should be the last statement generated from the node
-						bReturnExpected = true;
+						bDetectedCyclicalLogic = true;
 					}
-					break;
+				}
+				break;
 
-				default:
-					break;
-				};
-			}
+			case KCST_GotoReturn:
+			case KCST_EndOfThread:
+				{
+					ensure(StatementIndex == (StatementList.Num() - 1)); // it should be the last statement generated from the node
+					bReturnExpected = true;
+				}
+				break;
+
+			default:
+				break;
+			};
 		}
 
 		// if there was no goto statement, then we expect the statement to fall through to the next
@@ -1565,8 +2030,81 @@ bool FBlueprintCompilerCppBackend::SortNodesInUberGraphExecutionGroup(FKismetFun
 	return !bDetectedCyclicalLogic;
 }
 
+// Gathers inline pure calls reached from the term, inputs first. A call reached again is repeated, its inputs are not visited again.
+static void GatherInlinePureCalls(const FBPTerminal* Term, TArray<const FBPTerminal*>& OutCalls, TSet<const FBPTerminal*>& OutRepeated)
+{
+	for (; Term; Term = Term->Context)
+	{
+		const FBlueprintCompiledStatement* Inline = Term->InlineGeneratedParameter;
+		// The values of a switch are not all evaluated
+		if (!Inline || (KCST_SwitchValue == Inline->Type))
+		{
+			continue;
+		}
+
+		const bool bCall = (KCST_CallFunction == Inline->Type);
+		if (bCall && OutCalls.Contains(Term))
+		{
+			OutRepeated.Add(Term);
+			continue;
+		}
+		for (const FBPTerminal* Input : Inline->RHS)
+		{
+			GatherInlinePureCalls(Input, OutCalls, OutRepeated);
+		}
+		GatherInlinePureCalls(Inline->FunctionContext, OutCalls, OutRepeated);
+		if (bCall)
+		{
+			OutCalls.Add(Term);
+		}
+	}
+}
+
+void FBlueprintCompilerCppBackend::EmitCommonSubexpressions(const FBlueprintCompiledStatement& Statement, FEmitterLocalContext& EmitterContext)
+{
+	// The VM evaluates a pure node once for the node using it. The inlined calls would be evaluated for every input they are connected to.
+	static const FBoolConfigValueHelper DontShareCommonPureCalls(TEXT("BlueprintNativizationSettings"), TEXT("bDontShareCommonPureCalls"));
+	if (DontShareCommonPureCalls)
+	{
+		return;
+	}
+
+	TArray<const FBPTerminal*> Calls;
+	TSet<const FBPTerminal*> Repeated;
+	for (const FBPTerminal* Term : Statement.RHS)
+	{
+		GatherInlinePureCalls(Term, Calls, Repeated);
+	}
+	GatherInlinePureCalls(Statement.FunctionContext, Calls, Repeated);
+	GatherInlinePureCalls(Statement.LHS, Calls, Repeated);
+
+	for (const FBPTerminal* Term : Calls)
+	{
+		const UFunction* Function = Term->InlineGeneratedParameter->FunctionToCall;
+		const FProperty* ReturnProperty = Function ? Function->GetReturnProperty() : nullptr;
+		// Types of custom thunk parameters are only placeholders
+		const bool bIsCustomThunk = Function && (Function->GetBoolMetaData(FBlueprintMetadata::MD_CustomThunk)
+			|| Function->HasMetaData(FBlueprintMetadata::MD_CustomStructureParam)
+			|| Function->HasMetaData(FBlueprintMetadata::MD_ArrayParam));
+		FString ConstantValue;
+		if (!Repeated.Contains(Term) || !ReturnProperty || bIsCustomThunk || FoldConstantCall(Term, ConstantValue))
+		{
+			continue;
+		}
+
+		const uint32 ExportFlags = EPropertyExportCPPFlags::CPPF_CustomTypeName | EPropertyExportCPPFlags::CPPF_BlueprintCppBackend | EPropertyExportCPPFlags::CPPF_NoConst | EPropertyExportCPPFlags::CPPF_NoRef;
+		const FString CppType = EmitterContext.ExportCppDeclaration(ReturnProperty, EExportedDeclaration::Local, ExportFlags, FEmitterLocalContext::EPropertyNameInDeclaration::Skip);
+		const FString Expression = TermToText(EmitterContext, Term, ENativizedTermUsage::Getter);
+		const FString LocalName = EmitterContext.GenerateUniqueLocalName();
+		EmitterContext.AddLine(FString::Printf(TEXT("%s %s = %s;"), *CppType, *LocalName, *Expression));
+		EmitterContext.CommonSubexpressions.Add(Term, LocalName);
+	}
+}
+
 void FBlueprintCompilerCppBackend::EmitStatement(FBlueprintCompiledStatement &Statement, FEmitterLocalContext &EmitterContext, FKismetFunctionContext& FunctionContext)
 {
+	EmitCommonSubexpressions(Statement, EmitterContext);
+
 	switch (Statement.Type)
 	{
 	case KCST_Nop:
@@ -1657,36 +2195,38 @@ void FBlueprintCompilerCppBackend::EmitStatement(FBlueprintCompiledStatement &St
 		UE_LOG(LogK2Compiler, Error, TEXT("C++ backend encountered unsupported statement type %d"), (int32)Statement.Type);
 		break;
 	};
+
+	EmitterContext.CommonSubexpressions.Reset();
 }
 
-bool FBlueprintCompilerCppBackend::EmitAllStatements(FKismetFunctionContext &FunctionContext, int32 ExecutionGroup, FEmitterLocalContext &EmitterContext, const TArray<UEdGraphNode*>& LinearExecutionList)
+bool FBlueprintCompilerCppBackend::EmitAllStatements(FKismetFunctionContext &FunctionContext, int32 ExecutionGroup, FEmitterLocalContext &EmitterContext, const TArray<int32>& LinearExecutionList)
 {
-	auto UnsortedSeparateExecutionGroups = FKismetCompilerUtilities::FindUnsortedSeparateExecutionGroups(FunctionContext.LinearExecutionList);
+	FFlatFunction& FlatFunction = GetFlatFunction(FunctionContext);
+	const FExecutionGroupInfo& ExecutionGroupInfo = GetExecutionGroupInfo(FunctionContext);
 	
-	ensure(!bUseExecutionGroup || UnsortedSeparateExecutionGroups.IsValidIndex(ExecutionGroup));
+	ensure(!bUseExecutionGroup || ExecutionGroupInfo.ExecutionGroups.IsValidIndex(ExecutionGroup));
 	bool bFirsCase = true;
 
 	bool bAnyNonReducableStatement = false;
 
 	// Emit code in the order specified by the linear execution list (the first node is always the entry point for the function)
-	for (int32 NodeIndex = 0; NodeIndex < LinearExecutionList.Num(); ++NodeIndex)
+	for (const int32 NodeIndex : LinearExecutionList)
 	{
-		UEdGraphNode* StatementNode = LinearExecutionList[NodeIndex];
-		TArray<FBlueprintCompiledStatement*>* StatementList = FunctionContext.StatementsPerNode.Find(StatementNode);
+		UEdGraphNode* StatementNode = FunctionContext.LinearExecutionList[NodeIndex];
 		ensureMsgf(StatementNode && StatementNode->IsA<UK2Node>() && !CastChecked<UK2Node>(StatementNode)->IsNodePure()
 			, TEXT("Wrong Statement node %s in function %s")
 			, *GetPathNameSafe(StatementNode)
 			, *GetPathNameSafe(FunctionContext.Function));
 
-		const bool bIsCurrentExecutionGroup = !bUseExecutionGroup || UnsortedSeparateExecutionGroups[ExecutionGroup].Contains(StatementNode);
-		if (StatementList && bIsCurrentExecutionGroup)
+		const bool bIsCurrentExecutionGroup = !bUseExecutionGroup || ExecutionGroupInfo.IsInExecutionGroup(NodeIndex, ExecutionGroup);
+		if (bIsCurrentExecutionGroup)
 		{
-			for (int32 StatementIndex = 0; StatementIndex < StatementList->Num(); ++StatementIndex)
+			for (int32 StatementIndex = FlatFunction.NodeFirstStatement[NodeIndex]; StatementIndex < FlatFunction.NodeFirstStatement[NodeIndex + 1]; ++StatementIndex)
 			{
-				FBlueprintCompiledStatement& Statement = *((*StatementList)[StatementIndex]);
+				FBlueprintCompiledStatement& Statement = *FlatFunction.Statements[StatementIndex];
 				if ((Statement.bIsJumpTarget || bFirsCase) && bUseGotoState)
 				{
-					const int32 StateNum = StatementToStateIndex(FunctionContext, &Statement);
+					const int32 StateNum = FlatFunction.StatementToStateIndex(StatementIndex);
 					if (bFirsCase)
 					{
 						bFirsCase = false;
@@ -1710,23 +2250,106 @@ bool FBlueprintCompilerCppBackend::EmitAllStatements(FKismetFunctionContext &Fun
 	return bAnyNonReducableStatement;
 }
 
-bool FBlueprintCompilerCppBackend::PrepareToUseExecutionGroupWithoutGoto(FKismetFunctionContext &FunctionContext, int32 ExecutionGroup, UEdGraphNode* &TheOnlyEntryPoint)
+void FBlueprintCompilerCppBackend::GatherStatements(FKismetFunctionContext &FunctionContext, int32 ExecutionGroup, const TArray<int32>& LinearExecutionList, TArray<FBlueprintCompiledStatement*>& OutStatements)
+{
+	const FFlatFunction& FlatFunction = GetFlatFunction(FunctionContext);
+	const FExecutionGroupInfo& ExecutionGroupInfo = GetExecutionGroupInfo(FunctionContext);
+	for (const int32 NodeIndex : LinearExecutionList)
+	{
+		const bool bIsCurrentExecutionGroup = !bUseExecutionGroup || ExecutionGroupInfo.IsInExecutionGroup(NodeIndex, ExecutionGroup);
+		if (bIsCurrentExecutionGroup)
+		{
+			OutStatements.Append(FlatFunction.GetNodeStatements(NodeIndex));
+		}
+	}
+}
+
+void FBlueprintCompilerCppBackend::EmitStructuredNodes(const FStructuredControlFlow& ControlFlow, const TArray<int32>& NodeIndices, FEmitterLocalContext &EmitterContext, FKismetFunctionContext& FunctionContext)
+{
+	for (int32 NodeIndex : NodeIndices)
+	{
+		const FStructuredControlFlow::FNode& Node = ControlFlow.GetNode(NodeIndex);
+		switch (Node.Type)
+		{
+		case FStructuredControlFlow::ENodeType::Statement:
+			EmitStatement(*Node.Statement, EmitterContext, FunctionContext);
+			break;
+		case FStructuredControlFlow::ENodeType::If:
+			{
+				EmitCommonSubexpressions(*Node.Statement, EmitterContext);
+				const FString ConditionExpression = TermToText(EmitterContext, Node.Statement->LHS, ENativizedTermUsage::Getter);
+				EmitterContext.CommonSubexpressions.Reset();
+				EmitterContext.AddLine(FString::Printf(TEXT("if (%s%s)"), Node.bNegateCondition ? TEXT("!") : TEXT(""), *ConditionExpression));
+				{
+					FScopeBlock ThenScope(EmitterContext);
+					EmitStructuredNodes(ControlFlow, Node.Then, EmitterContext, FunctionContext);
+				}
+				if (Node.Else.Num())
+				{
+					EmitterContext.AddLine(TEXT("else"));
+					FScopeBlock ElseScope(EmitterContext);
+					EmitStructuredNodes(ControlFlow, Node.Else, EmitterContext, FunctionContext);
+				}
+			}
+			break;
+		case FStructuredControlFlow::ENodeType::Loop:
+			{
+				// the condition is evaluated on every iteration, so its pure calls are not shared (see EmitCommonSubexpressions)
+				const FString ConditionExpression = Node.Statement ? TermToText(EmitterContext, Node.Statement->LHS, ENativizedTermUsage::Getter) : FString();
+				if (Node.Increment)
+				{
+					EmitterContext.AddLine(FString::Printf(TEXT("for (; %s; %s)"), *ConditionExpression, *EmitAssignmentExpression(EmitterContext, *Node.Increment)));
+				}
+				else
+				{
+					EmitterContext.AddLine(FString::Printf(TEXT("while (%s)"), Node.Statement ? *ConditionExpression : TEXT("true")));
+				}
+				FScopeBlock LoopScope(EmitterContext);
+				EmitStructuredNodes(ControlFlow, Node.Then, EmitterContext, FunctionContext);
+			}
+			break;
+		case FStructuredControlFlow::ENodeType::Break:
+			EmitterContext.AddLine(TEXT("break;"));
+			break;
+		case FStructuredControlFlow::ENodeType::Continue:
+			EmitterContext.AddLine(TEXT("continue;"));
+			break;
+		case FStructuredControlFlow::ENodeType::Return:
+			if (FProperty* ReturnValue = FunctionContext.Function->GetReturnProperty())
+			{
+				EmitterContext.AddLine(FString::Printf(TEXT("return %s;"), *FEmitHelper::GetCppName(ReturnValue)));
+			}
+			else
+			{
+				EmitterContext.AddLine(TEXT("return;"));
+			}
+			break;
+		default:
+			check(false);
+			break;
+		}
+	}
+}
+
+bool FBlueprintCompilerCppBackend::PrepareToUseExecutionGroupWithoutGoto(FKismetFunctionContext &FunctionContext, int32 ExecutionGroup, UEdGraphNode* &TheOnlyEntryPoint, bool bAllowConditionalJumps)
 {
 	ensure(FunctionContext.bIsUbergraph && bUseExecutionGroup);
 
-	auto UnsortedSeparateExecutionGroups = FKismetCompilerUtilities::FindUnsortedSeparateExecutionGroups(FunctionContext.LinearExecutionList);
+	const FFlatFunction& FlatFunction = GetFlatFunction(FunctionContext);
+	const FExecutionGroupInfo& ExecutionGroupInfo = GetExecutionGroupInfo(FunctionContext);
 	
-	for (UEdGraphNode* Node : UnsortedSeparateExecutionGroups[ExecutionGroup])
+	for (UEdGraphNode* Node : ExecutionGroupInfo.GetNodes(ExecutionGroup))
 	{
-		if (Node && Node->IsA<UK2Node_ExecutionSequence>())
+		// the flow stack of sequences and loop macros is resolved when the control flow is reconstructed
+		if (Node && Node->IsA<UK2Node_ExecutionSequence>() && !bAllowConditionalJumps)
 		{
 			return false;
 		}
 
-		auto RequiresGoto = [](const FBlueprintCompiledStatement* Statement)->bool
+		auto RequiresGoto = [bAllowConditionalJumps](const FBlueprintCompiledStatement* Statement)->bool
 		{
-			// has no KCST_GotoIfNot state. Other states can be handled without switch
-			return Statement && (Statement->Type == KCST_PushState || Statement->Type == KCST_GotoIfNot);
+			// has no KCST_GotoIfNot nor KCST_PushState state (unless the control flow is reconstructed). Other states can be handled without switch
+			return Statement && (Statement->Type == KCST_PushState || Statement->Type == KCST_GotoIfNot) && !bAllowConditionalJumps;
 			//Statement->Type == KCST_UnconditionalGoto ||
 			//Statement->Type == KCST_ComputedGoto ||
 			//Statement->Type == KCST_EndOfThread ||
@@ -1734,8 +2357,7 @@ bool FBlueprintCompilerCppBackend::PrepareToUseExecutionGroupWithoutGoto(FKismet
 			//Statement->Type == KCST_GotoReturn ||
 			//Statement->Type == KCST_GotoReturnIfNot
 		};
-		TArray<FBlueprintCompiledStatement*>* StatementList = FunctionContext.StatementsPerNode.Find(Node);
-		if (StatementList && StatementList->ContainsByPredicate(RequiresGoto))
+		if (FlatFunction.GetNodeStatements(Node).ContainsByPredicate(RequiresGoto))
 		{
 			return false;
 		}
@@ -1766,18 +2388,18 @@ bool FBlueprintCompilerCppBackend::PrepareToUseExecutionGroupWithoutGoto(FKismet
 			{
 				UEdGraphNode* OwnerNode = Link ? Link->GetOwningNodeUnchecked() : nullptr;
 
-				if (OwnerNode && UnsortedSeparateExecutionGroups[ExecutionGroup].Contains(OwnerNode))
+				if (OwnerNode && ExecutionGroupInfo.IsInExecutionGroup(OwnerNode, ExecutionGroup))
 				{
 					if (!TheOnlyEntryPoint)
 					{
 						TheOnlyEntryPoint = OwnerNode;
 
-						TArray<FBlueprintCompiledStatement*>* OwnerStatementList = FunctionContext.StatementsPerNode.Find(OwnerNode);
-						FBlueprintCompiledStatement* FirstStatementToCall = (OwnerStatementList && OwnerStatementList->Num()) ? (*OwnerStatementList)[0] : nullptr;
-						TArray<FBlueprintCompiledStatement*>* LatentCallStatementList = FunctionContext.StatementsPerNode.Find(CallFunctionNode);
-						check(LatentCallStatementList && FirstStatementToCall);
+						const TArrayView<FBlueprintCompiledStatement* const> OwnerStatementList = FlatFunction.GetNodeStatements(OwnerNode);
+						FBlueprintCompiledStatement* FirstStatementToCall = OwnerStatementList.Num() ? OwnerStatementList[0] : nullptr;
+						const TArrayView<FBlueprintCompiledStatement* const> LatentCallStatementList = FlatFunction.GetNodeStatements(CallFunctionNode);
+						check(LatentCallStatementList.Num() && FirstStatementToCall);
 						bool bMatch = false;
-						for (FBlueprintCompiledStatement* LatentCallStatement : *LatentCallStatementList)
+						for (FBlueprintCompiledStatement* LatentCallStatement : LatentCallStatementList)
 						{
 							if (LatentCallStatement && (KCST_CallFunction == LatentCallStatement->Type))
 							{
@@ -5,6 +5,7 @@
 #include "BlueprintCompilerCppBackendBase.h"
 
 struct FEmitterLocalContext;
+struct FStructuredControlFlow;
 
 enum class ENativizedTermUsage : uint8
 {
@@ -20,6 +21,8 @@ protected:
 	bool bUseExecutionGroup;
 	bool bUseFlowStack;
 	bool bUseGotoState;
+	// Values of pure calls folded for the functions of the class (see FoldConstantCalls), unset when the call cannot be folded
+	TMap<const FBPTerminal*, TOptional<FString>> ConstantCallValues;
 public:
 	FBlueprintCompilerCppBackend()
 		: FBlueprintCompilerCppBackendBase()
@@ -28,16 +31,26 @@ public:
 		, bUseGotoState(false)
 	{}
 
+	virtual void FoldConstantCalls(const TIndirectArray<FKismetFunctionContext>& Functions) override;
+
 protected:
 	virtual bool InnerFunctionImplementation(FKismetFunctionContext& FunctionContext, FEmitterLocalContext& EmitterContext, int32 ExecutionGroup) override;
 
-	// creates local linear execution list ,returns if the execution group can be handled without switch
-	bool SortNodesInUberGraphExecutionGroup(FKismetFunctionContext &FunctionContext, UEdGraphNode* TheOnlyEntryPoint, int32 ExecutionGroup, TArray<UEdGraphNode*> &LocalLinearExecutionList);
+	// creates local linear execution list (of node indices, see FFlatFunction), returns if the execution group can be handled without switch
+	bool SortNodesInUberGraphExecutionGroup(FKismetFunctionContext &FunctionContext, UEdGraphNode* TheOnlyEntryPoint, int32 ExecutionGroup, TArray<int32> &LocalLinearExecutionList);
 	// return if the execution group can be handled without switch
-	bool PrepareToUseExecutionGroupWithoutGoto(FKismetFunctionContext &FunctionContext, int32 ExecutionGroup, UEdGraphNode* &TheOnlyEntryPoint);
+	bool PrepareToUseExecutionGroupWithoutGoto(FKismetFunctionContext &FunctionContext, int32 ExecutionGroup, UEdGraphNode* &TheOnlyEntryPoint, bool bAllowConditionalJumps);
+	// collects statements of the nodes (from the current execution group), in the order of the list
+	void GatherStatements(FKismetFunctionContext &FunctionContext, int32 ExecutionGroup, const TArray<int32>& LinearExecutionList, TArray<FBlueprintCompiledStatement*>& OutStatements);
 	// returns if the function performs any significant action (it is not reducible)
-	bool EmitAllStatements(FKismetFunctionContext &FunctionContext, int32 ExecutionGroup, FEmitterLocalContext &EmitterContext, const TArray<UEdGraphNode*>& LinearExecutionList);
+	bool EmitAllStatements(FKismetFunctionContext &FunctionContext, int32 ExecutionGroup, FEmitterLocalContext &EmitterContext, const TArray<int32>& LinearExecutionList);
+	// emits if/else, loops and early returns instead of the switch (see FStructuredControlFlow)
+	void EmitStructuredNodes(const FStructuredControlFlow& ControlFlow, const TArray<int32>& NodeIndices, FEmitterLocalContext &EmitterContext, FKismetFunctionContext& FunctionContext);
 	void EmitStatement(FBlueprintCompiledStatement &Statement, FEmitterLocalContext &EmitterContext, FKismetFunctionContext& FunctionContext);
+	// evaluates pure calls used more than once by the statement into locals (see FEmitterLocalContext::CommonSubexpressions)
+	void EmitCommonSubexpressions(const FBlueprintCompiledStatement& Statement, FEmitterLocalContext& EmitterContext);
+	// returns if the inline call has only constant inputs and could be evaluated, its value is in the pin default value format. Calls are evaluated on the game thread only.
+	bool FoldConstantCall(const FBPTerminal* Term, FString& OutValue);
 
 protected:
 	void EmitCallStatment(FEmitterLocalContext& EmitterContext, FKismetFunctionContext& FunctionContext, FBlueprintCompiledStatement& Statement);
@@ -62,10 +75,13 @@ protected:
 
 protected:
 	FString LatentFunctionInfoTermToText(FEmitterLocalContext& EmitterContext, FBPTerminal* Term, FBlueprintCompiledStatement* TargetLabel);
+	TArray<FString> EmitMethodInputParameters(FEmitterLocalContext& EmitterContext, FBlueprintCompiledStatement& Statement, bool bMarkOutParams);
 	FString EmitMethodInputParameterList(FEmitterLocalContext& EmitterContext, FBlueprintCompiledStatement& Statement);
 	FString EmitSwitchValueStatmentInner(FEmitterLocalContext& EmitterContext, FBlueprintCompiledStatement& Statement);
 	FString EmitCallStatmentInner(FEmitterLocalContext& EmitterContext, FBlueprintCompiledStatement& Statement, bool bInline, FString PostFix);
 	FString EmitArrayGetByRef(FEmitterLocalContext& EmitterContext, FBlueprintCompiledStatement& Statement);
+	// "Destination = Source" without the semicolon, also used as the increment of a "for" loop
+	FString EmitAssignmentExpression(FEmitterLocalContext& EmitterContext, FBlueprintCompiledStatement& Statement);
 
 public:
 	struct FTermToTextParams
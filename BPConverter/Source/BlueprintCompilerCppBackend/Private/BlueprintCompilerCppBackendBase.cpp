@@ -9,6 +9,7 @@
 #include "Kismet/BlueprintFunctionLibrary.h"
 #include "Animation/AnimBlueprintGeneratedClass.h"
 #include "Engine/UserDefinedEnum.h"
+#include "EdGraphSchema_K2.h"
 #include "K2Node_Event.h"
 #include "K2Node_CallFunction.h"
 #include "K2Node_CreateDelegate.h"
@@ -67,13 +68,17 @@ TArray<class UFunction*> IBlueprintCompilerCppBackendModule::CollectBoundFunctio
 	return Result;
 }
 
-void FBlueprintCompilerCppBackendBase::EmitStructProperties(FEmitterLocalContext& EmitterContext, UStruct* SourceClass)
+void FBlueprintCompilerCppBackendBase::EmitStructProperties(FEmitterLocalContext& EmitterContext, UStruct* SourceClass, const TSet<const FProperty*>* PropertiesToSkip)
 {
 	// Emit class variables
 	for (TFieldIterator<FProperty> It(SourceClass, EFieldIteratorFlags::ExcludeSuper); It; ++It)
 	{
 		FProperty* Property = *It;
 		check(Property);
+		if (PropertiesToSkip && PropertiesToSkip->Contains(Property))
+		{
+			continue;
+		}
 		FString PropertyMacro(TEXT("UPROPERTY("));
 		{
 			TArray<FString> Tags = FEmitHelper::PropertyFlagsToTags(Property->PropertyFlags, nullptr != Cast<UClass>(SourceClass));
@@ -263,14 +268,15 @@ struct FIncludedUnconvertedWrappers
 	FEmitterLocalContext& Context;
 	bool bInludeInBody;
 
-	static const TCHAR* Placeholder()
+	static FName SlotName()
 	{
-		return TEXT("//PlaceholderForUnconvertedWrappersInlude");
+		static const FName UnconvertedWrappersIncludeSlot(TEXT("UnconvertedWrappersInclude"));
+		return UnconvertedWrappersIncludeSlot;
 	}
 
 	static void AddPlaceholder(FEmitterLocalContext& InContext, bool bInInludeInBody)
 	{
-		(bInInludeInBody ? InContext.Body : InContext.Header).AddLine(Placeholder());
+		(bInInludeInBody ? InContext.Body : InContext.Header).AddSlot(SlotName());
 	}
 
 	static void FillPlaceholder(FEmitterLocalContext& InContext, bool bInInludeInBody)
@@ -278,7 +284,7 @@ struct FIncludedUnconvertedWrappers
 		FCodeText AdditionalIncludes;
 		TSet<FString> DummyStrSet;
 		FIncludeHeaderHelper::EmitInner(AdditionalIncludes, InContext.UsedUnconvertedWrapper, TSet<UField*>{}, InContext.NativizationOptions, DummyStrSet);
-		(bInInludeInBody ? InContext.Body : InContext.Header).Result.ReplaceInline(Placeholder(), *AdditionalIncludes.Result);
+		(bInInludeInBody ? InContext.Body : InContext.Header).FillSlot(SlotName(), MoveTemp(AdditionalIncludes));
 	}
 
 	FIncludedUnconvertedWrappers(FEmitterLocalContext& InContext, bool bInInludeInBody)
@@ -296,33 +302,21 @@ struct FIncludedUnconvertedWrappers
 
 FString FBlueprintCompilerCppBackendBase::GenerateCodeFromClass(UClass* SourceClass, TIndirectArray<FKismetFunctionContext>& Functions, bool bGenerateStubsOnly, const FCompilerNativizationOptions& NativizationOptions, FString& OutCppBody)
 {
+	BP_CONVERTER_PHASE_SCOPE(GenerateCodeFromClass);
 	CleanBackend();
 
 	for (auto& FunctionContext : Functions)
 	{
-		auto UnsortedSeparateExecutionGroups = FKismetCompilerUtilities::FindUnsortedSeparateExecutionGroups(FunctionContext.LinearExecutionList);
-
 		if (FunctionContext.bIsUbergraph)
 		{
 			UberGraphContext = &FunctionContext;
-			for (int32 ExecutionGroupIndex = 0; ExecutionGroupIndex < UnsortedSeparateExecutionGroups.Num(); ++ExecutionGroupIndex)
-			{
-				TSet<UEdGraphNode*>& ExecutionGroup = UnsortedSeparateExecutionGroups[ExecutionGroupIndex];
-				for (UEdGraphNode* LocNode : ExecutionGroup)
-				{
-					TArray<FBlueprintCompiledStatement*>* LocStatementsPtr = FunctionContext.StatementsPerNode.Find(LocNode);
-					if (ensure(LocStatementsPtr))
-					{
-						for (FBlueprintCompiledStatement* LocStatement : *LocStatementsPtr)
-						{
-							UberGraphStatementToExecutionGroup.Add(LocStatement, ExecutionGroupIndex);
-						}
-					}
-				}
-			}
 			break;
 		}
 	}
+	if (!bGenerateStubsOnly)
+	{
+		GatherPromotedUberGraphVariables(SourceClass, Functions);
+	}
 
 	// use GetBaseFilename() so that we can coordinate #includes and filenames
 	auto CleanCppClassName = FEmitHelper::GetBaseFilename(SourceClass, NativizationOptions);
@@ -332,18 +326,18 @@ FString FBlueprintCompilerCppBackendBase::GenerateCodeFromClass(UClass* SourceCl
 	FNativizationSummaryHelper::RegisterRequiredModules(NativizationOptions.PlatformName, Dependencies->RequiredModuleNames);
 	FEmitterLocalContext EmitterContext(Dependencies.ToSharedRef().Get(), NativizationOptions);
 
+	// It's the source class itself, when the code is translated from its bytecode (see FBlueprintBytecodeTranslator)
 	UClass* OriginalSourceClass = Dependencies->FindOriginalClass(SourceClass);
-	ensure(OriginalSourceClass != SourceClass);
 
 	FNativizationSummaryHelper::RegisterClass(OriginalSourceClass);
 
 	EmitFileBeginning(CleanCppClassName, EmitterContext);
 
-	const TCHAR* PlaceholderForInlinedStructInlude = TEXT("//PlaceholderForInlinedStructInlude");
+	static const FName InlinedStructIncludeSlot(TEXT("InlinedStructInclude"));
 	const bool bIsInterface = SourceClass->IsChildOf<UInterface>();
 	if (!bIsInterface)
 	{
-		EmitterContext.Body.AddLine(PlaceholderForInlinedStructInlude);
+		EmitterContext.Body.AddSlot(InlinedStructIncludeSlot);
 	}
 
 	const bool bHasStaticSearchableValues = FBackendHelperStaticSearchableValues::HasSearchableValues(SourceClass);
@@ -409,7 +403,7 @@ FString FBlueprintCompilerCppBackendBase::GenerateCodeFromClass(UClass* SourceCl
 
 		DeclareDelegates(EmitterContext, Functions);
 
-		EmitStructProperties(EmitterContext, SourceClass);
+		EmitStructProperties(EmitterContext, SourceClass, &PromotedUberGraphVariables);
 
 		{
 			IBlueprintCompilerCppBackendModule& BackEndModule = (IBlueprintCompilerCppBackendModule&)IBlueprintCompilerCppBackendModule::Get();
@@ -419,8 +413,9 @@ FString FBlueprintCompilerCppBackendBase::GenerateCodeFromClass(UClass* SourceCl
 				for (TFieldIterator<FProperty> It(SourceClass, EFieldIteratorFlags::ExcludeSuper); It; ++It)
 				{
 					FProperty* Property = *It;
-					if (Property && Property->HasAllPropertyFlags(CPF_Transient | CPF_DuplicateTransient))
+					if (Property && Property->HasAllPropertyFlags(CPF_Transient | CPF_DuplicateTransient) && !PromotedUberGraphVariables.Contains(Property))
 					{
+						FScopeLock Lock(&NativizationSummary->CriticalSection);
 						NativizationSummary->MemberVariablesFromGraph++;
 					}
 				}
@@ -441,6 +436,9 @@ FString FBlueprintCompilerCppBackendBase::GenerateCodeFromClass(UClass* SourceCl
 
 			EmitterContext.Header.AddLine(TEXT("static void __StaticDependenciesAssets(TArray<FBlueprintDependencyData>& AssetsToLoad);"));
 			EmitterContext.Header.AddLine(TEXT("static void __StaticDependencies_DirectlyUsedAssets(TArray<FBlueprintDependencyData>& AssetsToLoad);"));
+			EmitterContext.Header.AddLine(TEXT("static TObjectPtr<UObject> __UsedAssetsTable[];"));
+			EmitterContext.Header.AddLine(TEXT("static const TObjectPtr<UObject>* __UsedAssets();"));
+			EmitterContext.Header.AddLine(TEXT("static void AddReferencedObjects(UObject* InThis, FReferenceCollector& Collector);"));
 			if (bHasStaticSearchableValues)
 			{
 				FBackendHelperStaticSearchableValues::EmitFunctionDeclaration(EmitterContext);
@@ -450,13 +448,6 @@ FString FBlueprintCompilerCppBackendBase::GenerateCodeFromClass(UClass* SourceCl
 			FEmitDefaultValueHelper::GenerateCustomDynamicClassInitialization(EmitterContext, ParentDependencies);
 		}
 
-		// Create the state map
-		for (int32 i = 0; i < Functions.Num(); ++i)
-		{
-			StateMapPerFunction.Add(FFunctionLabelInfo());
-			FunctionIndexMap.Add(&Functions[i], i);
-		}
-
 		for (int32 i = 0; i < Functions.Num(); ++i)
 		{
 			if (Functions[i].IsValid())
@@ -490,13 +481,13 @@ FString FBlueprintCompilerCppBackendBase::GenerateCodeFromClass(UClass* SourceCl
 		FCodeText AdditionalIncludes;
 		TSet<FString> DummyStrSet;
 		FIncludeHeaderHelper::EmitInner(AdditionalIncludes, EmitterContext.StructsUsedAsInlineValues, TSet<UField*>{}, EmitterContext.NativizationOptions, DummyStrSet);
-		EmitterContext.Body.Result.ReplaceInline(PlaceholderForInlinedStructInlude, *AdditionalIncludes.Result);
+		EmitterContext.Body.FillSlot(InlinedStructIncludeSlot, MoveTemp(AdditionalIncludes));
 	}
 
 	CleanBackend();
 
-	OutCppBody = EmitterContext.Body.Result;
-	return EmitterContext.Header.Result;
+	OutCppBody = EmitterContext.Body.MoveToString();
+	return EmitterContext.Header.MoveToString();
 }
 
 static void PropertiesUsedByStatement(FBlueprintCompiledStatement* Statement, TSet<FProperty*>& Properties)
@@ -527,24 +518,18 @@ static void PropertiesUsedByStatement(FBlueprintCompiledStatement* Statement, TS
 }
 
 /** Emits local variable declarations for a function */
-static void DeclareLocalVariables(FEmitterLocalContext& EmitterContext, TArray<FProperty*>& LocalVariables, FKismetFunctionContext& FunctionContext, int32 ExecutionGroup)
+static void DeclareLocalVariables(FEmitterLocalContext& EmitterContext, TArray<FProperty*>& LocalVariables, const TArray<FBlueprintCompiledStatement*>& Statements, const TArray<int32>& StatementNodes, const TBitArray<>* ExecutionGroupNodes)
 {
-	const bool bUseExecutionGroup = ExecutionGroup >= 0;
+	const bool bUseExecutionGroup = ExecutionGroupNodes != nullptr;
 	TSet<FProperty*> PropertiesUsedByCurrentExecutionGroup;
 
-	auto UnsortedSeparateExecutionGroups = FKismetCompilerUtilities::FindUnsortedSeparateExecutionGroups(FunctionContext.LinearExecutionList);
-
 	if (bUseExecutionGroup)
 	{
-		for (UEdGraphNode* Node : UnsortedSeparateExecutionGroups[ExecutionGroup])
+		for (int32 StatementIndex = 0; StatementIndex < Statements.Num(); ++StatementIndex)
 		{
-			TArray<FBlueprintCompiledStatement*>* StatementList = FunctionContext.StatementsPerNode.Find(Node);
-			if (StatementList)
+			if ((*ExecutionGroupNodes)[StatementNodes[StatementIndex]])
 			{
-				for (FBlueprintCompiledStatement* Statement : *StatementList)
-				{
-					PropertiesUsedByStatement(Statement, PropertiesUsedByCurrentExecutionGroup);
-				}
+				PropertiesUsedByStatement(Statements[StatementIndex], PropertiesUsedByCurrentExecutionGroup);
 			}
 		}
 	}
@@ -562,16 +547,115 @@ static void DeclareLocalVariables(FEmitterLocalContext& EmitterContext, TArray<F
 	}
 }
 
-void FBlueprintCompilerCppBackendBase::ConstructFunction(FKismetFunctionContext& FunctionContext, FEmitterLocalContext& EmitterContext, bool bGenerateStubOnly)
+static void LiteralTermsUsedByStatement(FBlueprintCompiledStatement* Statement, TArray<const FBPTerminal*>& Literals, TSet<const FBPTerminal*>& BoundToMutableReference)
 {
+	if (Statement)
+	{
+		auto AddTerm = [&](const FBPTerminal* Terminal)
+		{
+			if (Terminal)
+			{
+				if (Terminal->bIsLiteral)
+				{
+					Literals.AddUnique(Terminal);
+				}
+				LiteralTermsUsedByStatement(Terminal->InlineGeneratedParameter, Literals, BoundToMutableReference);
+			}
+		};
 
-	auto UnsortedSeparateExecutionGroups = FKismetCompilerUtilities::FindUnsortedSeparateExecutionGroups(FunctionContext.LinearExecutionList);
+		for (FBPTerminal* Terminal : Statement->RHS)
+		{
+			AddTerm(Terminal);
+		}
+		AddTerm(Statement->FunctionContext);
+		AddTerm(Statement->LHS);
 
+		// A constant cannot be passed as a non-const reference
+		if (Statement->FunctionToCall)
+		{
+			int32 ParamIndex = 0;
+			for (TFieldIterator<FProperty> PropIt(Statement->FunctionToCall); PropIt && (PropIt->PropertyFlags & CPF_Parm) && Statement->RHS.IsValidIndex(ParamIndex); ++PropIt)
+			{
+				if (PropIt->HasAnyPropertyFlags(CPF_ReturnParm))
+				{
+					continue;
+				}
+				if (PropIt->HasAnyPropertyFlags(CPF_OutParm) && !PropIt->HasAnyPropertyFlags(CPF_ConstParm))
+				{
+					BoundToMutableReference.Add(Statement->RHS[ParamIndex]);
+				}
+				++ParamIndex;
+			}
+		}
+	}
+}
+
+/** Emits each distinct name, string and text literal used by the function body once, as a function-static constant. Otherwise the names would be looked up (and the strings allocated) on every call. */
+static void DeclareLiteralConstants(FEmitterLocalContext& EmitterContext, const TArray<FBlueprintCompiledStatement*>& Statements, const TArray<int32>& StatementNodes, const TBitArray<>* ExecutionGroupNodes)
+{
+	TArray<const FBPTerminal*> Literals;
+	TSet<const FBPTerminal*> BoundToMutableReference;
+	for (int32 StatementIndex = 0; StatementIndex < Statements.Num(); ++StatementIndex)
+	{
+		if (!ExecutionGroupNodes || (*ExecutionGroupNodes)[StatementNodes[StatementIndex]])
+		{
+			LiteralTermsUsedByStatement(Statements[StatementIndex], Literals, BoundToMutableReference);
+		}
+	}
+
+	TMap<FString, FString> ConstantPerValue;
+	for (const FBPTerminal* Literal : Literals)
+	{
+		const FEdGraphPinType& Type = Literal->Type;
+		if (Type.IsContainer() || BoundToMutableReference.Contains(Literal))
+		{
+			continue;
+		}
+
+		const TCHAR* NativeType = nullptr;
+		if (Type.PinCategory == UEdGraphSchema_K2::PC_Name)
+		{
+			NativeType = TEXT("FName");
+		}
+		else if (Type.PinCategory == UEdGraphSchema_K2::PC_String)
+		{
+			NativeType = TEXT("FString");
+		}
+		else if (Type.PinCategory == UEdGraphSchema_K2::PC_Text)
+		{
+			NativeType = TEXT("FText");
+		}
+		const bool bEmptyValue = (Type.PinCategory == UEdGraphSchema_K2::PC_Text) ? Literal->TextLiteral.IsEmpty() : Literal->Name.IsEmpty();
+		if (!NativeType || bEmptyValue)
+		{
+			continue;
+		}
+
+		FEmitHelper::FLiteralTermParams LiteralTermParams;
+		LiteralTermParams.Type = Type;
+		LiteralTermParams.CustomValue = Literal->Name;
+		LiteralTermParams.LiteralText = Literal->TextLiteral;
+		const FString Value = FEmitHelper::LiteralTerm(EmitterContext, LiteralTermParams);
+
+		FString* Constant = ConstantPerValue.Find(Value);
+		if (!Constant)
+		{
+			Constant = &ConstantPerValue.Add(Value, EmitterContext.GenerateUniqueLocalName());
+			EmitterContext.AddLine(FString::Printf(TEXT("static const %s %s = %s;"), NativeType, **Constant, *Value));
+		}
+		EmitterContext.LiteralConstants.Add(Literal, *Constant);
+	}
+}
+
+void FBlueprintCompilerCppBackendBase::ConstructFunction(FKismetFunctionContext& FunctionContext, FEmitterLocalContext& EmitterContext, bool bGenerateStubOnly)
+{
 	if (FunctionContext.IsDelegateSignature())
 	{
 		return;
 	}
 
+	const FExecutionGroupInfo& ExecutionGroupInfo = GetExecutionGroupInfo(FunctionContext);
+
 	TArray<FProperty*> LocalVariables;
 	TArray<FProperty*> ArgumentList;
 	// Split the function property list into arguments, a return value (if any), and local variable declarations
@@ -581,6 +665,10 @@ void FBlueprintCompilerCppBackendBase::ConstructFunction(FKismetFunctionContext&
 		TArray<FProperty*>& PropertyDest = bNeedLocalVariable ? LocalVariables : ArgumentList;
 		PropertyDest.Add(Property);
 	}
+	if (FunctionContext.bIsUbergraph)
+	{
+		LocalVariables.Append(UberGraphLocalVariables);
+	}
 
 	static const FBoolConfigValueHelper UsePRAGMA_DISABLE_OPTIMIZATION(TEXT("BlueprintNativizationSettings"), TEXT("bUsePRAGMA_DISABLE_OPTIMIZATION"));
 	if (FunctionContext.bIsUbergraph && UsePRAGMA_DISABLE_OPTIMIZATION)
@@ -588,15 +676,15 @@ void FBlueprintCompilerCppBackendBase::ConstructFunction(FKismetFunctionContext&
 		EmitterContext.AddLine(TEXT("PRAGMA_DISABLE_OPTIMIZATION"));
 	}
 
-	TArray<FString> BodyFunctionsDeclaration = ConstructFunctionDeclaration(EmitterContext, FunctionContext, ArgumentList);
-	ensure((BodyFunctionsDeclaration.Num() == UnsortedSeparateExecutionGroups.Num())
-		|| ((1 == BodyFunctionsDeclaration.Num()) && (0 == UnsortedSeparateExecutionGroups.Num())));
+	TArray<FString> BodyFunctionsDeclaration = ConstructFunctionDeclaration(EmitterContext, FunctionContext, ExecutionGroupInfo, ArgumentList);
+	ensure((BodyFunctionsDeclaration.Num() == ExecutionGroupInfo.Num())
+		|| ((1 == BodyFunctionsDeclaration.Num()) && !ExecutionGroupInfo.HasExecutionGroups()));
 
 	const bool bIsConstFunction = FunctionContext.Function->HasAllFunctionFlags(FUNC_Const);
 	const bool bUseInnerFunctionImplementation = bIsConstFunction && !FunctionContext.Function->HasAnyFunctionFlags(FUNC_Static);
 	if (bUseInnerFunctionImplementation)
 	{
-		ensure(0 == UnsortedSeparateExecutionGroups.Num());
+		ensure(!ExecutionGroupInfo.HasExecutionGroups());
 		ensure(1 == BodyFunctionsDeclaration.Num());
 		const FString InnerImplementationFunctionName = FString::Printf(TEXT("%s_Inner_%d")
 			, *FEmitHelper::GetCppName(FunctionContext.Function)
@@ -629,8 +717,8 @@ void FBlueprintCompilerCppBackendBase::ConstructFunction(FKismetFunctionContext&
 			, *ReturnType, *ClassCppName, *InnerImplementationFunctionName, *ArgList));
 
 	}
-	const bool bManyExecutionGroups = UnsortedSeparateExecutionGroups.Num() > 0;
-	for (int32 ExecutionGroupIndex = bManyExecutionGroups ? 0 : -1; ExecutionGroupIndex < UnsortedSeparateExecutionGroups.Num(); ExecutionGroupIndex++)
+	const bool bManyExecutionGroups = ExecutionGroupInfo.HasExecutionGroups();
+	for (int32 ExecutionGroupIndex = bManyExecutionGroups ? 0 : -1; ExecutionGroupIndex < ExecutionGroupInfo.Num(); ExecutionGroupIndex++)
 	{
 		if (!bUseInnerFunctionImplementation)
 		{
@@ -655,8 +743,12 @@ void FBlueprintCompilerCppBackendBase::ConstructFunction(FKismetFunctionContext&
 				}
 			}
 			const int32 ExecutionGroup = bManyExecutionGroups ? ExecutionGroupIndex : -1;
-			DeclareLocalVariables(EmitterContext, LocalVariables, FunctionContext, ExecutionGroup);
+			const FFlatFunction& FlatFunction = GetFlatFunction(FunctionContext);
+			const TBitArray<>* ExecutionGroupNodes = bManyExecutionGroups ? &ExecutionGroupInfo.ExecutionGroupNodes[ExecutionGroup] : nullptr;
+			DeclareLocalVariables(EmitterContext, LocalVariables, FlatFunction.Statements, FlatFunction.StatementNodes, ExecutionGroupNodes);
+			DeclareLiteralConstants(EmitterContext, FlatFunction.Statements, FlatFunction.StatementNodes, ExecutionGroupNodes);
 			ConstructFunctionBody(EmitterContext, FunctionContext, ExecutionGroup);
+			EmitterContext.LiteralConstants.Empty();
 		}
 
 		if (FProperty* ReturnValue = FunctionContext.Function->GetReturnProperty())
@@ -674,10 +766,8 @@ void FBlueprintCompilerCppBackendBase::ConstructFunction(FKismetFunctionContext&
 	}
 }
 
-TArray<FString> FBlueprintCompilerCppBackendBase::ConstructFunctionDeclaration(FEmitterLocalContext &EmitterContext, FKismetFunctionContext &FunctionContext, TArray<FProperty*> &ArgumentList)
+TArray<FString> FBlueprintCompilerCppBackendBase::ConstructFunctionDeclaration(FEmitterLocalContext &EmitterContext, FKismetFunctionContext &FunctionContext, const FExecutionGroupInfo& ExecutionGroupInfo, TArray<FProperty*> &ArgumentList)
 {
-	auto UnsortedSeparateExecutionGroups = FKismetCompilerUtilities::FindUnsortedSeparateExecutionGroups(FunctionContext.LinearExecutionList);
-
 	FString FunctionHeaderName = FEmitHelper::GetCppName(FunctionContext.Function);
 	FString FunctionBodyName = FunctionHeaderName;
 	const bool bStaticFunction = FunctionContext.Function->HasAllFunctionFlags(FUNC_Static);
@@ -812,16 +902,17 @@ TArray<FString> FBlueprintCompilerCppBackendBase::ConstructFunctionDeclaration(F
 		}
 	}
 
-	const bool bManyExecutionGroups = UnsortedSeparateExecutionGroups.Num() > 0;
+	const bool bManyExecutionGroups = ExecutionGroupInfo.HasExecutionGroups();
 
 	TArray<FString> Result;
-	for (int32 ExecutionGroupIndex = bManyExecutionGroups ? 0 : -1; ExecutionGroupIndex < UnsortedSeparateExecutionGroups.Num(); ExecutionGroupIndex++)
+	for (int32 ExecutionGroupIndex = bManyExecutionGroups ? 0 : -1; ExecutionGroupIndex < ExecutionGroupInfo.Num(); ExecutionGroupIndex++)
 	{
 		bool bNeedMacro = true;
 		if (bManyExecutionGroups)
 		{
-			bNeedMacro = false;
-			for (UEdGraphNode* NodeIt : UnsortedSeparateExecutionGroups[ExecutionGroupIndex])
+			// the latent action manager calls the function by name
+			bNeedMacro = ExecutionGroupInfo.IsLatentResumeGroup(ExecutionGroupIndex);
+			for (UEdGraphNode* NodeIt : ExecutionGroupInfo.GetNodes(ExecutionGroupIndex))
 			{
 				UK2Node_CallFunction* CallFuncNode = Cast<UK2Node_CallFunction>(NodeIt);
 				if (CallFuncNode && CallFuncNode->IsLatentFunction())
@@ -919,36 +1010,12 @@ FString FBlueprintCompilerCppBackendBase::GenerateReturnType(const FEmitterLocal
 
 void FBlueprintCompilerCppBackendBase::ConstructFunctionBody(FEmitterLocalContext& EmitterContext, FKismetFunctionContext &FunctionContext, int32 ExecutionGroup)
 {
-	auto UnsortedSeparateExecutionGroups = FKismetCompilerUtilities::FindUnsortedSeparateExecutionGroups(FunctionContext.LinearExecutionList);
-
-	if (UnsortedSeparateExecutionGroups.Num() && (ExecutionGroup < 0))
+	if (GetExecutionGroupInfo(FunctionContext).HasExecutionGroups() && (ExecutionGroup < 0))
 	{
 		// use only for latent actions..
 		return;
 	}
 
-	// Run thru code looking only at things marked as jump targets, to make sure the jump targets are ordered in order of appearance in the linear execution list
-	// Emit code in the order specified by the linear execution list (the first node is always the entry point for the function)
-	for (int32 NodeIndex = 0; NodeIndex < FunctionContext.LinearExecutionList.Num(); ++NodeIndex)
-	{
-		UEdGraphNode* StatementNode = FunctionContext.LinearExecutionList[NodeIndex];
-		TArray<FBlueprintCompiledStatement*>* StatementList = FunctionContext.StatementsPerNode.Find(StatementNode);
-
-		if (StatementList != NULL)
-		{
-			for (int32 StatementIndex = 0; StatementIndex < StatementList->Num(); ++StatementIndex)
-			{
-				FBlueprintCompiledStatement& Statement = *((*StatementList)[StatementIndex]);
-
-				if (Statement.bIsJumpTarget)
-				{
-					// Just making sure we number them in order of appearance, so jump statements don't influence the order
-					const int32 StateNum = StatementToStateIndex(FunctionContext, &Statement);
-				}
-			}
-		}
-	}
-
 	bool bIsFunctionNotReducible = InnerFunctionImplementation(FunctionContext, EmitterContext, ExecutionGroup);
 	if (!bIsFunctionNotReducible)
 	{
@@ -995,7 +1062,7 @@ void FBlueprintCompilerCppBackendBase::GenerateCodeFromEnum(UUserDefinedEnum* So
 
 	Header.AddLine(FString::Printf(TEXT("FText %s__GetUserFriendlyName(int32 InValue);"), *EnumCppName));
 
-	OutHeaderCode = MoveTemp(Header.Result);
+	OutHeaderCode = Header.MoveToString();
 	
 	FCodeText Body;
 	
@@ -1049,7 +1116,7 @@ void FBlueprintCompilerCppBackendBase::GenerateCodeFromEnum(UUserDefinedEnum* So
 	Body.DecreaseIndent();
 	Body.AddLine(TEXT("};"));
 
-	OutCPPCode = MoveTemp(Body.Result);
+	OutCPPCode = Body.MoveToString();
 }
 
 void FBlueprintCompilerCppBackendBase::GenerateCodeFromStruct(UUserDefinedStruct* SourceStruct, const FCompilerNativizationOptions& NativizationOptions, FString& OutHeaderCode, FString& OutCPPCode)
@@ -1096,8 +1163,8 @@ void FBlueprintCompilerCppBackendBase::GenerateCodeFromStruct(UUserDefinedStruct
 	FEmitDefaultValueHelper::AddStaticFunctionsForDependencies(EmitterContext, nullptr, NativizationOptions);
 	FEmitDefaultValueHelper::AddRegisterHelper(EmitterContext);
 
-	OutCPPCode = MoveTemp(EmitterContext.Body.Result);
-	OutHeaderCode = MoveTemp(EmitterContext.Header.Result);
+	OutCPPCode = EmitterContext.Body.MoveToString();
+	OutHeaderCode = EmitterContext.Header.MoveToString();
 }
 
 FString FBlueprintCompilerCppBackendBase::GenerateWrapperForClass(UClass* SourceClass, const FCompilerNativizationOptions& NativizationOptions)
@@ -1380,7 +1447,7 @@ FString FBlueprintCompilerCppBackendBase::GenerateWrapperForClass(UClass* Source
 		EmitterContext.Header.DecreaseIndent();
 		EmitterContext.Header.AddLine(TEXT("};"));
 	}
-	return EmitterContext.Header.Result;
+	return EmitterContext.Header.MoveToString();
 }
 
 void FBlueprintCompilerCppBackendBase::EmitFileBeginning(const FString& CleanName, FEmitterLocalContext& EmitterContext, bool bIncludeGeneratedH, bool bIncludeCodeHelpersInHeader, bool bFullyIncludedDeclaration, UField* AdditionalFieldToIncludeInHeader)
@@ -1442,8 +1509,514 @@ void FBlueprintCompilerCppBackendBase::EmitFileBeginning(const FString& CleanNam
 
 void FBlueprintCompilerCppBackendBase::CleanBackend()
 {
-	StateMapPerFunction.Empty();
-	FunctionIndexMap.Empty();
+	FlatFunctions.Empty();
+	ExecutionGroupsPerFunction.Empty();
 	UberGraphContext = nullptr;
-	UberGraphStatementToExecutionGroup.Empty();
+	PromotedUberGraphVariables.Empty();
+	UberGraphLocalVariables.Empty();
+}
+
+/** Properties read by the statement, and (plain self variables) written after the reads */
+static void PropertiesReadAndWrittenByStatement(const FBlueprintCompiledStatement* Statement, TSet<const FProperty*>& OutReads, TSet<const FProperty*>& OutWrites)
+{
+	if (!Statement)
+	{
+		return;
+	}
+
+	auto AddReads = [&OutReads](const FBPTerminal* Term)
+	{
+		for (; Term; Term = Term->Context)
+		{
+			OutReads.Add(Term->AssociatedVarProperty);
+			// Inline statements don't write anything, that would be read later
+			PropertiesReadAndWrittenByStatement(Term->InlineGeneratedParameter, OutReads, OutReads);
+		}
+	};
+	auto IsPlainSelfVariable = [](const FBPTerminal* Term)
+	{
+		return Term && Term->AssociatedVarProperty && !Term->InlineGeneratedParameter && (!Term->Context || (Term->Context->Name == TEXT("self")));
+	};
+
+	int32 ParamIndex = 0;
+	if (Statement->FunctionToCall)
+	{
+		for (TFieldIterator<FProperty> PropIt(Statement->FunctionToCall); PropIt && (PropIt->PropertyFlags & CPF_Parm) && Statement->RHS.IsValidIndex(ParamIndex); ++PropIt)
+		{
+			if (PropIt->HasAnyPropertyFlags(CPF_ReturnParm))
+			{
+				continue;
+			}
+			const FBPTerminal* Term = Statement->RHS[ParamIndex++];
+			const bool bPureOutput = PropIt->HasAnyPropertyFlags(CPF_OutParm) && !PropIt->HasAnyPropertyFlags(CPF_ReferenceParm | CPF_ConstParm);
+			if (bPureOutput && IsPlainSelfVariable(Term))
+			{
+				OutWrites.Add(Term->AssociatedVarProperty);
+			}
+			else
+			{
+				AddReads(Term);
+			}
+		}
+	}
+	for (; ParamIndex < Statement->RHS.Num(); ++ParamIndex)
+	{
+		AddReads(Statement->RHS[ParamIndex]);
+	}
+
+	AddReads(Statement->FunctionContext);
+
+	bool bAssignsLHS = false;
+	switch (Statement->Type)
+	{
+	case KCST_Assignment:
+	case KCST_CallFunction:
+	case KCST_DynamicCast:
+	case KCST_ObjectToBool:
+	case KCST_MetaCast:
+	case KCST_CastObjToInterface:
+	case KCST_CastInterfaceToObj:
+	case KCST_CrossInterfaceCast:
+	case KCST_CreateArray:
+	case KCST_CreateSet:
+	case KCST_CreateMap:
+		bAssignsLHS = true;
+		break;
+	default:
+		break;
+	}
+	if (bAssignsLHS && IsPlainSelfVariable(Statement->LHS))
+	{
+		OutWrites.Add(Statement->LHS->AssociatedVarProperty);
+	}
+	else
+	{
+		AddReads(Statement->LHS);
+	}
+}
+
+void FBlueprintCompilerCppBackendBase::GatherPromotedUberGraphVariables(UClass* SourceClass, TIndirectArray<FKismetFunctionContext>& Functions)
+{
+	static const FBoolConfigValueHelper DontPromoteUberGraphVariables(TEXT("BlueprintNativizationSettings"), TEXT("bDontPromoteUberGraphVariables"));
+	// Anim graphs access the ubergraph variables by name
+	if (DontPromoteUberGraphVariables || !UberGraphContext || SourceClass->IsA<UAnimBlueprintGeneratedClass>())
+	{
+		return;
+	}
+
+	TArray<const FProperty*> Candidates;
+	TMap<const FProperty*, int32> CandidateIndices;
+	for (TFieldIterator<FProperty> It(SourceClass, EFieldIteratorFlags::ExcludeSuper); It; ++It)
+	{
+		if (It->HasAllPropertyFlags(CPF_Transient | CPF_DuplicateTransient) && !It->HasAnyPropertyFlags(CPF_Net))
+		{
+			CandidateIndices.Add(*It, Candidates.Add(*It));
+		}
+	}
+	if (!Candidates.Num())
+	{
+		return;
+	}
+	TBitArray<> Disqualified(false, Candidates.Num());
+	auto Disqualify = [&](const TSet<const FProperty*>& Properties)
+	{
+		for (const FProperty* Property : Properties)
+		{
+			if (const int32* CandidateIndex = CandidateIndices.Find(Property))
+			{
+				Disqualified[*CandidateIndex] = true;
+			}
+		}
+	};
+
+	const FFlatFunction& UberGraph = GetFlatFunction(*UberGraphContext);
+	const int32 NumStatements = UberGraph.Statements.Num();
+
+	// Entry points: events, latent continuations and the ubergraph calls made by other functions. Nothing is assigned there.
+	TBitArray<> EntryPoints(false, NumStatements + 1);
+	EntryPoints[0] = true;
+	for (int32 NodeIndex = 0; NodeIndex < UberGraph.NumNodes(); ++NodeIndex)
+	{
+		if (UberGraphContext->LinearExecutionList[NodeIndex]->IsA<UK2Node_Event>())
+		{
+			EntryPoints[UberGraph.NodeFirstStatement[NodeIndex]] = true;
+		}
+	}
+	for (FKismetFunctionContext& FunctionContext : Functions)
+	{
+		if (&FunctionContext == UberGraphContext)
+		{
+			continue;
+		}
+		// The variables must not be accessed by other functions (e.g. event parameters stored by the event stubs)
+		const FFlatFunction& OtherFunction = GetFlatFunction(FunctionContext);
+		for (const FBlueprintCompiledStatement* Statement : OtherFunction.Statements)
+		{
+			TSet<const FProperty*> Used;
+			PropertiesReadAndWrittenByStatement(Statement, Used, Used);
+			Disqualify(Used);
+			const int32 TargetIndex = (Statement && Statement->TargetLabel) ? UberGraph.FindStatement(Statement->TargetLabel) : INDEX_NONE;
+			if (TargetIndex != INDEX_NONE)
+			{
+				EntryPoints[TargetIndex] = true;
+			}
+		}
+	}
+
+	// Successors of each statement, following the execution flow stack conservatively: any pushed state may be popped.
+	TArray<TArray<int32, TInlineAllocator<2>>> Successors;
+	Successors.SetNum(NumStatements);
+	TArray<int32> PushedStates;
+	TBitArray<> PopsState(false, NumStatements);
+	for (int32 StatementIndex = 0; StatementIndex < NumStatements; ++StatementIndex)
+	{
+		const FBlueprintCompiledStatement* Statement = UberGraph.Statements[StatementIndex];
+		const EKismetCompiledStatementType Type = Statement ? Statement->Type : KCST_Nop;
+		const int32 TargetIndex = UberGraph.JumpTargets[StatementIndex];
+		const bool bJumps = (Type == KCST_UnconditionalGoto) || (Type == KCST_GotoIfNot) || (Type == KCST_PushState);
+		if (bJumps && (TargetIndex == INDEX_NONE))
+		{
+			return;
+		}
+		if (Type == KCST_CallFunction && (TargetIndex != INDEX_NONE))
+		{
+			EntryPoints[TargetIndex] = true;
+		}
+
+		TArray<int32, TInlineAllocator<2>>& StatementSuccessors = Successors[StatementIndex];
+		switch (Type)
+		{
+		case KCST_UnconditionalGoto:
+			StatementSuccessors.Add(TargetIndex);
+			break;
+		case KCST_GotoIfNot:
+			StatementSuccessors.Add(TargetIndex);
+			StatementSuccessors.Add(StatementIndex + 1);
+			break;
+		case KCST_PushState:
+			PushedStates.AddUnique(TargetIndex);
+			StatementSuccessors.Add(StatementIndex + 1);
+			break;
+		case KCST_EndOfThread:
+			PopsState[StatementIndex] = true;
+			break;
+		case KCST_EndOfThreadIfNot:
+			PopsState[StatementIndex] = true;
+			StatementSuccessors.Add(StatementIndex + 1);
+			break;
+		case KCST_Return:
+		case KCST_GotoReturn:
+		// The computed goto only jumps to the entry points
+		case KCST_ComputedGoto:
+			break;
+		default:
+			StatementSuccessors.Add(StatementIndex + 1);
+			break;
+		}
+	}
+	for (TConstSetBitIterator<> It(PopsState); It; ++It)
+	{
+		for (int32 PushedState : PushedStates)
+		{
+			Successors[It.GetIndex()].AddUnique(PushedState);
+		}
+	}
+
+	TArray<TSet<const FProperty*>> Reads, Writes;
+	Reads.SetNum(NumStatements);
+	Writes.SetNum(NumStatements);
+	for (int32 StatementIndex = 0; StatementIndex < NumStatements; ++StatementIndex)
+	{
+		const FBlueprintCompiledStatement* Statement = UberGraph.Statements[StatementIndex];
+		PropertiesReadAndWrittenByStatement(Statement, Reads[StatementIndex], Writes[StatementIndex]);
+
+		// A latent action keeps references to the arguments, it writes the outputs when it completes, after the event function returned.
+		const bool bLatentCall = Statement && (Statement->Type == KCST_CallFunction)
+			&& (Statement->TargetLabel || (Statement->FunctionToCall && Statement->FunctionToCall->HasMetaData(FBlueprintMetadata::MD_Latent)));
+		if (bLatentCall)
+		{
+			Disqualify(Reads[StatementIndex]);
+			Disqualify(Writes[StatementIndex]);
+		}
+	}
+
+	// Forward "definitely assigned" analysis. Unreachable statements keep the full set.
+	TArray<TBitArray<>> Assigned;
+	Assigned.Reserve(NumStatements + 1);
+	for (int32 StatementIndex = 0; StatementIndex <= NumStatements; ++StatementIndex)
+	{
+		Assigned.Add(TBitArray<>(!EntryPoints[StatementIndex], Candidates.Num()));
+	}
+	for (bool bChanged = true; bChanged;)
+	{
+		bChanged = false;
+		for (int32 StatementIndex = 0; StatementIndex < NumStatements; ++StatementIndex)
+		{
+			TBitArray<> AssignedAfter = Assigned[StatementIndex];
+			for (const FProperty* Written : Writes[StatementIndex])
+			{
+				if (const int32* CandidateIndex = CandidateIndices.Find(Written))
+				{
+					AssignedAfter[*CandidateIndex] = true;
+				}
+			}
+			for (int32 Successor : Successors[StatementIndex])
+			{
+				if (Assigned.IsValidIndex(Successor) && !EntryPoints[Successor])
+				{
+					const TBitArray<> Merged = TBitArray<>::BitwiseAND(Assigned[Successor], AssignedAfter, EBitwiseOperatorFlags::MaintainSize);
+					if (!(Merged == Assigned[Successor]))
+					{
+						Assigned[Successor] = Merged;
+						bChanged = true;
+					}
+				}
+			}
+		}
+	}
+
+	TSet<const FProperty*> UsedByUberGraph;
+	for (int32 StatementIndex = 0; StatementIndex < NumStatements; ++StatementIndex)
+	{
+		for (const FProperty* Read : Reads[StatementIndex])
+		{
+			const int32* CandidateIndex = CandidateIndices.Find(Read);
+			if (CandidateIndex && !Assigned[StatementIndex][*CandidateIndex])
+			{
+				Disqualified[*CandidateIndex] = true;
+			}
+		}
+		UsedByUberGraph.Append(Reads[StatementIndex]);
+		UsedByUberGraph.Append(Writes[StatementIndex]);
+	}
+
+	for (int32 CandidateIndex = 0; CandidateIndex < Candidates.Num(); ++CandidateIndex)
+	{
+		if (!Disqualified[CandidateIndex])
+		{
+			const FProperty* Property = Candidates[CandidateIndex];
+			PromotedUberGraphVariables.Add(Property);
+			if (UsedByUberGraph.Contains(Property))
+			{
+				UberGraphLocalVariables.Add(const_cast<FProperty*>(Property));
+			}
+		}
+	}
+}
+
+FBlueprintCompilerCppBackendBase::FFlatFunction::FFlatFunction(const FKismetFunctionContext& FunctionContext)
+	: StateCounter(0)
+{
+	NodeFirstStatement.Reserve(FunctionContext.LinearExecutionList.Num() + 1);
+	for (int32 NodeIndex = 0; NodeIndex < FunctionContext.LinearExecutionList.Num(); ++NodeIndex)
+	{
+		UEdGraphNode* Node = FunctionContext.LinearExecutionList[NodeIndex];
+		NodeIndices.Add(Node, NodeIndex);
+		NodeFirstStatement.Add(Statements.Num());
+		if (const TArray<FBlueprintCompiledStatement*>* StatementList = FunctionContext.StatementsPerNode.Find(Node))
+		{
+			for (FBlueprintCompiledStatement* Statement : *StatementList)
+			{
+				StatementIndices.Add(Statement, Statements.Add(Statement));
+				StatementNodes.Add(NodeIndex);
+			}
+		}
+	}
+	NodeFirstStatement.Add(Statements.Num());
+
+	JumpTargets.Init(INDEX_NONE, Statements.Num());
+	StateIndices.Init(0, Statements.Num());
+	for (int32 StatementIndex = 0; StatementIndex < Statements.Num(); ++StatementIndex)
+	{
+		const FBlueprintCompiledStatement* Statement = Statements[StatementIndex];
+		if (Statement && Statement->TargetLabel)
+		{
+			JumpTargets[StatementIndex] = FindStatement(Statement->TargetLabel);
+		}
+		if (Statement && Statement->bIsJumpTarget)
+		{
+			// numbered in order of appearance, so jump statements don't influence the order
+			StatementToStateIndex(StatementIndex);
+		}
+	}
+}
+
+FBlueprintCompilerCppBackendBase::FExecutionGroupInfo::FExecutionGroupInfo(FKismetFunctionContext& FunctionContext, const FFlatFunction& FlatFunction)
+	: ExecutionGroups(FKismetCompilerUtilities::FindUnsortedSeparateExecutionGroups(FunctionContext.LinearExecutionList))
+{
+	StatementToExecutionGroup.Init(INDEX_NONE, FlatFunction.Statements.Num());
+
+	static const FBoolConfigValueHelper DontSplitUbergraphPerEntryPoint(TEXT("BlueprintNativizationSettings"), TEXT("bDontSplitUbergraphPerEntryPoint"));
+	if (FunctionContext.bIsUbergraph && !DontSplitUbergraphPerEntryPoint)
+	{
+		SplitPerEntryPoint(FunctionContext, FlatFunction);
+	}
+
+	ExecutionGroupNodes.SetNum(ExecutionGroups.Num());
+	for (int32 ExecutionGroupIndex = 0; ExecutionGroupIndex < ExecutionGroups.Num(); ++ExecutionGroupIndex)
+	{
+		TBitArray<>& GroupNodes = ExecutionGroupNodes[ExecutionGroupIndex];
+		GroupNodes.Init(false, FlatFunction.NumNodes());
+		for (UEdGraphNode* Node : ExecutionGroups[ExecutionGroupIndex])
+		{
+			const int32 NodeIndex = FlatFunction.FindNode(Node);
+			if (ensure(NodeIndex != INDEX_NONE))
+			{
+				GroupNodes[NodeIndex] = true;
+			}
+		}
+	}
+
+	// Statements are mapped to the first group, in the order of the linear execution list
+	for (int32 StatementIndex = 0; StatementIndex < FlatFunction.Statements.Num(); ++StatementIndex)
+	{
+		if (StatementToExecutionGroup[StatementIndex] != INDEX_NONE)
+		{
+			continue;
+		}
+		for (int32 ExecutionGroupIndex = 0; ExecutionGroupIndex < ExecutionGroupNodes.Num(); ++ExecutionGroupIndex)
+		{
+			if (ExecutionGroupNodes[ExecutionGroupIndex][FlatFunction.StatementNodes[StatementIndex]])
+			{
+				StatementToExecutionGroup[StatementIndex] = ExecutionGroupIndex;
+				break;
+			}
+		}
+	}
+}
+
+void FBlueprintCompilerCppBackendBase::FExecutionGroupInfo::SplitPerEntryPoint(FKismetFunctionContext& FunctionContext, const FFlatFunction& FlatFunction)
+{
+	const TArray<FBlueprintCompiledStatement*>& Statements = FlatFunction.Statements;
+
+	// Returns false when the region cannot be determined (the jump target is unknown or outside the group)
+	auto GatherReachableNodes = [&](int32 EntryPoint, const TSet<UEdGraphNode*>& ExecutionGroup, TSet<UEdGraphNode*>& OutRegion) -> bool
+	{
+		TBitArray<> Visited(false, Statements.Num());
+		TArray<int32> ToVisit;
+		ToVisit.Add(EntryPoint);
+		while (ToVisit.Num())
+		{
+			const int32 Index = ToVisit.Pop(EAllowShrinking::No);
+			if (!Statements.IsValidIndex(Index) || Visited[Index])
+			{
+				continue;
+			}
+			Visited[Index] = true;
+
+			UEdGraphNode* Owner = FunctionContext.LinearExecutionList[FlatFunction.StatementNodes[Index]];
+			if (!ExecutionGroup.Contains(Owner))
+			{
+				return false;
+			}
+			OutRegion.Add(Owner);
+
+			const FBlueprintCompiledStatement& Statement = *Statements[Index];
+			const bool bJumps = (Statement.Type == KCST_UnconditionalGoto) || (Statement.Type == KCST_GotoIfNot) || (Statement.Type == KCST_PushState);
+			if (bJumps)
+			{
+				const int32 TargetIndex = FlatFunction.JumpTargets[Index];
+				if (TargetIndex == INDEX_NONE)
+				{
+					return false;
+				}
+				ToVisit.Add(TargetIndex);
+			}
+
+			switch (Statement.Type)
+			{
+			case KCST_ComputedGoto:
+				return false;
+			case KCST_UnconditionalGoto:
+			case KCST_GotoReturn:
+			case KCST_EndOfThread:
+				break;
+			default:
+				ToVisit.Add(Index + 1);
+				break;
+			}
+		}
+		return true;
+	};
+
+	TArray<TSet<UEdGraphNode*>> SplitExecutionGroups;
+	for (TSet<UEdGraphNode*>& ExecutionGroup : ExecutionGroups)
+	{
+		// Events are called by their stubs, latent continuations by the latent action manager
+		TArray<int32> EntryPoints;
+		TSet<int32> LatentEntryPoints;
+		for (int32 NodeIndex = 0; NodeIndex < FlatFunction.NumNodes(); ++NodeIndex)
+		{
+			UEdGraphNode* Node = FunctionContext.LinearExecutionList[NodeIndex];
+			const TArrayView<FBlueprintCompiledStatement* const> StatementList = ExecutionGroup.Contains(Node) ? FlatFunction.GetNodeStatements(NodeIndex) : TArrayView<FBlueprintCompiledStatement* const>();
+			if (!StatementList.Num())
+			{
+				continue;
+			}
+			if (Node->IsA<UK2Node_Event>())
+			{
+				EntryPoints.AddUnique(FlatFunction.NodeFirstStatement[NodeIndex]);
+			}
+			for (int32 StatementIndex = FlatFunction.NodeFirstStatement[NodeIndex]; StatementIndex < FlatFunction.NodeFirstStatement[NodeIndex + 1]; ++StatementIndex)
+			{
+				const FBlueprintCompiledStatement* Statement = Statements[StatementIndex];
+				const int32 TargetIndex = FlatFunction.JumpTargets[StatementIndex];
+				if (Statement && (Statement->Type == KCST_CallFunction) && (TargetIndex != INDEX_NONE))
+				{
+					EntryPoints.AddUnique(TargetIndex);
+					LatentEntryPoints.Add(TargetIndex);
+				}
+			}
+		}
+
+		TArray<TSet<UEdGraphNode*>> Regions;
+		Regions.SetNum(EntryPoints.Num());
+		bool bCanSplit = EntryPoints.Num() > 1;
+		for (int32 EntryIndex = 0; bCanSplit && (EntryIndex < EntryPoints.Num()); ++EntryIndex)
+		{
+			bCanSplit = GatherReachableNodes(EntryPoints[EntryIndex], ExecutionGroup, Regions[EntryIndex]);
+		}
+
+		if (!bCanSplit)
+		{
+			SplitExecutionGroups.Add(MoveTemp(ExecutionGroup));
+			continue;
+		}
+
+		for (int32 EntryIndex = 0; EntryIndex < EntryPoints.Num(); ++EntryIndex)
+		{
+			const int32 RegionIndex = SplitExecutionGroups.Add(MoveTemp(Regions[EntryIndex]));
+			StatementToExecutionGroup[EntryPoints[EntryIndex]] = RegionIndex;
+			if (LatentEntryPoints.Contains(EntryPoints[EntryIndex]))
+			{
+				LatentResumeGroups.Add(RegionIndex);
+			}
+		}
+	}
+	ExecutionGroups = MoveTemp(SplitExecutionGroups);
+}
+
+FBlueprintCompilerCppBackendBase::FFlatFunction& FBlueprintCompilerCppBackendBase::GetFlatFunction(FKismetFunctionContext& FunctionContext)
+{
+	TUniquePtr<FFlatFunction>& FlatFunction = FlatFunctions.FindOrAdd(&FunctionContext);
+	if (!FlatFunction.IsValid())
+	{
+		FlatFunction = MakeUnique<FFlatFunction>(FunctionContext);
+	}
+	return *FlatFunction;
+}
+
+const FBlueprintCompilerCppBackendBase::FExecutionGroupInfo& FBlueprintCompilerCppBackendBase::GetExecutionGroupInfo(FKismetFunctionContext& FunctionContext)
+{
+	TUniquePtr<FExecutionGroupInfo>& ExecutionGroupInfo = ExecutionGroupsPerFunction.FindOrAdd(&FunctionContext);
+	if (!ExecutionGroupInfo.IsValid())
+	{
+		ExecutionGroupInfo = MakeUnique<FExecutionGroupInfo>(FunctionContext, GetFlatFunction(FunctionContext));
+	}
+	return *ExecutionGroupInfo;
+}
+
+int32 FBlueprintCompilerCppBackendBase::FindUberGraphExecutionGroup(const FBlueprintCompiledStatement* Statement)
+{
+	return UberGraphContext ? GetExecutionGroupInfo(*UberGraphContext).FindExecutionGroup(GetFlatFunction(*UberGraphContext).FindStatement(Statement)) : INDEX_NONE;
 }
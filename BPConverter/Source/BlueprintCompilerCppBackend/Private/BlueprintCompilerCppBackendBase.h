@@ -14,32 +14,148 @@ struct FEmitterLocalContext;
 class FBlueprintCompilerCppBackendBase : public IBlueprintCompilerCppBackend
 {
 protected:
-	struct FFunctionLabelInfo
+	/**
+	 * Statements of a function lowered into contiguous arrays, so the emitter passes iterate them linearly
+	 * instead of looking up FKismetFunctionContext::StatementsPerNode for every node. Computed once per function,
+	 * the function context must not be modified afterwards.
+	 * Nodes are referred to by their index in the LinearExecutionList, statements by their index in Statements.
+	 */
+	struct FFlatFunction
 	{
-		TMap<FBlueprintCompiledStatement*, int32> StateMap;
+		/** All statements, in the order of the linear execution list */
+		TArray<FBlueprintCompiledStatement*> Statements;
+		/** Node owning each statement */
+		TArray<int32> StatementNodes;
+		/** Jump target of each statement, INDEX_NONE when the statement has no target label in this function */
+		TArray<int32> JumpTargets;
+		/** State (the case label in the switch) of each statement, 0 when it has none. Jump targets are numbered up front in order of appearance. */
+		TArray<int32> StateIndices;
+		/** Statements of the node N are [NodeFirstStatement[N], NodeFirstStatement[N + 1]) */
+		TArray<int32> NodeFirstStatement;
 		int32 StateCounter;
 
-		FFunctionLabelInfo()
+		explicit FFlatFunction(const FKismetFunctionContext& FunctionContext);
+
+		int32 NumNodes() const
+		{
+			return NodeFirstStatement.Num() - 1;
+		}
+
+		TArrayView<FBlueprintCompiledStatement* const> GetNodeStatements(int32 NodeIndex) const
+		{
+			const int32 First = NodeFirstStatement[NodeIndex];
+			return MakeArrayView(Statements.GetData() + First, NodeFirstStatement[NodeIndex + 1] - First);
+		}
+
+		/** Empty for nodes outside of the linear execution list */
+		TArrayView<FBlueprintCompiledStatement* const> GetNodeStatements(const UEdGraphNode* Node) const
+		{
+			const int32 NodeIndex = FindNode(Node);
+			return (NodeIndex != INDEX_NONE) ? GetNodeStatements(NodeIndex) : TArrayView<FBlueprintCompiledStatement* const>();
+		}
+
+		/** Returns INDEX_NONE, when the node is not in the linear execution list */
+		int32 FindNode(const UEdGraphNode* Node) const
+		{
+			const int32* NodeIndexPtr = NodeIndices.Find(Node);
+			return NodeIndexPtr ? *NodeIndexPtr : INDEX_NONE;
+		}
+
+		/** Returns INDEX_NONE, when the statement doesn't belong to the function */
+		int32 FindStatement(const FBlueprintCompiledStatement* Statement) const
 		{
-			StateCounter = 0;
+			const int32* StatementIndexPtr = StatementIndices.Find(Statement);
+			return StatementIndexPtr ? *StatementIndexPtr : INDEX_NONE;
 		}
 
-		int32 StatementToStateIndex(FBlueprintCompiledStatement* Statement)
+		int32 StatementToStateIndex(int32 StatementIndex)
 		{
-			int32& Index = StateMap.FindOrAdd(Statement);
+			int32& Index = StateIndices[StatementIndex];
 			if (Index == 0)
 			{
 				Index = ++StateCounter;
 			}
-
 			return Index;
 		}
+
+		int32 StatementToStateIndex(const FBlueprintCompiledStatement* Statement)
+		{
+			const int32 StatementIndex = FindStatement(Statement);
+			return ensure(StatementIndex != INDEX_NONE) ? StatementToStateIndex(StatementIndex) : 0;
+		}
+
+	private:
+		// Used only to translate pointers coming from statements (target labels) and graphs
+		TMap<const UEdGraphNode*, int32> NodeIndices;
+		TMap<const FBlueprintCompiledStatement*, int32> StatementIndices;
+	};
+
+	/**
+	 * Execution groups of a function (see FKismetCompilerUtilities::FindUnsortedSeparateExecutionGroups). Computed once per function and shared by all emitter passes.
+	 * In the ubergraph a group with many entry points (events and latent continuations) is split into one group per entry point, holding the nodes reachable from it.
+	 * Such groups may share nodes.
+	 */
+	struct FExecutionGroupInfo
+	{
+		TArray<TSet<UEdGraphNode*>> ExecutionGroups;
+		/** Nodes (indices in the linear execution list) of each group */
+		TArray<TBitArray<>> ExecutionGroupNodes;
+		/** Entry points are mapped to their own group. Other statements are mapped to the first group containing them, INDEX_NONE when there's none. */
+		TArray<int32> StatementToExecutionGroup;
+		/** Groups entered by the latent action manager. They must be UFUNCTIONs. */
+		TSet<int32> LatentResumeGroups;
+
+		FExecutionGroupInfo(FKismetFunctionContext& FunctionContext, const FFlatFunction& FlatFunction);
+
+		bool HasExecutionGroups() const
+		{
+			return ExecutionGroups.Num() > 0;
+		}
+
+		int32 Num() const
+		{
+			return ExecutionGroups.Num();
+		}
+
+		const TSet<UEdGraphNode*>& GetNodes(int32 ExecutionGroup) const
+		{
+			return ExecutionGroups[ExecutionGroup];
+		}
+
+		/** Returns INDEX_NONE, when the statement doesn't belong to any group */
+		int32 FindExecutionGroup(int32 StatementIndex) const
+		{
+			return StatementToExecutionGroup.IsValidIndex(StatementIndex) ? StatementToExecutionGroup[StatementIndex] : INDEX_NONE;
+		}
+
+		bool IsInExecutionGroup(UEdGraphNode* Node, int32 ExecutionGroup) const
+		{
+			return ExecutionGroups.IsValidIndex(ExecutionGroup) && ExecutionGroups[ExecutionGroup].Contains(Node);
+		}
+
+		bool IsInExecutionGroup(int32 NodeIndex, int32 ExecutionGroup) const
+		{
+			return ExecutionGroupNodes.IsValidIndex(ExecutionGroup) && ExecutionGroupNodes[ExecutionGroup].IsValidIndex(NodeIndex) && ExecutionGroupNodes[ExecutionGroup][NodeIndex];
+		}
+
+		bool IsLatentResumeGroup(int32 ExecutionGroup) const
+		{
+			return LatentResumeGroups.Contains(ExecutionGroup);
+		}
+
+	private:
+		/** Replaces groups having many entry points with a group per entry point */
+		void SplitPerEntryPoint(FKismetFunctionContext& FunctionContext, const FFlatFunction& FlatFunction);
 	};
 
-	TArray<FFunctionLabelInfo> StateMapPerFunction;
-	TMap<FKismetFunctionContext*, int32> FunctionIndexMap;
+	TMap<const FKismetFunctionContext*, TUniquePtr<FFlatFunction>> FlatFunctions;
+	TMap<const FKismetFunctionContext*, TUniquePtr<FExecutionGroupInfo>> ExecutionGroupsPerFunction;
 	FKismetFunctionContext* UberGraphContext;
-	TMap<FBlueprintCompiledStatement*, int32> UberGraphStatementToExecutionGroup;
+
+	/** Ubergraph (persistent frame) variables that are never read before being written in the same call. They are not emitted as members. */
+	TSet<const FProperty*> PromotedUberGraphVariables;
+	/** Promoted variables used by the ubergraph, declared as locals of its functions */
+	TArray<FProperty*> UberGraphLocalVariables;
 public:
 
 	// IBlueprintCompilerCppBackend implementation
@@ -70,17 +186,34 @@ protected:
 	*/
 	virtual bool InnerFunctionImplementation(FKismetFunctionContext& FunctionContext, FEmitterLocalContext& EmitterContext, int32 ExecutionGroup) = 0;
 	
-	int32 StatementToStateIndex(FKismetFunctionContext& FunctionContext, FBlueprintCompiledStatement* Statement)
+	int32 StatementToStateIndex(FKismetFunctionContext& FunctionContext, const FBlueprintCompiledStatement* Statement)
 	{
-		int32 Index = FunctionIndexMap.FindChecked(&FunctionContext);
-		return StateMapPerFunction[Index].StatementToStateIndex(Statement);
+		return GetFlatFunction(FunctionContext).StatementToStateIndex(Statement);
 	}
 
+	/** State of a statement of the ubergraph, used when it's entered from other functions or by latent actions */
+	int32 UberGraphStatementToStateIndex(const FBlueprintCompiledStatement* Statement)
+	{
+		return ensure(UberGraphContext) ? StatementToStateIndex(*UberGraphContext, Statement) : 0;
+	}
+
+	/** The flat statements are lowered on first use, the function context must not be modified afterwards */
+	FFlatFunction& GetFlatFunction(FKismetFunctionContext& FunctionContext);
+
+	/** The execution groups are computed on first use, the function context must not be modified afterwards */
+	const FExecutionGroupInfo& GetExecutionGroupInfo(FKismetFunctionContext& FunctionContext);
+
+	/** Finds the ubergraph variables, that can be emitted as locals, see PromotedUberGraphVariables */
+	void GatherPromotedUberGraphVariables(UClass* SourceClass, TIndirectArray<FKismetFunctionContext>& Functions);
+
+	/** Execution group (of the ubergraph) containing the statement, or INDEX_NONE */
+	int32 FindUberGraphExecutionGroup(const FBlueprintCompiledStatement* Statement);
+
 private:
 	/** Builds both the header declaration and body implementation of a function */
 	void ConstructFunction(FKismetFunctionContext& FunctionContext, FEmitterLocalContext& EmitterContext, bool bGenerateStubOnly);
 
-	static TArray<FString> ConstructFunctionDeclaration(FEmitterLocalContext &EmitterContext, FKismetFunctionContext &FunctionContext, TArray<FProperty*> &ArgumentList);
+	static TArray<FString> ConstructFunctionDeclaration(FEmitterLocalContext &EmitterContext, FKismetFunctionContext &FunctionContext, const FExecutionGroupInfo& ExecutionGroupInfo, TArray<FProperty*> &ArgumentList);
 
 	static FString GenerateArgList(const FEmitterLocalContext &EmitterContext, const TArray<FProperty*> &ArgumentList, bool bOnlyParamName = false);
 
@@ -92,7 +225,7 @@ private:
 
 	static void EmitFileBeginning(const FString& CleanName, FEmitterLocalContext& EmitterContext, bool bIncludeGeneratedH = true, bool bIncludeCodeHelpersInHeader = false, bool bFullyIncludedDeclaration = false, UField* AdditionalFieldToIncludeInHeader = nullptr);
 
-	static void EmitStructProperties(FEmitterLocalContext& EmitterContext, UStruct* SourceClass);
+	static void EmitStructProperties(FEmitterLocalContext& EmitterContext, UStruct* SourceClass, const TSet<const FProperty*>* PropertiesToSkip = nullptr);
 
 	static void DeclareDelegates(FEmitterLocalContext& EmitterContext, TIndirectArray<FKismetFunctionContext>& Functions);
 };
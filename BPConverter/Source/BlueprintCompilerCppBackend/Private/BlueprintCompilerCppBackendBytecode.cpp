@@ -0,0 +1,655 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "BlueprintCompilerCppBackendBytecode.h"
+#include "UObject/Script.h"
+#include "UObject/UnrealType.h"
+#include "Misc/ConfigCacheIni.h"
+#include "Engine/Blueprint.h"
+#include "Engine/BlueprintGeneratedClass.h"
+#include "EdGraph/EdGraph.h"
+#include "EdGraphSchema_K2.h"
+#include "K2Node_FunctionEntry.h"
+#include "KismetCompiledFunctionContext.h"
+#include "BlueprintCompiledStatement.h"
+#include "IBlueprintCompilerCppBackendModule.h"
+
+namespace BlueprintBytecodeTranslatorImpl
+{
+	/** Reads the bytecode of a single function, appending the statements to its context. */
+	class FScriptReader
+	{
+	public:
+		FScriptReader(UClass& InSourceClass, UFunction& InFunction, FKismetFunctionContext& InFunctionContext, UEdGraphNode& InStatementOwner)
+			: SourceClass(InSourceClass)
+			, Function(InFunction)
+			, FunctionContext(InFunctionContext)
+			, StatementOwner(InStatementOwner)
+			, Script(InFunction.Script)
+			, Schema(GetDefault<UEdGraphSchema_K2>())
+		{}
+
+		/** Returns false when the function uses bytecode that is not supported, see GetError(). */
+		bool ReadFunction();
+
+		const FString& GetError() const { return Error; }
+
+	private:
+		struct FPendingJump
+		{
+			FBlueprintCompiledStatement* Statement;
+			CodeSkipSizeType TargetOffset;
+		};
+
+		bool SetError(const FString& InError)
+		{
+			if (Error.IsEmpty())
+			{
+				Error = InError;
+			}
+			return false;
+		}
+
+		template<typename T>
+		T Read()
+		{
+			T Value{};
+			if (Offset + (int32)sizeof(T) > Script.Num())
+			{
+				SetError(TEXT("unexpected end of the bytecode"));
+				return Value;
+			}
+			FMemory::Memcpy(&Value, &Script[Offset], sizeof(T));
+			Offset += sizeof(T);
+			return Value;
+		}
+
+		template<typename T>
+		T* ReadPointer()
+		{
+			return (T*)(UPTRINT)Read<ScriptPointerType>();
+		}
+
+		EExprToken ReadToken()
+		{
+			return (EExprToken)Read<uint8>();
+		}
+
+		EExprToken PeekToken() const
+		{
+			return Script.IsValidIndex(Offset) ? (EExprToken)Script[Offset] : EX_EndOfScript;
+		}
+
+		FName ReadName()
+		{
+			return ScriptNameToName(Read<FScriptName>());
+		}
+
+		FString ReadAnsiString();
+		FString ReadUnicodeString();
+
+		bool ReadStatement();
+		FBPTerminal* ReadTerm();
+		FBlueprintCompiledStatement* ReadCall(EExprToken Token, FBPTerminal* ContextTerm);
+
+		FBlueprintCompiledStatement& AppendStatement(EKismetCompiledStatementType Type);
+		FBPTerminal* NewLiteral(const FName Category, const FString& Value, UObject* SubCategoryObject = nullptr);
+		FBPTerminal* NewVariable(FProperty* Property, bool bLocal);
+		FBPTerminal* GetSelfTerm();
+
+		static bool IsSelf(const FBPTerminal* Term)
+		{
+			return Term && Term->bIsLiteral && (Term->Type.PinSubCategory == UEdGraphSchema_K2::PSC_Self);
+		}
+
+		UClass& SourceClass;
+		UFunction& Function;
+		FKismetFunctionContext& FunctionContext;
+		UEdGraphNode& StatementOwner;
+		const TArray<uint8>& Script;
+		const UEdGraphSchema_K2* Schema;
+
+		int32 Offset = 0;
+		FBPTerminal* SelfTerm = nullptr;
+
+		// Code offsets of the statements read since the last appended statement, they are all mapped to the next one.
+		TArray<int32> UnmappedOffsets;
+		TMap<int32, FBlueprintCompiledStatement*> OffsetToStatement;
+		// Offsets of the final return, jumps to them become KCST_GotoReturn.
+		TSet<int32> ReturnOffsets;
+		TArray<FPendingJump> PendingJumps;
+
+		FString Error;
+	};
+}
+
+//------------------------------------------------------------------------------
+FString BlueprintBytecodeTranslatorImpl::FScriptReader::ReadAnsiString()
+{
+	FString Result;
+	for (ANSICHAR Char = (ANSICHAR)Read<uint8>(); Char && Error.IsEmpty(); Char = (ANSICHAR)Read<uint8>())
+	{
+		Result.AppendChar(CharCast<TCHAR>(Char));
+	}
+	return Result;
+}
+
+//------------------------------------------------------------------------------
+FString BlueprintBytecodeTranslatorImpl::FScriptReader::ReadUnicodeString()
+{
+	FString Result;
+	for (uint16 Char = Read<uint16>(); Char && Error.IsEmpty(); Char = Read<uint16>())
+	{
+		Result.AppendChar((TCHAR)Char);
+	}
+	return Result;
+}
+
+//------------------------------------------------------------------------------
+FBlueprintCompiledStatement& BlueprintBytecodeTranslatorImpl::FScriptReader::AppendStatement(EKismetCompiledStatementType Type)
+{
+	FBlueprintCompiledStatement& Statement = FunctionContext.AppendStatementForNode(&StatementOwner);
+	Statement.Type = Type;
+	for (const int32 UnmappedOffset : UnmappedOffsets)
+	{
+		OffsetToStatement.Add(UnmappedOffset, &Statement);
+	}
+	UnmappedOffsets.Reset();
+	return Statement;
+}
+
+//------------------------------------------------------------------------------
+FBPTerminal* BlueprintBytecodeTranslatorImpl::FScriptReader::NewLiteral(const FName Category, const FString& Value, UObject* SubCategoryObject)
+{
+	FBPTerminal* Term = new FBPTerminal();
+	FunctionContext.Literals.Add(Term);
+	Term->bIsLiteral = true;
+	Term->Name = Value;
+	Term->Type.PinCategory = Category;
+	Term->Type.PinSubCategoryObject = SubCategoryObject;
+	return Term;
+}
+
+//------------------------------------------------------------------------------
+FBPTerminal* BlueprintBytecodeTranslatorImpl::FScriptReader::NewVariable(FProperty* Property, bool bLocal)
+{
+	if (!Property)
+	{
+		SetError(TEXT("missing property"));
+		return nullptr;
+	}
+	FBPTerminal* Term = new FBPTerminal();
+	FunctionContext.VariableReferences.Add(Term);
+	Term->Name = Property->GetName();
+	Term->AssociatedVarProperty = Property;
+	Term->SetVarTypeLocal(bLocal);
+	Schema->ConvertPropertyToPinType(Property, Term->Type);
+	return Term;
+}
+
+//------------------------------------------------------------------------------
+FBPTerminal* BlueprintBytecodeTranslatorImpl::FScriptReader::GetSelfTerm()
+{
+	if (!SelfTerm)
+	{
+		SelfTerm = NewLiteral(UEdGraphSchema_K2::PC_Object, UEdGraphSchema_K2::PSC_Self.ToString());
+		SelfTerm->Type.PinSubCategory = UEdGraphSchema_K2::PSC_Self;
+	}
+	return SelfTerm;
+}
+
+//------------------------------------------------------------------------------
+FBlueprintCompiledStatement* BlueprintBytecodeTranslatorImpl::FScriptReader::ReadCall(EExprToken Token, FBPTerminal* ContextTerm)
+{
+	UFunction* FunctionToCall = nullptr;
+	switch (Token)
+	{
+	case EX_FinalFunction:
+	case EX_LocalFinalFunction:
+	case EX_CallMath:
+		FunctionToCall = ReadPointer<UFunction>();
+		break;
+	case EX_VirtualFunction:
+	case EX_LocalVirtualFunction:
+	{
+		const FName FunctionName = ReadName();
+		UClass* ContextClass = (!ContextTerm || IsSelf(ContextTerm)) ? &SourceClass : Cast<UClass>(ContextTerm->Type.PinSubCategoryObject.Get());
+		FunctionToCall = ContextClass ? ContextClass->FindFunctionByName(FunctionName) : nullptr;
+		break;
+	}
+	default:
+		break;
+	}
+
+	if (!FunctionToCall)
+	{
+		SetError(FString::Printf(TEXT("cannot resolve the function called at offset %d"), Offset));
+		return nullptr;
+	}
+	if (FunctionToCall->HasAnyFunctionFlags(FUNC_Delegate) || FunctionToCall->HasMetaData(FBlueprintMetadata::MD_Latent))
+	{
+		SetError(FString::Printf(TEXT("unsupported call of %s"), *FunctionToCall->GetName()));
+		return nullptr;
+	}
+
+	FBlueprintCompiledStatement* Statement = new FBlueprintCompiledStatement();
+	FunctionContext.AllGeneratedStatements.Add(Statement);
+	Statement->Type = KCST_CallFunction;
+	Statement->FunctionToCall = FunctionToCall;
+	// static functions are called on their class, there is no object to call them on
+	Statement->FunctionContext = (IsSelf(ContextTerm) || FunctionToCall->HasAnyFunctionFlags(FUNC_Static)) ? nullptr : ContextTerm;
+
+	// A non virtual call of a function, that this class overrides, is a call of the parent implementation
+	const bool bFinalCall = (Token == EX_FinalFunction) || (Token == EX_LocalFinalFunction);
+	if (bFinalCall && !Statement->FunctionContext && !FunctionToCall->HasAnyFunctionFlags(FUNC_Static | FUNC_Final))
+	{
+		Statement->bIsParentContext = (SourceClass.FindFunctionByName(FunctionToCall->GetFName()) != FunctionToCall);
+	}
+
+	for (TFieldIterator<FProperty> It(FunctionToCall); It && It->HasAnyPropertyFlags(CPF_Parm); ++It)
+	{
+		if (It->HasAnyPropertyFlags(CPF_ReturnParm))
+		{
+			continue;
+		}
+		FBPTerminal* ParamTerm = ReadTerm();
+		if (!ParamTerm)
+		{
+			return nullptr;
+		}
+		Statement->RHS.Add(ParamTerm);
+	}
+
+	if (ReadToken() != EX_EndFunctionParms)
+	{
+		SetError(FString::Printf(TEXT("unexpected parameters of %s"), *FunctionToCall->GetName()));
+		return nullptr;
+	}
+	return Statement;
+}
+
+//------------------------------------------------------------------------------
+FBPTerminal* BlueprintBytecodeTranslatorImpl::FScriptReader::ReadTerm()
+{
+	const int32 TokenOffset = Offset;
+	const EExprToken Token = ReadToken();
+	switch (Token)
+	{
+	case EX_LocalVariable:
+	case EX_LocalOutVariable:
+		return NewVariable(ReadPointer<FProperty>(), true);
+	case EX_InstanceVariable:
+		return NewVariable(ReadPointer<FProperty>(), false);
+	case EX_Self:
+		return GetSelfTerm();
+	case EX_IntConst:
+		return NewLiteral(UEdGraphSchema_K2::PC_Int, FString::FromInt(Read<int32>()));
+	case EX_Int64Const:
+		return NewLiteral(UEdGraphSchema_K2::PC_Int64, LexToString(Read<int64>()));
+	case EX_IntZero:
+		return NewLiteral(UEdGraphSchema_K2::PC_Int, TEXT("0"));
+	case EX_IntOne:
+		return NewLiteral(UEdGraphSchema_K2::PC_Int, TEXT("1"));
+	case EX_ByteConst:
+		return NewLiteral(UEdGraphSchema_K2::PC_Byte, FString::FromInt(Read<uint8>()));
+	case EX_IntConstByte:
+		// an int32 constant, stored in a single byte
+		return NewLiteral(UEdGraphSchema_K2::PC_Int, FString::FromInt(Read<uint8>()));
+	case EX_FloatConst:
+	{
+		FBPTerminal* Term = NewLiteral(UEdGraphSchema_K2::PC_Real, LexToSanitizedString(Read<float>()));
+		Term->Type.PinSubCategory = UEdGraphSchema_K2::PC_Float;
+		return Term;
+	}
+	case EX_DoubleConst:
+	{
+		FBPTerminal* Term = NewLiteral(UEdGraphSchema_K2::PC_Real, LexToSanitizedString(Read<double>()));
+		Term->Type.PinSubCategory = UEdGraphSchema_K2::PC_Double;
+		return Term;
+	}
+	case EX_True:
+		return NewLiteral(UEdGraphSchema_K2::PC_Boolean, TEXT("true"));
+	case EX_False:
+		return NewLiteral(UEdGraphSchema_K2::PC_Boolean, TEXT("false"));
+	case EX_NameConst:
+		return NewLiteral(UEdGraphSchema_K2::PC_Name, ReadName().ToString());
+	case EX_StringConst:
+		return NewLiteral(UEdGraphSchema_K2::PC_String, ReadAnsiString());
+	case EX_UnicodeStringConst:
+		return NewLiteral(UEdGraphSchema_K2::PC_String, ReadUnicodeString());
+	case EX_NoObject:
+		return NewLiteral(UEdGraphSchema_K2::PC_Object, FString(), UObject::StaticClass());
+	case EX_ObjectConst:
+	{
+		UObject* Object = ReadPointer<UObject>();
+		UClass* AsClass = Cast<UClass>(Object);
+		FBPTerminal* Term = AsClass
+			? NewLiteral(UEdGraphSchema_K2::PC_Class, FString(), UObject::StaticClass())
+			: NewLiteral(UEdGraphSchema_K2::PC_Object, FString(), Object ? Object->GetClass() : UObject::StaticClass());
+		Term->ObjectLiteral = Object;
+		return Term;
+	}
+	case EX_StructMemberContext:
+	{
+		FProperty* MemberProperty = ReadPointer<FProperty>();
+		FBPTerminal* StructTerm = ReadTerm();
+		FBPTerminal* MemberTerm = StructTerm ? NewVariable(MemberProperty, false) : nullptr;
+		if (MemberTerm)
+		{
+			StructTerm->SetContextTypeStruct(true);
+			MemberTerm->Context = StructTerm;
+		}
+		return MemberTerm;
+	}
+	case EX_Context:
+	case EX_Context_FailSilent:
+	{
+		FBPTerminal* ObjectTerm = ReadTerm();
+		Read<CodeSkipSizeType>();
+		ReadPointer<FProperty>();
+		if (!ObjectTerm)
+		{
+			return nullptr;
+		}
+
+		const EExprToken InnerToken = PeekToken();
+		const bool bIsCall = (InnerToken == EX_FinalFunction) || (InnerToken == EX_VirtualFunction) || (InnerToken == EX_CallMath);
+		if (bIsCall)
+		{
+			ReadToken();
+			FBlueprintCompiledStatement* Call = ReadCall(InnerToken, ObjectTerm);
+			if (!Call)
+			{
+				return nullptr;
+			}
+			FBPTerminal* Term = new FBPTerminal();
+			FunctionContext.VariableReferences.Add(Term);
+			Term->InlineGeneratedParameter = Call;
+			if (FProperty* ReturnProperty = Call->FunctionToCall->GetReturnProperty())
+			{
+				Schema->ConvertPropertyToPinType(ReturnProperty, Term->Type);
+			}
+			return Term;
+		}
+
+		FBPTerminal* MemberTerm = ReadTerm();
+		if (!MemberTerm || !MemberTerm->AssociatedVarProperty || MemberTerm->Context || MemberTerm->IsLocalVarTerm())
+		{
+			SetError(FString::Printf(TEXT("unsupported context expression at offset %d"), TokenOffset));
+			return nullptr;
+		}
+		MemberTerm->Context = IsSelf(ObjectTerm) ? nullptr : ObjectTerm;
+		return MemberTerm;
+	}
+	case EX_FinalFunction:
+	case EX_VirtualFunction:
+	case EX_LocalFinalFunction:
+	case EX_LocalVirtualFunction:
+	case EX_CallMath:
+	{
+		FBlueprintCompiledStatement* Call = ReadCall(Token, nullptr);
+		if (!Call)
+		{
+			return nullptr;
+		}
+		FBPTerminal* Term = new FBPTerminal();
+		FunctionContext.VariableReferences.Add(Term);
+		Term->InlineGeneratedParameter = Call;
+		if (FProperty* ReturnProperty = Call->FunctionToCall->GetReturnProperty())
+		{
+			Schema->ConvertPropertyToPinType(ReturnProperty, Term->Type);
+		}
+		return Term;
+	}
+	case EX_PrimitiveCast:
+	{
+		const uint8 CastType = Read<uint8>();
+		if ((CastType == CST_DoubleToFloat) || (CastType == CST_FloatToDouble))
+		{
+			// the generated code converts between float and double implicitly
+			return ReadTerm();
+		}
+		break;
+	}
+	default:
+		break;
+	}
+
+	SetError(FString::Printf(TEXT("unsupported expression 0x%02X at offset %d"), (uint32)Token, TokenOffset));
+	return nullptr;
+}
+
+//------------------------------------------------------------------------------
+bool BlueprintBytecodeTranslatorImpl::FScriptReader::ReadStatement()
+{
+	const int32 StatementOffset = Offset;
+	UnmappedOffsets.Add(StatementOffset);
+
+	const EExprToken Token = ReadToken();
+	switch (Token)
+	{
+	case EX_Let:
+	case EX_LetBool:
+	case EX_LetObj:
+	case EX_LetWeakObjPtr:
+	{
+		if (Token == EX_Let)
+		{
+			ReadPointer<FProperty>();
+		}
+		FBPTerminal* LHS = ReadTerm();
+		FBPTerminal* RHS = LHS ? ReadTerm() : nullptr;
+		if (!RHS)
+		{
+			return false;
+		}
+
+		const FBlueprintCompiledStatement* Call = RHS->InlineGeneratedParameter;
+		if (Call && (Call->Type == KCST_CallFunction))
+		{
+			// the result of a call is assigned by the call statement itself
+			FBlueprintCompiledStatement& Statement = AppendStatement(KCST_CallFunction);
+			Statement.FunctionToCall = Call->FunctionToCall;
+			Statement.FunctionContext = Call->FunctionContext;
+			Statement.RHS = Call->RHS;
+			Statement.bIsParentContext = Call->bIsParentContext;
+			Statement.LHS = LHS;
+		}
+		else
+		{
+			FBlueprintCompiledStatement& Statement = AppendStatement(KCST_Assignment);
+			Statement.LHS = LHS;
+			Statement.RHS.Add(RHS);
+		}
+		return true;
+	}
+	case EX_Jump:
+	{
+		const CodeSkipSizeType TargetOffset = Read<CodeSkipSizeType>();
+		PendingJumps.Add({ &AppendStatement(KCST_UnconditionalGoto), TargetOffset });
+		return Error.IsEmpty();
+	}
+	case EX_JumpIfNot:
+	{
+		const CodeSkipSizeType TargetOffset = Read<CodeSkipSizeType>();
+		FBPTerminal* Condition = ReadTerm();
+		if (!Condition)
+		{
+			return false;
+		}
+		FBlueprintCompiledStatement& Statement = AppendStatement(KCST_GotoIfNot);
+		Statement.LHS = Condition;
+		PendingJumps.Add({ &Statement, TargetOffset });
+		return true;
+	}
+	case EX_Return:
+	{
+		// the return value is always the ReturnValue property, the emitter returns it at the end of the function
+		const EExprToken ReturnToken = PeekToken();
+		if (ReturnToken == EX_Nothing)
+		{
+			ReadToken();
+		}
+		else if (!ReadTerm())
+		{
+			return false;
+		}
+
+		if (PeekToken() == EX_EndOfScript)
+		{
+			ReturnOffsets.Append(UnmappedOffsets);
+			UnmappedOffsets.Reset();
+		}
+		else
+		{
+			AppendStatement(KCST_GotoReturn);
+		}
+		return true;
+	}
+	case EX_Nothing:
+	case EX_Tracepoint:
+	case EX_WireTracepoint:
+	case EX_Breakpoint:
+		return true;
+	case EX_FinalFunction:
+	case EX_VirtualFunction:
+	case EX_LocalFinalFunction:
+	case EX_LocalVirtualFunction:
+	case EX_CallMath:
+	case EX_Context:
+	case EX_Context_FailSilent:
+	{
+		Offset = StatementOffset;
+		FBPTerminal* Term = ReadTerm();
+		const FBlueprintCompiledStatement* Call = Term ? Term->InlineGeneratedParameter : nullptr;
+		if (!Call || (Call->Type != KCST_CallFunction))
+		{
+			return SetError(FString::Printf(TEXT("unsupported statement at offset %d"), StatementOffset));
+		}
+		FBlueprintCompiledStatement& Statement = AppendStatement(KCST_CallFunction);
+		Statement.FunctionToCall = Call->FunctionToCall;
+		Statement.FunctionContext = Call->FunctionContext;
+		Statement.RHS = Call->RHS;
+		Statement.bIsParentContext = Call->bIsParentContext;
+		return true;
+	}
+	default:
+		break;
+	}
+	return SetError(FString::Printf(TEXT("unsupported statement 0x%02X at offset %d"), (uint32)Token, StatementOffset));
+}
+
+//------------------------------------------------------------------------------
+bool BlueprintBytecodeTranslatorImpl::FScriptReader::ReadFunction()
+{
+	if (!Script.Num())
+	{
+		return SetError(TEXT("no bytecode"));
+	}
+
+	while (Error.IsEmpty() && (PeekToken() != EX_EndOfScript))
+	{
+		if (!ReadStatement())
+		{
+			return false;
+		}
+	}
+	if (!Error.IsEmpty())
+	{
+		return false;
+	}
+	// the end of script can be a jump target too
+	ReturnOffsets.Append(UnmappedOffsets);
+	ReturnOffsets.Add(Offset);
+
+	for (const FPendingJump& Jump : PendingJumps)
+	{
+		if (FBlueprintCompiledStatement** Target = OffsetToStatement.Find((int32)Jump.TargetOffset))
+		{
+			Jump.Statement->TargetLabel = *Target;
+			(*Target)->bIsJumpTarget = true;
+		}
+		else if (ReturnOffsets.Contains((int32)Jump.TargetOffset))
+		{
+			Jump.Statement->Type = (Jump.Statement->Type == KCST_GotoIfNot) ? KCST_GotoReturnIfNot : KCST_GotoReturn;
+		}
+		else
+		{
+			return SetError(FString::Printf(TEXT("jump into the middle of a statement (offset %u)"), Jump.TargetOffset));
+		}
+	}
+	return true;
+}
+
+/*******************************************************************************
+ * FBlueprintBytecodeTranslator
+ ******************************************************************************/
+
+FBlueprintBytecodeTranslator::FBlueprintBytecodeTranslator(UBlueprintGeneratedClass* InSourceClass)
+	: SourceClass(InSourceClass)
+	, MessageLog(false)
+	, StandInNode(nullptr)
+{
+	StandInGraph.Reset(NewObject<UEdGraph>(GetTransientPackage(), NAME_None, RF_Transient));
+	StandInGraph->Schema = UEdGraphSchema_K2::StaticClass();
+	StandInNode = NewObject<UK2Node_FunctionEntry>(StandInGraph.Get(), NAME_None, RF_Transient);
+	StandInGraph->Nodes.Add(StandInNode);
+}
+
+bool FBlueprintBytecodeTranslator::IsEnabled()
+{
+	static const FBoolConfigValueHelper DontTranslateBytecode(TEXT("BlueprintNativizationSettings"), TEXT("bDontTranslateBytecode"));
+	return !DontTranslateBytecode;
+}
+
+bool FBlueprintBytecodeTranslator::Fail(const FString& Reason)
+{
+	FailureReason = Reason;
+	return false;
+}
+
+bool FBlueprintBytecodeTranslator::Translate(TIndirectArray<FKismetFunctionContext>& OutFunctions)
+{
+	BP_CONVERTER_PHASE_SCOPE(TranslateBytecode);
+
+	UBlueprint* Blueprint = SourceClass ? Cast<UBlueprint>(SourceClass->ClassGeneratedBy) : nullptr;
+	if (!Blueprint)
+	{
+		return Fail(TEXT("no Blueprint"));
+	}
+	if (Blueprint->bBeingCompiled || ((Blueprint->Status != BS_UpToDate) && (Blueprint->Status != BS_UpToDateWithWarnings)))
+	{
+		return Fail(TEXT("the class is not up to date"));
+	}
+	if (SourceClass->UberGraphFunction)
+	{
+		return Fail(TEXT("the class has an ubergraph"));
+	}
+
+	const UEdGraphSchema_K2* Schema = GetDefault<UEdGraphSchema_K2>();
+	for (TFieldIterator<UFunction> It(SourceClass, EFieldIteratorFlags::ExcludeSuper); It; ++It)
+	{
+		UFunction* Function = *It;
+		if (Function->HasAnyFunctionFlags(FUNC_Delegate))
+		{
+			// signatures have no body
+			continue;
+		}
+
+		FKismetFunctionContext* FunctionContext = new FKismetFunctionContext(MessageLog, Schema, SourceClass, Blueprint);
+		OutFunctions.Add(FunctionContext);
+		FunctionContext->Function = Function;
+		FunctionContext->SourceGraph = StandInGraph.Get();
+		FunctionContext->EntryPoint = StandInNode;
+		FunctionContext->bIsUbergraph = false;
+		FunctionContext->bUseFlowStack = false;
+		FunctionContext->LinearExecutionList.Add(StandInNode);
+
+		BlueprintBytecodeTranslatorImpl::FScriptReader Reader(*SourceClass, *Function, *FunctionContext, *StandInNode);
+		if (!Reader.ReadFunction())
+		{
+			OutFunctions.Empty();
+			return Fail(FString::Printf(TEXT("%s: %s"), *Function->GetName(), *Reader.GetError()));
+		}
+	}
+	return true;
+}
@@ -0,0 +1,352 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "BlueprintCompilerCppBackendControlFlow.h"
+#include "BPTerminal.h"
+#include "EdGraphSchema_K2.h"
+
+bool FStructuredControlFlow::Build(const TArray<FBlueprintCompiledStatement*>& InStatements)
+{
+	Statements = InStatements;
+	JumpTargets.Init(INDEX_NONE, Statements.Num());
+	LoopTails.Init(INDEX_NONE, Statements.Num());
+	Nodes.Reset();
+	RootNodes.Reset();
+
+	TMap<const FBlueprintCompiledStatement*, int32> StatementIndices;
+	for (int32 Index = 0; Index < Statements.Num(); ++Index)
+	{
+		if (!Statements[Index])
+		{
+			return false;
+		}
+		StatementIndices.Add(Statements[Index], Index);
+	}
+
+	for (int32 Index = 0; Index < Statements.Num(); ++Index)
+	{
+		const FBlueprintCompiledStatement& Statement = *Statements[Index];
+		switch (Statement.Type)
+		{
+		case KCST_ComputedGoto:
+			// the target is known only at runtime
+			return false;
+
+		case KCST_UnconditionalGoto:
+		case KCST_GotoIfNot:
+			{
+				const int32* TargetIndex = Statement.TargetLabel ? StatementIndices.Find(Statement.TargetLabel) : nullptr;
+				if (!TargetIndex)
+				{
+					// the jump leaves the given statements
+					return false;
+				}
+				JumpTargets[Index] = *TargetIndex;
+			}
+			break;
+
+		case KCST_GotoReturn:
+		case KCST_GotoReturnIfNot:
+		case KCST_EndOfThread:
+		case KCST_EndOfThreadIfNot:
+			// an end of thread leaves the function, unless a state was pushed (see ResolveFlowStack)
+			JumpTargets[Index] = Statements.Num();
+			break;
+
+		default:
+			break;
+		}
+	}
+
+	if (!ResolveFlowStack(StatementIndices))
+	{
+		return false;
+	}
+
+	for (int32 Index = 0; Index < Statements.Num(); ++Index)
+	{
+		const int32 Target = JumpTargets[Index];
+		if ((Target != INDEX_NONE) && (Target <= Index))
+		{
+			LoopTails[Target] = FMath::Max(LoopTails[Target], Index);
+		}
+	}
+
+	return StructureRange(0, Statements.Num(), nullptr, false, RootNodes);
+}
+
+bool FStructuredControlFlow::ResolveFlowStack(const TMap<const FBlueprintCompiledStatement*, int32>& StatementIndices)
+{
+	// Each statement must be reached with the same flow stack. Then every end of thread pops a known state.
+	TArray<TOptional<TArray<int32>>> FlowStacks;
+	FlowStacks.SetNum(Statements.Num());
+	TArray<int32> PendingStatements;
+
+	auto Reach = [&](int32 Target, const TArray<int32>& FlowStack) -> bool
+	{
+		if (Target >= Statements.Num())
+		{
+			// the function is left, whatever was pushed
+			return true;
+		}
+		if (!FlowStacks[Target].IsSet())
+		{
+			FlowStacks[Target] = FlowStack;
+			PendingStatements.Push(Target);
+			return true;
+		}
+		return FlowStacks[Target].GetValue() == FlowStack;
+	};
+
+	Reach(0, TArray<int32>());
+	while (PendingStatements.Num())
+	{
+		const int32 Index = PendingStatements.Pop(EAllowShrinking::No);
+		TArray<int32> FlowStack = FlowStacks[Index].GetValue();
+		const FBlueprintCompiledStatement& Statement = *Statements[Index];
+		bool bIsConsistent = true;
+		switch (Statement.Type)
+		{
+		case KCST_PushState:
+			{
+				const int32* PushedIndex = Statement.TargetLabel ? StatementIndices.Find(Statement.TargetLabel) : nullptr;
+				if (!PushedIndex)
+				{
+					return false;
+				}
+				FlowStack.Push(*PushedIndex);
+				bIsConsistent = Reach(Index + 1, FlowStack);
+			}
+			break;
+
+		case KCST_UnconditionalGoto:
+			bIsConsistent = Reach(JumpTargets[Index], FlowStack);
+			break;
+
+		case KCST_GotoIfNot:
+			bIsConsistent = Reach(Index + 1, FlowStack) && Reach(JumpTargets[Index], FlowStack);
+			break;
+
+		case KCST_GotoReturn:
+			break;
+
+		case KCST_EndOfThread:
+		case KCST_EndOfThreadIfNot:
+			if (Statement.Type == KCST_EndOfThreadIfNot)
+			{
+				bIsConsistent = Reach(Index + 1, FlowStack);
+			}
+			if (FlowStack.Num())
+			{
+				JumpTargets[Index] = FlowStack.Pop(EAllowShrinking::No);
+			}
+			bIsConsistent = bIsConsistent && Reach(JumpTargets[Index], FlowStack);
+			break;
+
+		default:
+			bIsConsistent = Reach(Index + 1, FlowStack);
+			break;
+		}
+
+		if (!bIsConsistent)
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+bool FStructuredControlFlow::StructureRange(int32 Begin, int32 End, const FLoopScope* Loop, bool bSkipLoopAtBegin, TArray<int32>& OutNodes)
+{
+	for (int32 Index = Begin; Index < End;)
+	{
+		const int32 LoopTail = ((Index != Begin) || !bSkipLoopAtBegin) ? LoopTails[Index] : INDEX_NONE;
+		if (LoopTail != INDEX_NONE)
+		{
+			if (LoopTail >= End)
+			{
+				// the loop overlaps the enclosing construct
+				return false;
+			}
+
+			const FLoopScope InnerLoop{ Index, LoopTail + 1 };
+			TArray<int32> Body;
+			if (!StructureRange(InnerLoop.Header, InnerLoop.Exit, &InnerLoop, true, Body))
+			{
+				return false;
+			}
+			if ((Body.Num() > 0) && (Nodes[Body.Last()].Type == ENodeType::Continue))
+			{
+				// the end of the loop body continues anyway
+				Body.Pop(EAllowShrinking::No);
+			}
+			else if (!EndsWithJump(Body))
+			{
+				Body.Add(AddNode(ENodeType::Break));
+			}
+			const int32 LoopNode = AddNode(ENodeType::Loop);
+			Nodes[LoopNode].Then = MoveTemp(Body);
+			LowerLoopCondition(LoopNode);
+			OutNodes.Add(LoopNode);
+			Index = InnerLoop.Exit;
+			continue;
+		}
+
+		FBlueprintCompiledStatement* Statement = Statements[Index];
+		if (Statement->Type == KCST_PushState)
+		{
+			// the ends of thread popping the state jump to it
+			++Index;
+			continue;
+		}
+
+		const int32 Target = JumpTargets[Index];
+		if (Target == INDEX_NONE)
+		{
+			OutNodes.Add(AddNode(ENodeType::Statement, Statement));
+			++Index;
+			continue;
+		}
+
+		// a jump to the next statement changes nothing
+		if (Target == (Index + 1))
+		{
+			++Index;
+			continue;
+		}
+
+		ENodeType JumpType;
+		const bool bIsResolvedJump = ResolveJump(Target, Loop, JumpType);
+		if (!IsConditionalJump(*Statement))
+		{
+			if (!bIsResolvedJump)
+			{
+				return false;
+			}
+			OutNodes.Add(AddNode(JumpType, Statement));
+			++Index;
+		}
+		else if (bIsResolvedJump)
+		{
+			// if (!Condition) { break/continue/return; }
+			const int32 JumpNode = AddNode(JumpType, Statement);
+			const int32 IfNode = AddNode(ENodeType::If, Statement);
+			Nodes[IfNode].bNegateCondition = true;
+			Nodes[IfNode].Then.Add(JumpNode);
+			OutNodes.Add(IfNode);
+			++Index;
+		}
+		else if ((Target > Index) && (Target <= End))
+		{
+			// if (Condition) { Then } else { Else }
+			// The "then" part ends with an unconditional jump over the "else" part.
+			int32 ThenEnd = Target;
+			int32 ElseEnd = INDEX_NONE;
+			const int32 LastThenIndex = Target - 1;
+			const int32 LastThenTarget = JumpTargets[LastThenIndex];
+			if (IsUnconditionalJump(*Statements[LastThenIndex]) && (LastThenTarget > Target) && (LastThenTarget <= End))
+			{
+				ThenEnd = LastThenIndex;
+				ElseEnd = LastThenTarget;
+			}
+
+			TArray<int32> Then;
+			TArray<int32> Else;
+			if (!StructureRange(Index + 1, ThenEnd, Loop, false, Then)
+				|| ((ElseEnd != INDEX_NONE) && !StructureRange(Target, ElseEnd, Loop, false, Else)))
+			{
+				return false;
+			}
+
+			const int32 IfNode = AddNode(ENodeType::If, Statement);
+			Nodes[IfNode].Then = MoveTemp(Then);
+			Nodes[IfNode].Else = MoveTemp(Else);
+			OutNodes.Add(IfNode);
+			Index = (ElseEnd != INDEX_NONE) ? ElseEnd : Target;
+		}
+		else
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+bool FStructuredControlFlow::ResolveJump(int32 Target, const FLoopScope* Loop, ENodeType& OutType) const
+{
+	if (Loop && (Target == Loop->Header))
+	{
+		OutType = ENodeType::Continue;
+		return true;
+	}
+	if (Loop && (Target == Loop->Exit))
+	{
+		OutType = ENodeType::Break;
+		return true;
+	}
+	if (Target == Statements.Num())
+	{
+		OutType = ENodeType::Return;
+		return true;
+	}
+	return false;
+}
+
+bool FStructuredControlFlow::EndsWithJump(const TArray<int32>& NodeIndices) const
+{
+	if (NodeIndices.Num() == 0)
+	{
+		return false;
+	}
+	const ENodeType LastType = Nodes[NodeIndices.Last()].Type;
+	return (LastType == ENodeType::Break) || (LastType == ENodeType::Continue) || (LastType == ENodeType::Return);
+}
+
+bool FStructuredControlFlow::ContainsContinue(const TArray<int32>& NodeIndices) const
+{
+	for (const int32 NodeIndex : NodeIndices)
+	{
+		const FNode& Node = Nodes[NodeIndex];
+		if ((Node.Type == ENodeType::Continue)
+			|| ((Node.Type == ENodeType::If) && (ContainsContinue(Node.Then) || ContainsContinue(Node.Else))))
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+void FStructuredControlFlow::LowerLoopCondition(int32 LoopNode)
+{
+	FNode& Loop = Nodes[LoopNode];
+	if (Loop.Then.Num() == 0)
+	{
+		return;
+	}
+
+	// The loop macros (ForLoop, ForEachLoop, WhileLoop) test their condition first: "if (!Condition) break;"
+	const FNode& First = Nodes[Loop.Then[0]];
+	const bool bLeadingCondition = (First.Type == ENodeType::If)
+		&& First.bNegateCondition
+		&& (First.Statement->Type == KCST_GotoIfNot)
+		&& (First.Then.Num() == 1)
+		&& (Nodes[First.Then[0]].Type == ENodeType::Break)
+		&& (First.Else.Num() == 0);
+	if (!bLeadingCondition)
+	{
+		return;
+	}
+	Loop.Statement = First.Statement;
+	Loop.Then.RemoveAt(0);
+
+	// The loop counter is updated last. A "continue" would skip the update, unlike in a "for".
+	if (Loop.Then.Num() && !ContainsContinue(Loop.Then))
+	{
+		const FNode& Last = Nodes[Loop.Then.Last()];
+		const FBPTerminal* Counter = (Last.Type == ENodeType::Statement) && (Last.Statement->Type == KCST_Assignment) ? Last.Statement->LHS : nullptr;
+		if (Counter && !Counter->Context && !Counter->InlineGeneratedParameter && (Counter->Type.PinCategory == UEdGraphSchema_K2::PC_Int) && !Counter->Type.IsContainer())
+		{
+			Loop.Increment = Last.Statement;
+			Loop.Then.Pop(EAllowShrinking::No);
+		}
+	}
+}
@@ -0,0 +1,115 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+#pragma  once
+
+#include "CoreMinimal.h"
+#include "BlueprintCompiledStatement.h"
+
+/**
+ * Rebuilds structured control flow (if/else, while/for loops, early returns) from the jumps of a linear statement list.
+ *
+ * The statements are expected in emission order, the first one is the only entry point. Every jump must be expressible
+ * by a nested construct (a forward jump closes an "if", a backward jump closes a loop, jumps out of a loop become
+ * break/continue/return). The flow stack (pushed by sequences and the loop macros) is resolved statically, each
+ * end of thread becomes a jump to the state it pops. Otherwise (irreducible flow, computed gotos, a flow stack that
+ * depends on the path) Build fails and the backend keeps the "switch" state machine for the function.
+ */
+struct FStructuredControlFlow
+{
+	enum class ENodeType : uint8
+	{
+		Statement,	// a regular statement, emitted as it is
+		If,			// if (Condition) { Then } else { Else }
+		Loop,		// while (true) { Then }, while (Condition) { Then } or for (; Condition; Increment) { Then }
+		Break,
+		Continue,
+		Return,
+	};
+
+	struct FNode
+	{
+		ENodeType Type;
+
+		/** The regular statement, the conditional jump evaluated by an "If" or a "Loop", or the jump replaced by break/continue/return */
+		FBlueprintCompiledStatement* Statement;
+
+		/** "Loop" only. The assignment of the loop counter, executed after each iteration. */
+		FBlueprintCompiledStatement* Increment;
+
+		/** "If" only. When true the condition of the statement is negated. */
+		bool bNegateCondition;
+
+		/** Indices of the child nodes. "Then" is also the body of a loop. */
+		TArray<int32> Then;
+		TArray<int32> Else;
+
+		FNode(ENodeType InType, FBlueprintCompiledStatement* InStatement)
+			: Type(InType)
+			, Statement(InStatement)
+			, Increment(nullptr)
+			, bNegateCondition(false)
+		{}
+	};
+
+	/** Returns false, when the statements cannot be structured. */
+	bool Build(const TArray<FBlueprintCompiledStatement*>& InStatements);
+
+	const TArray<int32>& GetRootNodes() const
+	{
+		return RootNodes;
+	}
+
+	const FNode& GetNode(int32 NodeIndex) const
+	{
+		return Nodes[NodeIndex];
+	}
+
+private:
+	struct FLoopScope
+	{
+		int32 Header;
+		int32 Exit;
+	};
+
+	/** Structures statements in range [Begin, End). Falling through End leaves the range. */
+	bool StructureRange(int32 Begin, int32 End, const FLoopScope* Loop, bool bSkipLoopAtBegin, TArray<int32>& OutNodes);
+
+	/** Finds the jump that can be expressed without a label (break, continue or return) */
+	bool ResolveJump(int32 Target, const FLoopScope* Loop, ENodeType& OutType) const;
+
+	bool EndsWithJump(const TArray<int32>& NodeIndices) const;
+
+	/** Finds a "continue" of the loop, nested loops are skipped */
+	bool ContainsContinue(const TArray<int32>& NodeIndices) const;
+
+	/** Turns "while (true) { if (!Condition) break; Body; Increment; }" into "for (; Condition; Increment) { Body }" */
+	void LowerLoopCondition(int32 LoopNode);
+
+	/** Resolves the targets of the ends of thread by following the states pushed on the flow stack */
+	bool ResolveFlowStack(const TMap<const FBlueprintCompiledStatement*, int32>& StatementIndices);
+
+	int32 AddNode(ENodeType Type, FBlueprintCompiledStatement* Statement = nullptr)
+	{
+		return Nodes.Emplace(Type, Statement);
+	}
+
+	static bool IsConditionalJump(const FBlueprintCompiledStatement& Statement)
+	{
+		return (Statement.Type == KCST_GotoIfNot) || (Statement.Type == KCST_GotoReturnIfNot) || (Statement.Type == KCST_EndOfThreadIfNot);
+	}
+
+	static bool IsUnconditionalJump(const FBlueprintCompiledStatement& Statement)
+	{
+		return (Statement.Type == KCST_UnconditionalGoto) || (Statement.Type == KCST_EndOfThread);
+	}
+
+	TArray<FBlueprintCompiledStatement*> Statements;
+
+	/** Index of the statement the jump leads to (Statements.Num() for the end of function), or INDEX_NONE for regular statements */
+	TArray<int32> JumpTargets;
+
+	/** The last statement jumping back to the given one, or INDEX_NONE */
+	TArray<int32> LoopTails;
+
+	TArray<FNode> Nodes;
+	TArray<int32> RootNodes;
+};
@@ -21,6 +21,12 @@
 #include "K2Node_EnumLiteral.h"
 #include "KismetCompiler.h" // For LogK2Compiler
 #include "Serialization/ArchiveUObject.h"
+#include "Serialization/MemoryReader.h"
+#include "Serialization/MemoryWriter.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Misc/SecureHash.h"
+#include "IO/IoHash.h"
 
 #include "BPConverterDebugHelper.h"
 
@@ -550,10 +556,21 @@ bool FGatherConvertedClassDependencies::IsFieldFromExcludedPackage(const UField*
 
 FGatherConvertedClassDependencies::FGatherConvertedClassDependencies(FPrivateToken, UStruct* InStruct, const FCompilerNativizationOptions& InNativizationOptions)
 	: OriginalStruct(InStruct)
+	, NativizationOptionsHash(HashNativizationOptions(InNativizationOptions))
 	, NativizationOptions(InNativizationOptions)
 {
+	BP_CONVERTER_PHASE_SCOPE(GatherDependencies);
 	check(OriginalStruct);
 
+	if (!LoadFromDiskCache())
+	{
+		GatherDependencies();
+		SaveToDiskCache();
+	}
+}
+
+void FGatherConvertedClassDependencies::GatherDependencies()
+{
 	// Gather headers and type declarations for header.
 	DependenciesForHeader();
 	// Gather headers (only from the class hierarchy) to include in body.
@@ -587,13 +604,13 @@ FGatherConvertedClassDependencies::FGatherConvertedClassDependencies(FPrivateTok
 
 	{
 		TSet<FName> ExcludedModules(NativizationOptions.ExcludedModules);
-		auto RemoveFieldsDependentOnExcludedModules = [&ExcludedModules, InStruct](TSet<UField*>& FieldSet)
+		auto RemoveFieldsDependentOnExcludedModules = [&ExcludedModules, this](TSet<UField*>& FieldSet)
 		{
 			for (auto Iter = FieldSet.CreateIterator(); Iter; ++Iter)
 			{
 				if (IsFieldFromExcludedPackage(*Iter, ExcludedModules))
 				{
-					UE_LOG(LogK2Compiler, Verbose, TEXT("Struct %s depends on an excluded package."), *GetPathNameSafe(InStruct));
+					UE_LOG(LogK2Compiler, Verbose, TEXT("Struct %s depends on an excluded package."), *GetPathNameSafe(OriginalStruct));
 					Iter.RemoveCurrent();
 				}
 			}
@@ -931,24 +948,418 @@ TSet<const UObject*> FGatherConvertedClassDependencies::AllDependencies() const
 	return All;
 }
 
-TMap<UStruct*, TSharedPtr<FGatherConvertedClassDependencies>> FGatherConvertedClassDependencies::CachedConvertedClassDependencies;
+TMap<FGatherConvertedClassDependencies::FCacheKey, TSharedPtr<FGatherConvertedClassDependencies>> FGatherConvertedClassDependencies::CachedConvertedClassDependencies;
+FCriticalSection FGatherConvertedClassDependencies::CachedDependenciesCriticalSection;
 
 TSharedPtr<FGatherConvertedClassDependencies> FGatherConvertedClassDependencies::Get(UStruct* InStruct, const FCompilerNativizationOptions& InNativizationOptions)
 {
-	TSharedPtr<FGatherConvertedClassDependencies> ConvertedClassDependenciesPtr;
-	if (InStruct)
+	if (!InStruct)
+	{
+		return nullptr;
+	}
+
+	// Gathering can get the dependencies of other structs, the lock is recursive
+	FScopeLock Lock(&CachedDependenciesCriticalSection);
+	const FCacheKey CacheKey(InStruct, HashNativizationOptions(InNativizationOptions));
+	if (const TSharedPtr<FGatherConvertedClassDependencies>* CachedDependenciesPtr = CachedConvertedClassDependencies.Find(CacheKey))
 	{
-		ConvertedClassDependenciesPtr = CachedConvertedClassDependencies.FindOrAdd(InStruct);
-		if (!ConvertedClassDependenciesPtr.IsValid())
+		if (CachedDependenciesPtr->IsValid())
 		{
-			ConvertedClassDependenciesPtr = MakeShared<FGatherConvertedClassDependencies>(FPrivateToken{}, InStruct, InNativizationOptions);
-			check(ConvertedClassDependenciesPtr.IsValid());
+			return *CachedDependenciesPtr;
 		}
 	}
 
+	checkf(IsInGameThread(), TEXT("Dependencies of %s must be cached (see CacheDependenciesForEmission) before the code is emitted on a worker thread."), *InStruct->GetPathName());
+
+	// Don't hold a reference into the map while gathering, the map can be modified meanwhile.
+	TSharedPtr<FGatherConvertedClassDependencies> ConvertedClassDependenciesPtr = MakeShared<FGatherConvertedClassDependencies>(FPrivateToken{}, InStruct, InNativizationOptions);
+	check(ConvertedClassDependenciesPtr.IsValid());
+	CachedConvertedClassDependencies.Add(CacheKey, ConvertedClassDependenciesPtr);
+
 	return ConvertedClassDependenciesPtr;
 }
 
+void FGatherConvertedClassDependencies::CacheDependenciesForEmission(UStruct* InStruct, const FCompilerNativizationOptions& InNativizationOptions)
+{
+	check(IsInGameThread());
+
+	TSharedPtr<FGatherConvertedClassDependencies> Dependencies = Get(InStruct, InNativizationOptions);
+	if (!Dependencies.IsValid())
+	{
+		return;
+	}
+
+	Get(Cast<UBlueprintGeneratedClass>(InStruct->GetSuperStruct()), InNativizationOptions);
+
+	// Gets the dependencies of every converted type (e.g. classes of subobjects), as AllDependencies does while the code is emitted.
+	TSet<UObject*> NestedAssets;
+	Dependencies->GatherAssetsReferencedByConvertedTypes(NestedAssets);
+}
+
+void FGatherConvertedClassDependencies::InvalidateCachedDependencies(const UStruct* InStruct)
+{
+	if (!InStruct)
+	{
+		return;
+	}
+
+	FScopeLock Lock(&CachedDependenciesCriticalSection);
+	TSet<const UStruct*> InvalidatedStructs;
+	TArray<const UStruct*> StructsToInvalidate = { InStruct };
+	while (StructsToInvalidate.Num() > 0)
+	{
+		const UStruct* InvalidatedStruct = StructsToInvalidate.Pop();
+		bool bAlreadyInvalidated = false;
+		InvalidatedStructs.Add(InvalidatedStruct, &bAlreadyInvalidated);
+		if (bAlreadyInvalidated)
+		{
+			continue;
+		}
+
+		for (auto Iter = CachedConvertedClassDependencies.CreateIterator(); Iter; ++Iter)
+		{
+			UStruct* CachedStruct = Iter.Key().Key.Get();
+			if (!CachedStruct || !Iter.Value().IsValid())
+			{
+				Iter.RemoveCurrent();
+			}
+			else if ((CachedStruct == InvalidatedStruct) || Iter.Value()->References(InvalidatedStruct))
+			{
+				UE_LOG(LogK2Compiler, Verbose, TEXT("Invalidated cached dependencies of %s."), *CachedStruct->GetPathName());
+				// The struct can be cached with several option sets, it's invalidated only once
+				StructsToInvalidate.Push(CachedStruct);
+				Iter.RemoveCurrent();
+			}
+		}
+	}
+}
+
+void FGatherConvertedClassDependencies::RemoveStaleCachedDependencies()
+{
+	FScopeLock Lock(&CachedDependenciesCriticalSection);
+	for (auto Iter = CachedConvertedClassDependencies.CreateIterator(); Iter; ++Iter)
+	{
+		if (!Iter.Key().Key.IsValid())
+		{
+			Iter.RemoveCurrent();
+		}
+	}
+}
+
+void FGatherConvertedClassDependencies::ClearCachedDependencies()
+{
+	FScopeLock Lock(&CachedDependenciesCriticalSection);
+	CachedConvertedClassDependencies.Empty();
+}
+
+bool FGatherConvertedClassDependencies::References(const UObject* Object) const
+{
+	UObject* MutableObject = const_cast<UObject*>(Object);
+	if (!MutableObject)
+	{
+		return false;
+	}
+
+	if (OriginalStruct->GetSuperStruct() == MutableObject || Assets.Contains(MutableObject))
+	{
+		return true;
+	}
+
+	if (UField* AsField = Cast<UField>(MutableObject))
+	{
+		if (IncludeInHeader.Contains(AsField) || DeclareInHeader.Contains(AsField) || IncludeInBody.Contains(AsField))
+		{
+			return true;
+		}
+	}
+
+	return ConvertedClasses.Contains(Cast<UBlueprintGeneratedClass>(MutableObject))
+		|| ConvertedStructs.Contains(Cast<UUserDefinedStruct>(MutableObject))
+		|| ConvertedEnum.Contains(Cast<UUserDefinedEnum>(MutableObject));
+}
+
+uint32 FGatherConvertedClassDependencies::HashNativizationOptions(const FCompilerNativizationOptions& InNativizationOptions)
+{
+	// Only string hashes are used, the result is stored in the disk cache and FName hashes are not stable between sessions.
+	uint32 Hash = GetTypeHash(InNativizationOptions.PlatformName.ToString());
+	Hash = HashCombine(Hash, GetTypeHash(InNativizationOptions.ServerOnlyPlatform));
+	Hash = HashCombine(Hash, GetTypeHash(InNativizationOptions.ClientOnlyPlatform));
+	Hash = HashCombine(Hash, GetTypeHash(InNativizationOptions.bExcludeMonolithicHeaders));
+	for (const FName& ExcludedModule : InNativizationOptions.ExcludedModules)
+	{
+		Hash = HashCombine(Hash, GetTypeHash(ExcludedModule.ToString()));
+	}
+	// The set order is not deterministic, so the asset hashes are combined in an order independent way.
+	uint32 ExcludedAssetsHash = 0;
+	for (const FSoftObjectPath& ExcludedAsset : InNativizationOptions.ExcludedAssets)
+	{
+		ExcludedAssetsHash += GetTypeHash(ExcludedAsset.ToString());
+	}
+	Hash = HashCombine(Hash, ExcludedAssetsHash);
+	for (const FString& ExcludedFolderPath : InNativizationOptions.ExcludedFolderPaths)
+	{
+		Hash = HashCombine(Hash, GetTypeHash(ExcludedFolderPath));
+	}
+	return Hash;
+}
+
+/*** DISK CACHE ***/
+
+// Bump when the gathered data or the file layout changes.
+static const int32 GatherDependenciesDiskCacheVersion = 2;
+
+static bool CanUseGatherDependenciesDiskCache(const UStruct* InStruct, FIoHash& OutSavedHash)
+{
+	static const FBoolConfigValueHelper CacheOnDisk(TEXT("BlueprintNativizationSettings"), TEXT("bCacheGatheredDependenciesOnDisk"));
+	if (!CacheOnDisk)
+	{
+		return false;
+	}
+
+	// Temporary duplicates made for the conversion (and any other unsaved struct) have no saved hash to key on.
+	const UPackage* Package = InStruct ? InStruct->GetOutermost() : nullptr;
+	if (!Package || (Package == GetTransientPackage()) || Package->HasAnyPackageFlags(PKG_CompiledIn))
+	{
+		return false;
+	}
+	OutSavedHash = Package->GetSavedHash();
+	return !OutSavedHash.IsZero();
+}
+
+template<typename ElementType>
+static void WriteGatheredObjectSet(FArchive& Ar, const TSet<ElementType*>& ObjectSet)
+{
+	TArray<FString> ObjectPaths;
+	ObjectPaths.Reserve(ObjectSet.Num());
+	for (const ElementType* Object : ObjectSet)
+	{
+		// Null entries are kept, so the loaded sets are identical to the gathered ones.
+		ObjectPaths.Add(Object ? Object->GetPathName() : FString());
+	}
+	Ar << ObjectPaths;
+}
+
+template<typename ElementType>
+static bool ReadGatheredObjectSet(FArchive& Ar, TSet<ElementType*>& OutObjectSet)
+{
+	TArray<FString> ObjectPaths;
+	Ar << ObjectPaths;
+	if (Ar.IsError())
+	{
+		return false;
+	}
+
+	OutObjectSet.Reserve(ObjectPaths.Num());
+	for (const FString& ObjectPath : ObjectPaths)
+	{
+		ElementType* Object = nullptr;
+		if (!ObjectPath.IsEmpty())
+		{
+			// Dependencies are expected to be already loaded together with the struct. If not, the cache entry is considered outdated.
+			Object = FindObject<ElementType>(nullptr, *ObjectPath);
+			if (!Object)
+			{
+				return false;
+			}
+		}
+		OutObjectSet.Add(Object);
+	}
+	return true;
+}
+
+FString FGatherConvertedClassDependencies::GetDiskCacheFilename() const
+{
+	const FString CacheDir = FPaths::Combine(*FPaths::ProjectIntermediateDir(), TEXT("BPConverter"), TEXT("DependencyCache"));
+	// One file per option set, like the in-memory cache
+	return FPaths::Combine(*CacheDir, *FString::Printf(TEXT("%s_%08X.bin"), *FMD5::HashAnsiString(*OriginalStruct->GetPathName()), NativizationOptionsHash));
+}
+
+bool FGatherConvertedClassDependencies::GetDependencyPackageHashes(TArray<FString>& OutPackageNames, TArray<FIoHash>& OutSavedHashes) const
+{
+	TSet<const UPackage*> DependencyPackages;
+	auto AddDependencyPackage = [&DependencyPackages](const UObject* Object)
+	{
+		if (Object)
+		{
+			DependencyPackages.Add(Object->GetOutermost());
+		}
+	};
+	auto AddDependencyPackages = [&AddDependencyPackage](const auto& ObjectSet)
+	{
+		for (const UObject* Object : ObjectSet)
+		{
+			AddDependencyPackage(Object);
+		}
+	};
+	AddDependencyPackages(Assets);
+	AddDependencyPackages(ConvertedClasses);
+	AddDependencyPackages(ConvertedStructs);
+	AddDependencyPackages(ConvertedEnum);
+	AddDependencyPackages(IncludeInHeader);
+	AddDependencyPackages(DeclareInHeader);
+	AddDependencyPackages(IncludeInBody);
+	// The parent class and the interfaces decide what is gathered, even when they are not listed in the sets
+	AddDependencyPackage(OriginalStruct->GetSuperStruct());
+	if (const UClass* SourceClass = Cast<UClass>(OriginalStruct))
+	{
+		for (const FImplementedInterface& ImplementedInterface : SourceClass->Interfaces)
+		{
+			AddDependencyPackage(ImplementedInterface.Class);
+		}
+	}
+
+	TArray<const UPackage*> SortedPackages;
+	for (const UPackage* Package : DependencyPackages)
+	{
+		// Native code changes are not tracked, the struct's own package is validated separately.
+		if ((Package != OriginalStruct->GetOutermost()) && !Package->HasAnyPackageFlags(PKG_CompiledIn))
+		{
+			SortedPackages.Add(Package);
+		}
+	}
+	SortedPackages.Sort([](const UPackage& A, const UPackage& B)
+	{
+		return A.GetFName().LexicalLess(B.GetFName());
+	});
+
+	OutPackageNames.Reset(SortedPackages.Num());
+	OutSavedHashes.Reset(SortedPackages.Num());
+	for (const UPackage* Package : SortedPackages)
+	{
+		const FIoHash SavedHash = Package->GetSavedHash();
+		if (SavedHash.IsZero())
+		{
+			// An unsaved (or transient) dependency cannot be validated
+			return false;
+		}
+		OutPackageNames.Add(Package->GetName());
+		OutSavedHashes.Add(SavedHash);
+	}
+	return true;
+}
+
+bool FGatherConvertedClassDependencies::LoadFromDiskCache()
+{
+	FIoHash SavedHash;
+	if (!CanUseGatherDependenciesDiskCache(OriginalStruct, SavedHash))
+	{
+		return false;
+	}
+
+	TArray<uint8> CacheData;
+	if (!FFileHelper::LoadFileToArray(CacheData, *GetDiskCacheFilename(), FILEREAD_Silent))
+	{
+		return false;
+	}
+
+	FMemoryReader Reader(CacheData);
+	int32 CachedVersion = 0;
+	FString CachedStructPath;
+	FIoHash CachedSavedHash;
+	uint32 CachedOptionsHash = 0;
+	Reader << CachedVersion;
+	if (Reader.IsError() || (CachedVersion != GatherDependenciesDiskCacheVersion))
+	{
+		return false;
+	}
+	Reader << CachedStructPath << CachedSavedHash << CachedOptionsHash;
+	if (Reader.IsError() || (CachedSavedHash != SavedHash) || (CachedOptionsHash != NativizationOptionsHash) || (CachedStructPath != OriginalStruct->GetPathName()))
+	{
+		return false;
+	}
+
+	// A dependency (e.g. the parent class, or a user defined struct) saved since the entry was written can change what is gathered
+	TArray<FString> DependencyPackageNames;
+	TArray<FIoHash> DependencySavedHashes;
+	Reader << DependencyPackageNames << DependencySavedHashes;
+	if (Reader.IsError() || (DependencyPackageNames.Num() != DependencySavedHashes.Num()))
+	{
+		return false;
+	}
+	for (int32 Index = 0; Index < DependencyPackageNames.Num(); ++Index)
+	{
+		const UPackage* DependencyPackage = FindPackage(nullptr, *DependencyPackageNames[Index]);
+		if (!DependencyPackage || (DependencyPackage->GetSavedHash() != DependencySavedHashes[Index]))
+		{
+			UE_LOG(LogK2Compiler, Verbose, TEXT("The cached dependencies of %s are outdated, %s changed."), *OriginalStruct->GetPathName(), *DependencyPackageNames[Index]);
+			return false;
+		}
+	}
+
+	TArray<FString> RequiredModulePaths;
+	const bool bLoaded = ReadGatheredObjectSet(Reader, Assets)
+		&& ReadGatheredObjectSet(Reader, ConvertedClasses)
+		&& ReadGatheredObjectSet(Reader, ConvertedStructs)
+		&& ReadGatheredObjectSet(Reader, ConvertedEnum)
+		&& ReadGatheredObjectSet(Reader, IncludeInHeader)
+		&& ReadGatheredObjectSet(Reader, DeclareInHeader)
+		&& ReadGatheredObjectSet(Reader, IncludeInBody)
+		&& !(Reader << RequiredModulePaths).IsError();
+	if (!bLoaded)
+	{
+		Assets.Empty();
+		ConvertedClasses.Empty();
+		ConvertedStructs.Empty();
+		ConvertedEnum.Empty();
+		IncludeInHeader.Empty();
+		DeclareInHeader.Empty();
+		IncludeInBody.Empty();
+		return false;
+	}
+
+	for (const FString& RequiredModulePath : RequiredModulePaths)
+	{
+		RequiredModuleNames.Add(TSoftObjectPtr<UPackage>(FSoftObjectPath(RequiredModulePath)));
+	}
+
+	UE_LOG(LogK2Compiler, Verbose, TEXT("Dependencies of %s loaded from the disk cache."), *OriginalStruct->GetPathName());
+	return true;
+}
+
+void FGatherConvertedClassDependencies::SaveToDiskCache() const
+{
+	FIoHash SavedHash;
+	if (!CanUseGatherDependenciesDiskCache(OriginalStruct, SavedHash))
+	{
+		return;
+	}
+
+	TArray<FString> DependencyPackageNames;
+	TArray<FIoHash> DependencySavedHashes;
+	if (!GetDependencyPackageHashes(DependencyPackageNames, DependencySavedHashes))
+	{
+		return;
+	}
+
+	TArray<uint8> CacheData;
+	FMemoryWriter Writer(CacheData);
+	int32 Version = GatherDependenciesDiskCacheVersion;
+	FString StructPath = OriginalStruct->GetPathName();
+	uint32 OptionsHash = NativizationOptionsHash;
+	Writer << Version << StructPath << SavedHash << OptionsHash;
+	Writer << DependencyPackageNames << DependencySavedHashes;
+
+	WriteGatheredObjectSet(Writer, Assets);
+	WriteGatheredObjectSet(Writer, ConvertedClasses);
+	WriteGatheredObjectSet(Writer, ConvertedStructs);
+	WriteGatheredObjectSet(Writer, ConvertedEnum);
+	WriteGatheredObjectSet(Writer, IncludeInHeader);
+	WriteGatheredObjectSet(Writer, DeclareInHeader);
+	WriteGatheredObjectSet(Writer, IncludeInBody);
+
+	TArray<FString> RequiredModulePaths;
+	for (const TSoftObjectPtr<UPackage>& RequiredModule : RequiredModuleNames)
+	{
+		RequiredModulePaths.Add(RequiredModule.ToString());
+	}
+	Writer << RequiredModulePaths;
+
+	if (!FFileHelper::SaveArrayToFile(CacheData, *GetDiskCacheFilename()))
+	{
+		UE_LOG(LogK2Compiler, Warning, TEXT("Cannot save the dependency cache of %s."), *OriginalStruct->GetPathName());
+	}
+}
+
 class FArchiveReferencesInStructInstance : public FArchive
 {
 public:
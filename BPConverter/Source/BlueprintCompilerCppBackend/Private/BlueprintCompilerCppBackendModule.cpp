@@ -2,13 +2,22 @@
 
 #include "CoreMinimal.h"
 #include "Modules/ModuleManager.h"
+#include "UObject/UObjectGlobals.h"
+#include "Editor.h"
+#include "Engine/Blueprint.h"
 #include "IBlueprintCompilerCppBackendModule.h"
 #include "BlueprintCompilerCppBackend.h"
 #include "BlueprintCompilerCppBackendUtils.h"
+#include "BlueprintCompilerCppBackendGatherDependencies.h"
 
 class FBlueprintCompilerCppBackendModule : public IBlueprintCompilerCppBackendModule
 {
 public:
+	//~ Begin IModuleInterface interface
+	virtual void StartupModule() override;
+	virtual void ShutdownModule() override;
+	//~ End IModuleInterface interface
+
 	//~ Begin IBlueprintCompilerCppBackendModuleInterface interface
 	virtual IBlueprintCompilerCppBackend* Create() override;
 	//~ End IBlueprintCompilerCppBackendModuleInterface interface
@@ -23,6 +32,8 @@ public:
 	virtual TSharedPtr<FNativizationSummary>& NativizationSummary() override;
 	virtual FString DependenciesGlobalMapHeaderCode() override;
 	virtual FString DependenciesGlobalMapBodyCode(const FString& PCHFilename) override;
+	virtual void DeferDependencyRecords(FDeferredDependencyRecords* Records) override;
+	virtual void ResolveDeferredDependencies(const FDeferredDependencyRecords& Records, FString& InOutSource) override;
 	//~ End IBlueprintCompilerCppBackendModule interface
 
 private: 
@@ -32,8 +43,43 @@ private:
 	FIsFunctionUsedInADelegate IsFunctionUsedInADelegate;
 	TMap<TWeakObjectPtr<UClass>, TWeakObjectPtr<UClass> > OriginalClassMap;
 	TSharedPtr<FNativizationSummary> NativizationSummaryPtr;
+	FDelegateHandle BlueprintPreCompileHandle;
+	FDelegateHandle PostGarbageCollectHandle;
 };
 
+void FBlueprintCompilerCppBackendModule::StartupModule()
+{
+	// Gathered dependencies and generated names are cached, so they must be dropped when a Blueprint (or anything it depends on) is recompiled.
+	if (GEditor)
+	{
+		BlueprintPreCompileHandle = GEditor->OnBlueprintPreCompile().AddLambda([](UBlueprint* Blueprint)
+		{
+			if (Blueprint)
+			{
+				FGatherConvertedClassDependencies::InvalidateCachedDependencies(Blueprint->GeneratedClass);
+			}
+			FEmitHelper::ClearCppNameCache();
+		});
+	}
+	PostGarbageCollectHandle = FCoreUObjectDelegates::GetPostGarbageCollect().AddLambda([]()
+	{
+		FGatherConvertedClassDependencies::RemoveStaleCachedDependencies();
+		// names are keyed by pointers, which can be reused by new objects
+		FEmitHelper::ClearCppNameCache();
+	});
+}
+
+void FBlueprintCompilerCppBackendModule::ShutdownModule()
+{
+	if (GEditor)
+	{
+		GEditor->OnBlueprintPreCompile().Remove(BlueprintPreCompileHandle);
+	}
+	FCoreUObjectDelegates::GetPostGarbageCollect().Remove(PostGarbageCollectHandle);
+	FGatherConvertedClassDependencies::ClearCachedDependencies();
+	FEmitHelper::ClearCppNameCache();
+}
+
 IBlueprintCompilerCppBackend* FBlueprintCompilerCppBackendModule::Create()
 {
 	return new FBlueprintCompilerCppBackend();
@@ -85,4 +131,14 @@ FString FBlueprintCompilerCppBackendModule::DependenciesGlobalMapBodyCode(const
 	return FDependenciesGlobalMapHelper::EmitBodyCode(PCHFilename);
 }
 
+void FBlueprintCompilerCppBackendModule::DeferDependencyRecords(FDeferredDependencyRecords* Records)
+{
+	FDependenciesGlobalMapHelper::DeferRecords(Records);
+}
+
+void FBlueprintCompilerCppBackendModule::ResolveDeferredDependencies(const FDeferredDependencyRecords& Records, FString& InOutSource)
+{
+	FDependenciesGlobalMapHelper::ResolveDeferredRecords(Records, InOutSource);
+}
+
 IMPLEMENT_MODULE(FBlueprintCompilerCppBackendModule, BlueprintCompilerCppBackend)
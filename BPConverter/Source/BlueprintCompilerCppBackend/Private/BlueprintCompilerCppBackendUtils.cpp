@@ -8,6 +8,7 @@
 #include "UObject/TextProperty.h"
 #include "UObject/PropertyPortFlags.h"
 #include "UObject/SoftObjectPath.h"
+#include "Misc/ScopeRWLock.h"
 #include "Components/ActorComponent.h"
 #include "Engine/BlueprintGeneratedClass.h"
 #include "Engine/UserDefinedEnum.h"
@@ -22,13 +23,134 @@
 
 #include "BPConverterDebugHelper.h"
 
+/**
+ * Names generated by FEmitHelper::GetCppName and GetPathPostfix, cached for the session. They depend on names, flags, owners
+ * and package paths, so the cache is dropped when a Blueprint is recompiled or objects are garbage collected (see FEmitHelper::ClearCppNameCache).
+ * Names are generated without holding the lock, as generating a name can get other names.
+ */
+struct FCppNameCache
+{
+	// Classes can be emitted on several threads at once
+	FRWLock Lock;
+	// Keyed by the field and the GetCppName options (see MakeOptions)
+	TMap<TPair<FFieldVariant, uint8>, FSetElementId> FieldNames;
+	TMap<const UPackage*, FSetElementId> PathPostfixes;
+	// Intern table, each distinct name is stored once
+	TSet<FString> Names;
+
+	static uint8 MakeOptions(bool bUInterface, bool bForceParameterNameModification)
+	{
+		return (bUInterface ? 1 : 0) | (bForceParameterNameModification ? 2 : 0);
+	}
+
+	FSetElementId Intern(FString&& Name)
+	{
+		return Names.Add(MoveTemp(Name));
+	}
+
+	void Empty()
+	{
+		FWriteScopeLock WriteLock(Lock);
+		FieldNames.Empty();
+		PathPostfixes.Empty();
+		Names.Empty();
+	}
+
+	static FCppNameCache& Get()
+	{
+		static FCppNameCache Cache;
+		return Cache;
+	}
+};
+
 FString GetPathPostfix(const UObject* ForObject)
 {
-	FString FullAssetName = ForObject->GetOutermost()->GetPathName();
+	const UPackage* Package = ForObject->GetOutermost();
+	FCppNameCache& Cache = FCppNameCache::Get();
+	{
+		FReadScopeLock ReadLock(Cache.Lock);
+		if (const FSetElementId* CachedId = Cache.PathPostfixes.Find(Package))
+		{
+			return Cache.Names[*CachedId];
+		}
+	}
+
+	FString FullAssetName = Package->GetPathName();
 	FString AssetName = FPackageName::GetLongPackageAssetName(FullAssetName);
 	// append a hash of the path, this uniquely identifies assets with the same name, but different folders:
 	FullAssetName.RemoveFromEnd(AssetName);
-	return FString::Printf(TEXT("%u"), GetTypeHash(FullAssetName));
+	FString PathPostfix = FString::Printf(TEXT("%u"), GetTypeHash(FullAssetName));
+
+	FWriteScopeLock WriteLock(Cache.Lock);
+	const FSetElementId Id = Cache.Intern(MoveTemp(PathPostfix));
+	Cache.PathPostfixes.Add(Package, Id);
+	return Cache.Names[Id];
+}
+
+void FCodeText::AddLine(const FString& Line)
+{
+	const int32 LineLen = IndentLevel + Line.Len() + 1;
+	if (!bCanAppendToLastChunk || ((Chunks.Last().Len() + LineLen) > MaxChunkLen))
+	{
+		Chunks.AddDefaulted_GetRef().Reserve(FMath::Min(FMath::Max(LineLen, 256), MaxChunkLen));
+		bCanAppendToLastChunk = true;
+	}
+
+	FString& Chunk = Chunks.Last();
+	for (int32 Index = 0; Index < IndentLevel; ++Index)
+	{
+		Chunk.AppendChar(TEXT('\t'));
+	}
+	Chunk.Append(Line);
+	Chunk.AppendChar(TEXT('\n'));
+}
+
+void FCodeText::AddSlot(FName SlotName)
+{
+	check(!Slots.ContainsByPredicate([SlotName](const TPair<FName, int32>& Slot) { return Slot.Key == SlotName; }));
+	Slots.Emplace(SlotName, Chunks.Num());
+	Chunks.AddDefaulted();
+	bCanAppendToLastChunk = false;
+}
+
+void FCodeText::FillSlot(FName SlotName, FCodeText&& SlotCode)
+{
+	const int32 SlotIndex = Slots.IndexOfByPredicate([SlotName](const TPair<FName, int32>& Slot) { return Slot.Key == SlotName; });
+	if (ensureMsgf(SlotIndex != INDEX_NONE, TEXT("Unknown code slot: %s"), *SlotName.ToString()))
+	{
+		Chunks[Slots[SlotIndex].Value] = SlotCode.MoveToString();
+		Slots.RemoveAtSwap(SlotIndex);
+	}
+}
+
+int32 FCodeText::Len() const
+{
+	int32 Length = 0;
+	for (const FString& Chunk : Chunks)
+	{
+		Length += Chunk.Len();
+	}
+	return Length;
+}
+
+FString FCodeText::ToString() const
+{
+	FString Result;
+	Result.Reserve(Len());
+	for (const FString& Chunk : Chunks)
+	{
+		Result.Append(Chunk);
+	}
+	return Result;
+}
+
+FString FCodeText::MoveToString()
+{
+	FString Result = (Chunks.Num() == 1) ? MoveTemp(Chunks[0]) : ToString();
+	Chunks.Empty();
+	Slots.Empty();
+	bCanAppendToLastChunk = false;
+	return Result;
 }
 
 FString FEmitterLocalContext::GenerateUniqueLocalName()
@@ -281,7 +403,7 @@ FString FEmitterLocalContext::FindGloballyMappedObject(const UObject* Object, co
 				AssetIndex = UsedObjectInCurrentClass.Add(Object);
 			}
 
-			if (INDEX_NONE == AssetIndex)
+			if ((INDEX_NONE == AssetIndex) && !ObjectsOutsideOfAssets.Contains(Object))
 			{
 				// Handle subobjects of assets
 				UPackage* Outermost = Object->GetOutermost();
@@ -312,15 +434,17 @@ FString FEmitterLocalContext::FindGloballyMappedObject(const UObject* Object, co
 						ObjectOuter = ObjectOuter->GetOuter();
 					}
 				}
+
+				if (INDEX_NONE == AssetIndex)
+				{
+					ObjectsOutsideOfAssets.Add(Object);
+				}
 			}
 
 			if (INDEX_NONE != AssetIndex)
 			{
-				// @zhouminyi Need more consideration about UDynamicClass.
-				// UDynmaicClass has been removed since https://github.com/EpicGames/UnrealEngine/commit/d0c504f34e98aa01484d52cf6cc212648519a7d9
-				// So just return member name without executing the statements like GET_MEMBER_NAME_STRING_CHECKED(UDynamicClass, UsedAssets).
-				
-				return FString::Printf(TEXT("CastChecked<%s>(CastChecked<UDynamicClass>(%s::StaticClass())->UsedAssets[%d], ECastCheckedType::NullAllowed)")
+				// UDynamicClass::UsedAssets was removed in UE5, the class has its own table, resolved on the first call of __UsedAssets.
+				return FString::Printf(TEXT("static_cast<%s*>(%s::__UsedAssets()[%d].Get())")
 					, *ClassString()
 					, *FEmitHelper::GetCppName(ActualClass)
 					, AssetIndex);
@@ -680,9 +804,36 @@ void FEmitterLocalContext::MarkUnconvertedClassAsNecessary(UField* InField)
 }
 
 
+static FString GenerateCppName(FFieldVariant Field, bool bUInterface, bool bForceParameterNameModification);
+
 FString FEmitHelper::GetCppName(FFieldVariant Field, bool bUInterface, bool bForceParameterNameModification)
 {
 	check(Field);
+	FCppNameCache& Cache = FCppNameCache::Get();
+	const TPair<FFieldVariant, uint8> Key(Field, FCppNameCache::MakeOptions(bUInterface, bForceParameterNameModification));
+	{
+		FReadScopeLock ReadLock(Cache.Lock);
+		if (const FSetElementId* CachedId = Cache.FieldNames.Find(Key))
+		{
+			return Cache.Names[*CachedId];
+		}
+	}
+
+	FString CppName = GenerateCppName(Field, bUInterface, bForceParameterNameModification);
+
+	FWriteScopeLock WriteLock(Cache.Lock);
+	const FSetElementId Id = Cache.Intern(MoveTemp(CppName));
+	Cache.FieldNames.Add(Key, Id);
+	return Cache.Names[Id];
+}
+
+void FEmitHelper::ClearCppNameCache()
+{
+	FCppNameCache::Get().Empty();
+}
+
+static FString GenerateCppName(FFieldVariant Field, bool bUInterface, bool bForceParameterNameModification)
+{
 	const UClass* AsClass = Field.Get<UClass>();
 	const UScriptStruct* AsScriptStruct = Field.Get<UScriptStruct>();
 	if (AsClass || AsScriptStruct)
@@ -719,7 +870,7 @@ FString FEmitHelper::GetCppName(FFieldVariant Field, bool bUInterface, bool bFor
 			const bool bFunctionLocalVariable = Owner->IsA<UFunction>();
 			if (bIsUberGraphVariable)
 			{
-				int32 InheritenceLevel = GetInheritenceLevel(Owner);
+				int32 InheritenceLevel = FEmitHelper::GetInheritenceLevel(Owner);
 				VarPrefix = FString::Printf(TEXT("b%dl__"), InheritenceLevel);
 			}
 			else if (bIsParameter)
@@ -2265,10 +2416,20 @@ FString FEmitHelper::GenerateGetPropertyByName(FEmitterLocalContext& EmitterCont
 	}
 
 	const FString PropertyPtrName = EmitterContext.GenerateUniqueLocalName();
+	const FString PropertyOwnerStruct = EmitterContext.FindGloballyMappedObject(Property->GetOwnerStruct(), UStruct::StaticClass());
 
 	static const FBoolConfigValueHelper UseStaticVariables(TEXT("BlueprintNativizationSettings"), TEXT("bUseStaticVariablesInClasses"));
 	const bool bUseStaticVariables = UseStaticVariables;
-	if (bUseStaticVariables)
+	if (Property->GetOwnerStruct()->IsNative())
+	{
+		// Native properties live as long as the process, so the lookup is done once, on the first call.
+		EmitterContext.AddLine(FString::Printf(TEXT("static const FProperty* const %s = [&]() { const FProperty* FoundProperty = (%s)->%s(FName(TEXT(\"%s\"))); check(FoundProperty); return FoundProperty; }();")
+			, *PropertyPtrName
+			, *PropertyOwnerStruct
+			, GET_FUNCTION_NAME_STRING_CHECKED(UStruct, FindPropertyByName)
+			, *Property->GetName()));
+	}
+	else if (bUseStaticVariables)
 	{
 		const FString PropertyWeakPtrName = EmitterContext.GenerateUniqueLocalName();
 		EmitterContext.AddLine(FString::Printf(TEXT("static TWeakFieldPtr<FProperty> %s{};"), *PropertyWeakPtrName));
@@ -2278,7 +2439,6 @@ FString FEmitHelper::GenerateGetPropertyByName(FEmitterLocalContext& EmitterCont
 		EmitterContext.AddLine(TEXT("{"));
 		EmitterContext.IncreaseIndent();
 
-		const FString PropertyOwnerStruct = EmitterContext.FindGloballyMappedObject(Property->GetOwnerStruct(), UStruct::StaticClass());
 		EmitterContext.AddLine(FString::Printf(TEXT("%s = (%s)->%s(FName(TEXT(\"%s\")));")
 			, *PropertyPtrName
 			, *PropertyOwnerStruct
@@ -2291,8 +2451,7 @@ FString FEmitHelper::GenerateGetPropertyByName(FEmitterLocalContext& EmitterCont
 	}
 	else 
 	{
-		const FString PropertyOwnerStruct = EmitterContext.FindGloballyMappedObject(Property->GetOwnerStruct(), UStruct::StaticClass());
-		EmitterContext.AddLine(FString::Printf(TEXT("const FProperty* %s = (%s)->FindPropertyByName(FName(TEXT(\"%s\")));")
+		EmitterContext.AddLine(FString::Printf(TEXT("const FProperty* %s = (%s)->%s(FName(TEXT(\"%s\")));")
 			, *PropertyPtrName
 			, *PropertyOwnerStruct
 			, GET_FUNCTION_NAME_STRING_CHECKED(UStruct, FindPropertyByName)
@@ -2319,6 +2478,7 @@ void FNativizationSummaryHelper::InaccessibleProperty(const FProperty* Property)
 	if (NativizationSummary.IsValid())
 	{
 		FString Key(Property->GetPathName());
+		FScopeLock Lock(&NativizationSummary->CriticalSection);
 		int32* FoundStat = NativizationSummary->InaccessiblePropertyStat.Find(Key);
 		if (FoundStat)
 		{
@@ -2344,6 +2504,7 @@ static void FNativizationSummaryHelper__MemberUsed(const UClass* Class, FFieldVa
 			const bool bUnrelatedClass = !Class->IsChildOf(Owner);
 			if (AnimBP && bUnrelatedClass)
 			{
+				FScopeLock Lock(&NativizationSummary->CriticalSection);
 				FNativizationSummary::FAnimBlueprintDetails& AnimBlueprintDetails = NativizationSummary->AnimBlueprintStat.FindOrAdd(FSoftObjectPath(AnimBP));
 				(AnimBlueprintDetails.*CouterPtr)++;
 			}
@@ -2370,6 +2531,7 @@ void FNativizationSummaryHelper::ReducibleFunciton(const UClass* OriginalClass)
 		UAnimBlueprint* AnimBP = Cast<UAnimBlueprint>(UBlueprint::GetBlueprintFromClass(OriginalClass));
 		if (NativizationSummary.IsValid() && OriginalClass && AnimBP)
 		{
+			FScopeLock Lock(&NativizationSummary->CriticalSection);
 			FNativizationSummary::FAnimBlueprintDetails& AnimBlueprintDetails = NativizationSummary->AnimBlueprintStat.FindOrAdd(FSoftObjectPath(AnimBP));
 			AnimBlueprintDetails.ReducibleFunctions++;
 		}
@@ -2382,6 +2544,7 @@ void FNativizationSummaryHelper::RegisterRequiredModules(const FName PlatformNam
 	TSharedPtr<FNativizationSummary> NativizationSummary = BackEndModule.NativizationSummary();
 	if (NativizationSummary.IsValid())
 	{
+		FScopeLock Lock(&NativizationSummary->CriticalSection);
 		TSet<TSoftObjectPtr<UPackage>>& Modules = NativizationSummary->ModulesRequiredByPlatform.FindOrAdd(PlatformName);
 		Modules.Append(InModules);
 	}
@@ -2394,6 +2557,7 @@ void FNativizationSummaryHelper::RegisterClass(const UClass* OriginalClass)
 	UAnimBlueprint* AnimBP = Cast<UAnimBlueprint>(UBlueprint::GetBlueprintFromClass(OriginalClass));
 	if (NativizationSummary.IsValid() && OriginalClass && AnimBP)
 	{
+		FScopeLock Lock(&NativizationSummary->CriticalSection);
 		{
 			FNativizationSummary::FAnimBlueprintDetails& AnimBlueprintDetails = NativizationSummary->AnimBlueprintStat.FindOrAdd(FSoftObjectPath(AnimBP));
 
@@ -2621,11 +2785,49 @@ const TCHAR* FEmitHelper::EmptyDefaultConstructor(UScriptStruct* Struct)
 
 FString FDependenciesGlobalMapHelper::EmitHeaderCode()
 {
-	return TEXT("#pragma once\n#include \"Blueprint/BlueprintSupport.h\"\nstruct F__NativeDependencies { \n\tstatic const FBlueprintDependencyObjectRef& Get(int16 Index);\n };");
+	return TEXT("#pragma once\n#include \"Blueprint/BlueprintSupport.h\"\nstruct F__NativeDependencies { \n\tstatic const FBlueprintDependencyObjectRef& Get(int32 Index);\n\tstatic UObject* Resolve(int32 Index);\n };");
 }
 
 FString FDependenciesGlobalMapHelper::EmitBodyCode(const FString& PCHFilename)
 {
+	TArray<FNativizationSummary::FDependencyRecord> DependenciesArray;
+	{
+		FNativizationSummary& NativizationSummary = GetNativizationSummary();
+		FScopeLock Lock(&NativizationSummary.CriticalSection);
+		NativizationSummary.DependenciesGlobalMap.GenerateValueArray(DependenciesArray);
+	}
+	DependenciesArray.Sort(
+		[](const FNativizationSummary::FDependencyRecord& A, const FNativizationSummary::FDependencyRecord& B) -> bool
+	{
+		return A.Index < B.Index;
+	});
+
+	// Package paths, class names etc. are shared by many records, so each distinct string is emitted once and the records store indices into the pool.
+	TArray<FString> StringPool;
+	TMap<FString, int32> StringPoolIndices;
+	TArray<FString> RecordLines;
+	RecordLines.Reserve(DependenciesArray.Num());
+	for (int32 Index = 0; Index < DependenciesArray.Num(); ++Index)
+	{
+		const FNativizationSummary::FDependencyRecord& Record = DependenciesArray[Index];
+		ensure(Record.ObjectRefStrings.Num() == NumObjectRefStrings);
+		ensure(Record.Index == Index);
+
+		FString RecordLine = TEXT("{");
+		for (int32 StringIndex = 0; StringIndex < NumObjectRefStrings; ++StringIndex)
+		{
+			const FString& String = Record.ObjectRefStrings.IsValidIndex(StringIndex) ? Record.ObjectRefStrings[StringIndex] : FString();
+			int32* PoolIndex = StringPoolIndices.Find(String);
+			if (!PoolIndex)
+			{
+				PoolIndex = &StringPoolIndices.Add(String, StringPool.Add(String));
+			}
+			RecordLine += FString::Printf(TEXT("%s%d"), StringIndex ? TEXT(", ") : TEXT(""), *PoolIndex);
+		}
+		RecordLine += TEXT("},");
+		RecordLines.Add(MoveTemp(RecordLine));
+	}
+
 	FCodeText CodeText;
 	CodeText.AddLine(FString::Printf(TEXT("#include \"%s.h\""), *PCHFilename));
 	{
@@ -2635,54 +2837,169 @@ FString FDependenciesGlobalMapHelper::EmitBodyCode(const FString& PCHFilename)
 		CodeText.AddLine("namespace");
 		CodeText.AddLine("{");
 		CodeText.IncreaseIndent();
-		CodeText.AddLine("static const FBlueprintDependencyObjectRef NativizedCodeDependenties[] =");
+		CodeText.AddLine("static const TCHAR* const NativizedCodeDependencyStrings[] =");
 		CodeText.AddLine("{");
-
-		TArray<FNativizationSummary::FDependencyRecord> DependenciesArray;
+		CodeText.IncreaseIndent();
+		for (const FString& String : StringPool)
 		{
-			auto& DependenciesGlobalMap = GetDependenciesGlobalMap();
-			DependenciesGlobalMap.GenerateValueArray(DependenciesArray);
+			CodeText.AddLine(FString::Printf(TEXT("TEXT(\"%s\"),"), *String.ReplaceCharWithEscapedChar()));
 		}
+		if (!StringPool.Num())
+		{
+			CodeText.AddLine(TEXT("TEXT(\"\")"));
+		}
+		CodeText.DecreaseIndent();
+		CodeText.AddLine(TEXT("};"));
 
-		if (DependenciesArray.Num() > 0)
+		CodeText.AddLine(FString::Printf(TEXT("struct FNativizedCodeDependencyRecord { int32 Strings[%d]; };"), NumObjectRefStrings));
+		CodeText.AddLine("static const FNativizedCodeDependencyRecord NativizedCodeDependencyRecords[] =");
+		CodeText.AddLine("{");
+		CodeText.IncreaseIndent();
+		for (const FString& RecordLine : RecordLines)
 		{
-			DependenciesArray.Sort(
-				[](const FNativizationSummary::FDependencyRecord& A, const FNativizationSummary::FDependencyRecord& B) -> bool
-			{
-				return A.Index < B.Index;
-			});
-			int32 Index = 0;
-			for (FNativizationSummary::FDependencyRecord& Record : DependenciesArray)
-			{
-				ensure(!Record.NativeLine.IsEmpty());
-				ensure(Record.Index == Index);
-				Index++;
-				CodeText.AddLine(Record.NativeLine);
-			}
+			CodeText.AddLine(RecordLine);
 		}
-		else
+		if (!RecordLines.Num())
 		{
-			CodeText.AddLine(TEXT("FBlueprintDependencyObjectRef()"));
+			CodeText.AddLine(TEXT("{}"));
 		}
-
+		CodeText.DecreaseIndent();
 		CodeText.AddLine(TEXT("};"));
 		CodeText.DecreaseIndent();
 		CodeText.AddLine(TEXT("}"));
 
-		CodeText.AddLine(TEXT("const FBlueprintDependencyObjectRef& F__NativeDependencies::Get(int16 Index)"));
+		CodeText.AddLine(TEXT("const FBlueprintDependencyObjectRef& F__NativeDependencies::Get(int32 Index)"));
 		CodeText.AddLine(TEXT("{"));
+		CodeText.IncreaseIndent();
 		CodeText.AddLine(TEXT("static const FBlueprintDependencyObjectRef& NullObjectRef = FBlueprintDependencyObjectRef();"));
 		CodeText.AddLine(TEXT("if (Index == -1) { return NullObjectRef; }"));
-		CodeText.AddLine(FString::Printf(TEXT("\tcheck((Index >= 0) && (Index < %d));"), DependenciesArray.Num()));
-		CodeText.AddLine(TEXT("\treturn ::NativizedCodeDependenties[Index];"));
+		CodeText.AddLine(FString::Printf(TEXT("check((Index >= 0) && (Index < %d));"), DependenciesArray.Num()));
+		// The object refs are built on the first use, instead of during the static initialization.
+		CodeText.AddLine(TEXT("static const TArray<FBlueprintDependencyObjectRef> ObjectRefs = []()"));
+		CodeText.AddLine(TEXT("{"));
+		CodeText.IncreaseIndent();
+		CodeText.AddLine(TEXT("TArray<FBlueprintDependencyObjectRef> Result;"));
+		CodeText.AddLine(FString::Printf(TEXT("Result.Reserve(%d);"), DependenciesArray.Num()));
+		CodeText.AddLine(FString::Printf(TEXT("for (int32 RecordIndex = 0; RecordIndex < %d; ++RecordIndex)"), DependenciesArray.Num()));
+		CodeText.AddLine(TEXT("{"));
+		CodeText.IncreaseIndent();
+		CodeText.AddLine(TEXT("const int32* Strings = ::NativizedCodeDependencyRecords[RecordIndex].Strings;"));
+		CodeText.AddLine(TEXT("Result.Emplace(::NativizedCodeDependencyStrings[Strings[0]], ::NativizedCodeDependencyStrings[Strings[1]], ::NativizedCodeDependencyStrings[Strings[2]]"));
+		CodeText.AddLine(TEXT("\t, ::NativizedCodeDependencyStrings[Strings[3]], ::NativizedCodeDependencyStrings[Strings[4]], ::NativizedCodeDependencyStrings[Strings[5]]);"));
+		CodeText.DecreaseIndent();
+		CodeText.AddLine(TEXT("}"));
+		CodeText.AddLine(TEXT("return Result;"));
+		CodeText.DecreaseIndent();
+		CodeText.AddLine(TEXT("}();"));
+		CodeText.AddLine(TEXT("return ObjectRefs[Index];"));
+		CodeText.DecreaseIndent();
 		CodeText.AddLine(TEXT("};"));
+
+		CodeText.AddLine(TEXT("UObject* F__NativeDependencies::Resolve(int32 Index)"));
+		CodeText.AddLine(TEXT("{"));
+		CodeText.IncreaseIndent();
+		CodeText.AddLine(TEXT("const FBlueprintDependencyObjectRef& ObjectRef = Get(Index);"));
+		CodeText.AddLine(TEXT("if (ObjectRef.ObjectName == NAME_None) { return nullptr; }"));
+		CodeText.AddLine(TEXT("const FString ObjectPath = (ObjectRef.OuterName == NAME_None)"));
+		CodeText.AddLine(TEXT("\t? FString::Printf(TEXT(\"%s.%s\"), *ObjectRef.PackageName.ToString(), *ObjectRef.ObjectName.ToString())"));
+		CodeText.AddLine(TEXT("\t: FString::Printf(TEXT(\"%s.%s:%s\"), *ObjectRef.PackageName.ToString(), *ObjectRef.OuterName.ToString(), *ObjectRef.ObjectName.ToString());"));
+		CodeText.AddLine(TEXT("return LoadObject<UObject>(nullptr, *ObjectPath);"));
+		CodeText.DecreaseIndent();
+		CodeText.AddLine(TEXT("}"));
+	}
+	return CodeText.MoveToString();
+}
+
+// Records of the code emitted by this thread are deferred while it's set, see FDependenciesGlobalMapHelper::DeferRecords
+static thread_local FDeferredDependencyRecords* DeferredDependencyRecords = nullptr;
+// A deferred index is written as the prefix followed by the position of the record in FDeferredDependencyRecords::Records
+static const TCHAR DeferredRecordIndexPrefix[] = TEXT("__DEFERRED_DEPENDENCY_INDEX_");
+
+FString FDependenciesGlobalMapHelper::EmitRecordIndex(const UObject* Object, TFunctionRef<TArray<FString>()> CreateObjectRefStrings)
+{
+	const FSoftObjectPath Key(Object);
+	if (FDeferredDependencyRecords* Records = DeferredDependencyRecords)
+	{
+		int32* RecordIndex = Records->RecordIndices.Find(Key);
+		if (!RecordIndex)
+		{
+			RecordIndex = &Records->RecordIndices.Add(Key, Records->Records.Emplace(Key, CreateObjectRefStrings()));
+		}
+		return FString::Printf(TEXT("%s%d"), DeferredRecordIndexPrefix, *RecordIndex);
+	}
+
+	FNativizationSummary& NativizationSummary = GetNativizationSummary();
+	FScopeLock Lock(&NativizationSummary.CriticalSection);
+	FNativizationSummary::FDependencyRecord& DependencyRecord = FindDependencyRecord(NativizationSummary, Key);
+	ensure(DependencyRecord.Index >= 0);
+	if (DependencyRecord.ObjectRefStrings.IsEmpty())
+	{
+		DependencyRecord.ObjectRefStrings = CreateObjectRefStrings();
+	}
+	return FString::FromInt(DependencyRecord.Index);
+}
+
+void FDependenciesGlobalMapHelper::DeferRecords(FDeferredDependencyRecords* Records)
+{
+	DeferredDependencyRecords = Records;
+}
+
+void FDependenciesGlobalMapHelper::ResolveDeferredRecords(const FDeferredDependencyRecords& Records, FString& InOutSource)
+{
+	check(IsInGameThread());
+	if (!Records.Records.Num())
+	{
+		return;
+	}
+
+	// Same order as the code would have been emitted in, so the indices match a conversion on the game thread.
+	TArray<int32> FinalIndices;
+	FinalIndices.Reserve(Records.Records.Num());
+	{
+		FNativizationSummary& NativizationSummary = GetNativizationSummary();
+		FScopeLock Lock(&NativizationSummary.CriticalSection);
+		for (const TPair<FSoftObjectPath, TArray<FString>>& Record : Records.Records)
+		{
+			FNativizationSummary::FDependencyRecord& DependencyRecord = FindDependencyRecord(NativizationSummary, Record.Key);
+			if (DependencyRecord.ObjectRefStrings.IsEmpty())
+			{
+				DependencyRecord.ObjectRefStrings = Record.Value;
+			}
+			FinalIndices.Add(DependencyRecord.Index);
+		}
+	}
+
+	const int32 PrefixLen = UE_ARRAY_COUNT(DeferredRecordIndexPrefix) - 1;
+	FString Result;
+	Result.Reserve(InOutSource.Len());
+	int32 CopiedLen = 0;
+	for (int32 PrefixStart = InOutSource.Find(DeferredRecordIndexPrefix, ESearchCase::CaseSensitive); PrefixStart != INDEX_NONE;
+		PrefixStart = InOutSource.Find(DeferredRecordIndexPrefix, ESearchCase::CaseSensitive, ESearchDir::FromStart, PrefixStart + PrefixLen))
+	{
+		int32 DigitsEnd = PrefixStart + PrefixLen;
+		while (DigitsEnd < InOutSource.Len() && FChar::IsDigit(InOutSource[DigitsEnd]))
+		{
+			++DigitsEnd;
+		}
+		const int32 RecordIndex = FCString::Atoi(*InOutSource.Mid(PrefixStart + PrefixLen, DigitsEnd - PrefixStart - PrefixLen));
+		if (!ensure(FinalIndices.IsValidIndex(RecordIndex)))
+		{
+			continue;
+		}
+		Result.AppendChars(*InOutSource + CopiedLen, PrefixStart - CopiedLen);
+		Result.AppendInt(FinalIndices[RecordIndex]);
+		CopiedLen = DigitsEnd;
+	}
+	if (CopiedLen > 0)
+	{
+		Result.AppendChars(*InOutSource + CopiedLen, InOutSource.Len() - CopiedLen);
+		InOutSource = MoveTemp(Result);
 	}
-	return CodeText.Result;
 }
 
-FNativizationSummary::FDependencyRecord& FDependenciesGlobalMapHelper::FindDependencyRecord(const FSoftObjectPath& Key)
+FNativizationSummary::FDependencyRecord& FDependenciesGlobalMapHelper::FindDependencyRecord(FNativizationSummary& NativizationSummary, const FSoftObjectPath& Key)
 {
-	auto& DependenciesGlobalMap = GetDependenciesGlobalMap();
+	auto& DependenciesGlobalMap = NativizationSummary.DependenciesGlobalMap;
 	FNativizationSummary::FDependencyRecord& DependencyRecord = DependenciesGlobalMap.FindOrAdd(Key);
 	if (DependencyRecord.Index == -1)
 	{
@@ -2691,12 +3008,12 @@ FNativizationSummary::FDependencyRecord& FDependenciesGlobalMapHelper::FindDepen
 	return DependencyRecord;
 }
 
-TMap<FSoftObjectPath, FNativizationSummary::FDependencyRecord>& FDependenciesGlobalMapHelper::GetDependenciesGlobalMap()
+FNativizationSummary& FDependenciesGlobalMapHelper::GetNativizationSummary()
 {
 	IBlueprintCompilerCppBackendModule& BackEndModule = (IBlueprintCompilerCppBackendModule&)IBlueprintCompilerCppBackendModule::Get();
 	TSharedPtr<FNativizationSummary> NativizationSummary = BackEndModule.NativizationSummary();
 	check(NativizationSummary.IsValid());
-	return NativizationSummary->DependenciesGlobalMap;
+	return *NativizationSummary;
 }
 
 FDisableUnwantedWarningOnScope::FDisableUnwantedWarningOnScope(FCodeText& InCodeText)
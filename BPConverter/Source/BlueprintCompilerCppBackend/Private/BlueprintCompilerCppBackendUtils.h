@@ -16,6 +16,7 @@ class USCS_Node;
 class UUserDefinedEnum;
 class UUserDefinedStruct;
 struct FDefaultSubobjectData;
+struct FBPTerminal;
 struct FNonNativeComponentData;
 enum class ENativizedTermUsage : uint8;
 struct FEmitterLocalContext;
@@ -34,25 +35,50 @@ namespace EExportedDeclaration
 	};
 }
 
+/**
+ * Append-only code buffer. Lines are appended to chunks of bounded size, so 
+ * large files don't reallocate (and copy) the whole text as it grows. Code
+ * that is only known at the end (e.g. includes gathered while emitting) goes
+ * to named slots, reserved with AddSlot() and filled with FillSlot().
+ */
 struct FCodeText
 {
-	FString Indent;
-	FString Result;
+private:
+	// Once a chunk reaches this length (in characters), a new chunk is started.
+	static constexpr int32 MaxChunkLen = 64 * 1024;
 
+	TArray<FString> Chunks;
+	TArray<TPair<FName, int32>> Slots;
+	int32 IndentLevel = 0;
+	// False after a slot was added, so the next line doesn't go into the slot's chunk.
+	bool bCanAppendToLastChunk = false;
+
+public:
 	void IncreaseIndent()
 	{
-		Indent += TEXT("\t");
+		++IndentLevel;
 	}
 
 	void DecreaseIndent()
 	{
-		Indent.RemoveFromEnd(TEXT("\t"));
+		IndentLevel = FMath::Max(IndentLevel - 1, 0);
 	}
 
-	void AddLine(const FString& Line)
-	{
-		Result += FString::Printf(TEXT("%s%s\n"), *Indent, *Line);
-	}
+	void AddLine(const FString& Line);
+
+	/** Reserves a place for code, that will be given later with FillSlot(). */
+	void AddSlot(FName SlotName);
+
+	/** Puts the code (indented as it is) into the slot. A slot can be filled once. */
+	void FillSlot(FName SlotName, FCodeText&& SlotCode);
+
+	/** @return The length (in characters) of the code. */
+	int32 Len() const;
+
+	FString ToString() const;
+
+	/** Same as ToString(), but the code text is left empty. */
+	FString MoveToString();
 };
 
 /** 
@@ -75,6 +101,71 @@ private:
 	TArray<const FProperty*> LocalAccessorDecls;
 };
 
+/**
+ * Array of objects with a hashed index, so lookups don't scan the whole list. The insertion order is kept,
+ * since the generated code refers to the objects by their index.
+ */
+template<typename ObjectType>
+struct TIndexedObjectArray
+{
+private:
+	TArray<ObjectType*> Objects;
+	// Index of the first occurrence of each object
+	TMap<const UObject*, int32> Indices;
+
+public:
+	int32 Add(ObjectType* Object)
+	{
+		const int32 Index = Objects.Add(Object);
+		if (!Indices.Contains(Object))
+		{
+			Indices.Add(Object, Index);
+		}
+		return Index;
+	}
+
+	int32 AddUnique(ObjectType* Object)
+	{
+		const int32* IndexPtr = Indices.Find(Object);
+		return IndexPtr ? *IndexPtr : Add(Object);
+	}
+
+	int32 IndexOfByKey(const UObject* Object) const
+	{
+		const int32* IndexPtr = Indices.Find(Object);
+		return IndexPtr ? *IndexPtr : INDEX_NONE;
+	}
+
+	bool Contains(const UObject* Object) const
+	{
+		return Indices.Contains(Object);
+	}
+
+	int32 Num() const
+	{
+		return Objects.Num();
+	}
+
+	ObjectType* operator[](int32 Index) const
+	{
+		return Objects[Index];
+	}
+
+	const TArray<ObjectType*>& GetArray() const
+	{
+		return Objects;
+	}
+
+	void Empty()
+	{
+		Objects.Empty();
+		Indices.Empty();
+	}
+
+	auto begin() const { return Objects.begin(); }
+	auto end() const { return Objects.end(); }
+};
+
 struct FEmitterLocalContext
 {
 	enum class EClassSubobjectList
@@ -95,8 +186,8 @@ struct FEmitterLocalContext
 	EGeneratedCodeType CurrentCodeType;
 
 	// List od assets directly used in class implementation.
-	TArray<const UObject*> UsedObjectInCurrentClass; 
-	TArray<const UUserDefinedEnum*> EnumsInCurrentClass;
+	TIndexedObjectArray<const UObject> UsedObjectInCurrentClass; 
+	TIndexedObjectArray<const UUserDefinedEnum> EnumsInCurrentClass;
 
 	// Nativized UDS doesn't reference its default value dependencies. When ::GetDefaultValue is used, then we need to reference the dependencies in the class.
 	TArray<UUserDefinedStruct*> StructsWithDefaultValuesUsed;
@@ -116,16 +207,19 @@ struct FEmitterLocalContext
 	TSet<UField*> UsedUnconvertedWrapper;
 
 	// Objects like UChildActorComponent::ChildActorTemplate. They will be stored at the beginning of MiscConvertedSubobjects.
-	TArray<UObject*> TemplateFromSubobjectsOfClass;
+	TIndexedObjectArray<UObject> TemplateFromSubobjectsOfClass;
 
 	// Class subobjects
-	TArray<UObject*> MiscConvertedSubobjects;
-	TArray<UObject*> DynamicBindingObjects;
-	TArray<UObject*> ComponentTemplates;
-	TArray<UObject*> Timelines;
+	TIndexedObjectArray<UObject> MiscConvertedSubobjects;
+	TIndexedObjectArray<UObject> DynamicBindingObjects;
+	TIndexedObjectArray<UObject> ComponentTemplates;
+	TIndexedObjectArray<UObject> Timelines;
 private:
 	int32 LocalNameIndexMax;
 
+	// Objects without any asset (of Dependencies.Assets) in their outer chain, so the chain is walked only once
+	TSet<const UObject*> ObjectsOutsideOfAssets;
+
 public:
 
 	FCodeText Header;
@@ -150,6 +244,12 @@ public:
 	// Call this functions to make sure the wrapper (necessary for the given field) will be included and generated.
 	void MarkUnconvertedClassAsNecessary(UField* InField);
 
+	// Literal terms of the current function body, emitted once as function-static constants
+	TMap<const FBPTerminal*, FString> LiteralConstants;
+
+	// Pure calls used more than once by the current statement, evaluated once into these locals
+	TMap<const FBPTerminal*, FString> CommonSubexpressions;
+
 	// PROPERTIES FOR INACCESSIBLE MEMBER VARIABLES
 	TMap<const FProperty*, FString> PropertiesForInaccessibleStructs;
 	void ResetPropertiesForInaccessibleStructs()
@@ -283,8 +383,12 @@ private:
 struct FEmitHelper
 {
 	// bUInterface - use interface with "U" prefix, by default there is "I" prefix
+	// The names are cached for the session, see ClearCppNameCache
 	static FString GetCppName(FFieldVariant Field, bool bUInterface = false, bool bForceParameterNameModification = false);
 
+	// Must be called when fields may be renamed, recompiled or destroyed
+	static void ClearCppNameCache();
+
 	// returns an unique number for a structure in structures hierarchy
 	static int32 GetInheritenceLevel(const UStruct* Struct);
 
@@ -485,13 +589,24 @@ struct FNativizationSummaryHelper
 };
 struct FDependenciesGlobalMapHelper
 {
+	// Number of FDependencyRecord::ObjectRefStrings
+	static constexpr int32 NumObjectRefStrings = 6;
+
 	static FString EmitHeaderCode();
 	static FString EmitBodyCode(const FString& PCHFilename);
 
-	static FNativizationSummary::FDependencyRecord& FindDependencyRecord(const FSoftObjectPath& Key);
+	// Returns the index of the object's record (added if needed, and filled by CreateObjectRefStrings), as it is written in the generated code.
+	// While the records are deferred on the calling thread (see DeferRecords), it's a placeholder that ResolveDeferredRecords replaces.
+	static FString EmitRecordIndex(const UObject* Object, TFunctionRef<TArray<FString>()> CreateObjectRefStrings);
+
+	static void DeferRecords(FDeferredDependencyRecords* Records);
+	static void ResolveDeferredRecords(const FDeferredDependencyRecords& Records, FString& InOutSource);
 
 private:
-	static TMap<FSoftObjectPath, FNativizationSummary::FDependencyRecord>& GetDependenciesGlobalMap();
+	// The summary must be locked
+	static FNativizationSummary::FDependencyRecord& FindDependencyRecord(FNativizationSummary& NativizationSummary, const FSoftObjectPath& Key);
+
+	static FNativizationSummary& GetNativizationSummary();
 };
 
 struct FDisableUnwantedWarningOnScope
@@ -63,7 +63,7 @@ struct FBlueprintDependencyType
 
 struct  FCompactBlueprintDependencyData
 {
-	int16 ObjectRefIndex;
+	int32 ObjectRefIndex;
 	FBlueprintDependencyType StructDependency;
 	FBlueprintDependencyType CDODependency;
 
@@ -72,7 +72,7 @@ struct  FCompactBlueprintDependencyData
 	{
 	}
 
-	FCompactBlueprintDependencyData(int16 InObjectRefIndex
+	FCompactBlueprintDependencyData(int32 InObjectRefIndex
 		, FBlueprintDependencyType InStructDependency
 		, FBlueprintDependencyType InCDODependency = FBlueprintDependencyType())
 		: ObjectRefIndex(InObjectRefIndex)
@@ -1444,7 +1444,11 @@ struct FFakeImportTableHelper
 						SerializeBeforeSerializeStructDependencies.Add(ImplementedInterface.Class);
 					}
 
-					SerializeBeforeCreateCDODependencies.Add(Class->GetSuperClass()->GetDefaultObject());
+					// The code can be emitted on a worker thread, where no CDO can be created. A CDO that doesn't exist is no dependency anyway.
+					if (UObject* SuperCDO = Class->GetSuperClass()->GetDefaultObject(false))
+					{
+						SerializeBeforeCreateCDODependencies.Add(SuperCDO);
+					}
 				}
 			};
 
@@ -1464,13 +1468,17 @@ struct FFakeImportTableHelper
 					{
 						UClass* SubobjectClass = Subobject->GetClass();
 						SerializeBeforeSerializeStructDependencies.Add(SubobjectClass);
-						SerializeBeforeCreateCDODependencies.Add(SubobjectClass->GetDefaultObject());
+						if (UObject* SubobjectCDO = SubobjectClass->GetDefaultObject(false))
+						{
+							SerializeBeforeCreateCDODependencies.Add(SubobjectCDO);
+						}
 
 						// This ensures that any nested asset dependencies will be serialized before attempting to instance a subobject that's a converted type when constructing the CDO.
 						if (UBlueprintGeneratedClass* SubobjectClassAsBPGC = Cast<UBlueprintGeneratedClass>(SubobjectClass))
 						{
 							if (Context.Dependencies.ConvertedClasses.Contains(SubobjectClassAsBPGC))
 							{
+								// Cached by CacheDependenciesForEmission, with the other converted classes
 								TSharedPtr<FGatherConvertedClassDependencies> SubobjectClassDependencies = FGatherConvertedClassDependencies::Get(SubobjectClassAsBPGC, Context.Dependencies.NativizationOptions);
 								
 								SerializeBeforeCreateCDODependencies.Append(SubobjectClassDependencies->Assets);
@@ -1536,7 +1544,7 @@ void FEmitDefaultValueHelper::AddStaticFunctionsForDependencies(FEmitterLocalCon
 	const FString CppTypeName = FEmitHelper::GetCppName(SourceStruct);
 	FFakeImportTableHelper FakeImportTableHelper(SourceStruct, OriginalClass, Context);
 
-	auto CreateAssetToLoadString = [&Context](const UObject* AssetObj) -> FString
+	auto CreateObjectRefStrings = [&Context](const UObject* AssetObj) -> TArray<FString>
 	{
 		UClass* AssetType = AssetObj->GetClass();
 		if (AssetType->IsChildOf<UUserDefinedEnum>())
@@ -1561,56 +1569,67 @@ void FEmitDefaultValueHelper::AddStaticFunctionsForDependencies(FEmitterLocalCon
 		}
 
 		const FString LongPackagePath = FPackageName::GetLongPackagePath(AssetObj->GetOutermost()->GetPathName());
-		return FString::Printf(TEXT("FBlueprintDependencyObjectRef(TEXT(\"%s\"), TEXT(\"%s\"), TEXT(\"%s\"), TEXT(\"%s\"), TEXT(\"%s\"), TEXT(\"%s\")),")
-			, *LongPackagePath
-			, *FPackageName::GetShortName(AssetObj->GetOutermost()->GetPathName())
-			, *AssetObj->GetName()
-			, *AssetType->GetOutermost()->GetPathName()
-			, *AssetType->GetName()
-			, *OuterName);
+		return TArray<FString>
+		{
+			LongPackagePath,
+			FPackageName::GetShortName(AssetObj->GetOutermost()->GetPathName()),
+			AssetObj->GetName(),
+			AssetType->GetOutermost()->GetPathName(),
+			AssetType->GetName(),
+			OuterName
+		};
 	};
 	
-	auto CreateDependencyRecord = [&NativizationOptions, &FakeImportTableHelper, &CppTypeName, OriginalClass, &CreateAssetToLoadString, bEnableBootTimeEDLOptimization](const UObject* InAsset, FString& OptionalComment) -> FCompactBlueprintDependencyData
+	// Returns why the asset is not loaded on the target platform, or null if it is.
+	auto FindExclusionReason = [&NativizationOptions](const UObject* InAsset) -> const TCHAR*
+	{
+		if (InAsset && IsEditorOnlyObject(InAsset))
 		{
-			ensure(InAsset);
-			if (InAsset && IsEditorOnlyObject(InAsset))
-			{
-				UE_LOG(LogK2Compiler, Warning, TEXT("Nativized %s depends on editor only asset: %s")
-					, (OriginalClass ? *OriginalClass->GetPathName() : *CppTypeName)
-					, *InAsset->GetPathName());
-				OptionalComment = TEXT("Editor Only asset");
-				return FCompactBlueprintDependencyData{};
-			}
+			return TEXT("Editor Only asset");
+		}
 
+		bool bNotForClient = false;
+		bool bNotForServer = false;
+		for (const UObject* Search = InAsset; Search && !Search->IsA(UPackage::StaticClass()); Search = Search->GetOuter())
+		{
+			bNotForClient = bNotForClient || !Search->NeedsLoadForClient();
+			bNotForServer = bNotForServer || !Search->NeedsLoadForServer();
+		}
+		if (bNotForServer && NativizationOptions.ServerOnlyPlatform)
+		{
+			return TEXT("Not for server");
+		}
+		if (bNotForClient && NativizationOptions.ClientOnlyPlatform)
+		{
+			return TEXT("Not for client");
+		}
+		return nullptr;
+	};
+
+	// The index of the asset in the global dependency map, as it is written in the generated code (see FDependenciesGlobalMapHelper::EmitRecordIndex).
+	auto EmitObjectRefIndex = [&CreateObjectRefStrings](const UObject* InAsset) -> FString
+	{
+		return FDependenciesGlobalMapHelper::EmitRecordIndex(InAsset, [&CreateObjectRefStrings, InAsset]() { return CreateObjectRefStrings(InAsset); });
+	};
+	
+	auto CreateDependencyRecord = [&FakeImportTableHelper, &CppTypeName, OriginalClass, &FindExclusionReason, &EmitObjectRefIndex](const UObject* InAsset, FString& OutObjectRefIndex, FString& OptionalComment) -> FCompactBlueprintDependencyData
+		{
+			ensure(InAsset);
+			if (const TCHAR* ExclusionReason = FindExclusionReason(InAsset))
 			{
-				bool bNotForClient = false;
-				bool bNotForServer = false;
-				for (const UObject* Search = InAsset; Search && !Search->IsA(UPackage::StaticClass()); Search = Search->GetOuter())
+				if (InAsset && IsEditorOnlyObject(InAsset))
 				{
-					bNotForClient = bNotForClient || !Search->NeedsLoadForClient();
-					bNotForServer = bNotForServer || !Search->NeedsLoadForServer();
-				}
-				if (bNotForServer && NativizationOptions.ServerOnlyPlatform)
-				{
-					OptionalComment = TEXT("Not for server");
-					return FCompactBlueprintDependencyData{};
-				}
-				if (bNotForClient && NativizationOptions.ClientOnlyPlatform)
-				{
-					OptionalComment = TEXT("Not for client");
-					return FCompactBlueprintDependencyData{};
+					UE_LOG(LogK2Compiler, Warning, TEXT("Nativized %s depends on editor only asset: %s")
+						, (OriginalClass ? *OriginalClass->GetPathName() : *CppTypeName)
+						, *InAsset->GetPathName());
 				}
+				OptionalComment = ExclusionReason;
+				OutObjectRefIndex = FString::FromInt(INDEX_NONE);
+				return FCompactBlueprintDependencyData{};
 			}
 
-		FNativizationSummary::FDependencyRecord& DependencyRecord = FDependenciesGlobalMapHelper::FindDependencyRecord(InAsset);
-		ensure(DependencyRecord.Index >= 0);
-		if (DependencyRecord.NativeLine.IsEmpty())
-		{
-			DependencyRecord.NativeLine = CreateAssetToLoadString(InAsset);
-		}
-
 		FCompactBlueprintDependencyData Result;
-		Result.ObjectRefIndex = static_cast<int16>(DependencyRecord.Index);
+		OutObjectRefIndex = EmitObjectRefIndex(InAsset);
 		FakeImportTableHelper.FillDependencyData(InAsset, Result);
 		return Result;
 	};
@@ -1635,13 +1654,14 @@ void FEmitDefaultValueHelper::AddStaticFunctionsForDependencies(FEmitterLocalCon
 
 		for (const UObject* LocAsset : Assets)
 		{
+			FString ObjectRefIndex;
 			FString OptionalComment;
-			const FCompactBlueprintDependencyData DependencyRecord = CreateDependencyRecord(LocAsset, OptionalComment);
+			const FCompactBlueprintDependencyData DependencyRecord = CreateDependencyRecord(LocAsset, ObjectRefIndex, OptionalComment);
 
 			if (SourceStruct->IsA<UClass>())
 			{
-				Context.AddLine(FString::Printf(TEXT("{%d, %s, %s},  // %s %s ")
-					, DependencyRecord.ObjectRefIndex
+				Context.AddLine(FString::Printf(TEXT("{%s, %s, %s},  // %s %s ")
+					, *ObjectRefIndex
 					, *BlueprintDependencyTypeToString(DependencyRecord.StructDependency)
 					, *BlueprintDependencyTypeToString(DependencyRecord.CDODependency)
 					, *OptionalComment
@@ -1649,8 +1669,8 @@ void FEmitDefaultValueHelper::AddStaticFunctionsForDependencies(FEmitterLocalCon
 			}
 			else
 			{
-				Context.AddLine(FString::Printf(TEXT("{%d, %s},  // %s %s ")
-					, DependencyRecord.ObjectRefIndex
+				Context.AddLine(FString::Printf(TEXT("{%s, %s},  // %s %s ")
+					, *ObjectRefIndex
 					, *BlueprintDependencyTypeToString(DependencyRecord.StructDependency)
 					, *OptionalComment
 					, *LocAsset->GetFullName()));
@@ -1687,7 +1707,7 @@ void FEmitDefaultValueHelper::AddStaticFunctionsForDependencies(FEmitterLocalCon
 	TSet<const UObject*> AllDependenciesToHandle = Context.Dependencies.AllDependencies();
 	{
 		// Append used objects.
-		AllDependenciesToHandle.Append(Context.UsedObjectInCurrentClass);
+		AllDependenciesToHandle.Append(Context.UsedObjectInCurrentClass.GetArray());
 
 		// Remove invalid dependencies.
 		AllDependenciesToHandle.Remove(nullptr);
@@ -1763,6 +1783,57 @@ void FEmitDefaultValueHelper::AddStaticFunctionsForDependencies(FEmitterLocalCon
 
 		Context.DecreaseIndent();
 		Context.AddLine(TEXT("}"));
+
+		// The table indexed by the generated code (see FEmitterLocalContext::FindGloballyMappedObject), in the order of UsedObjectInCurrentClass.
+		// It cannot be filled while the class is registered, the assets are resolved from their dependency records on the first use.
+		const int32 NumUsedAssets = Context.UsedObjectInCurrentClass.Num();
+		Context.AddLine(FString::Printf(TEXT("TObjectPtr<UObject> %s::__UsedAssetsTable[%d] = {};"), *CppTypeName, FMath::Max(NumUsedAssets, 1)));
+		Context.AddLine(FString::Printf(TEXT("const TObjectPtr<UObject>* %s::__UsedAssets()"), *CppTypeName));
+		Context.AddLine(TEXT("{"));
+		Context.IncreaseIndent();
+		if (NumUsedAssets)
+		{
+			FString ObjectRefIndices;
+			for (const UObject* LocAsset : Context.UsedObjectInCurrentClass)
+			{
+				const FString ObjectRefIndex = FindExclusionReason(LocAsset) ? FString::FromInt(INDEX_NONE) : EmitObjectRefIndex(LocAsset);
+				ObjectRefIndices += FString::Printf(TEXT("%s%s"), ObjectRefIndices.IsEmpty() ? TEXT("") : TEXT(", "), *ObjectRefIndex);
+			}
+			Context.AddLine(TEXT("static const bool bResolved = []()"));
+			Context.AddLine(TEXT("{"));
+			Context.IncreaseIndent();
+			Context.AddLine(FString::Printf(TEXT("static const int32 ObjectRefIndices[] = { %s };"), *ObjectRefIndices));
+			Context.AddLine(TEXT("for (int32 AssetIndex = 0; AssetIndex < UE_ARRAY_COUNT(ObjectRefIndices); ++AssetIndex)"));
+			Context.AddLine(TEXT("{"));
+			Context.AddLine(TEXT("\t__UsedAssetsTable[AssetIndex] = F__NativeDependencies::Resolve(ObjectRefIndices[AssetIndex]);"));
+			Context.AddLine(TEXT("}"));
+			Context.AddLine(TEXT("return true;"));
+			Context.DecreaseIndent();
+			Context.AddLine(TEXT("}();"));
+		}
+		Context.AddLine(TEXT("return __UsedAssetsTable;"));
+		Context.DecreaseIndent();
+		Context.AddLine(TEXT("}"));
+
+		// The class default object keeps the table alive, like UDynamicClass::UsedAssets did for the class.
+		Context.AddLine(FString::Printf(TEXT("void %s::AddReferencedObjects(UObject* InThis, FReferenceCollector& Collector)"), *CppTypeName));
+		Context.AddLine(TEXT("{"));
+		Context.IncreaseIndent();
+		Context.AddLine(TEXT("Super::AddReferencedObjects(InThis, Collector);"));
+		if (NumUsedAssets)
+		{
+			Context.AddLine(FString::Printf(TEXT("if (InThis == %s::StaticClass()->GetDefaultObject(false))"), *CppTypeName));
+			Context.AddLine(TEXT("{"));
+			Context.IncreaseIndent();
+			Context.AddLine(TEXT("for (TObjectPtr<UObject>& UsedAsset : __UsedAssetsTable)"));
+			Context.AddLine(TEXT("{"));
+			Context.AddLine(TEXT("\tCollector.AddReferencedObject(UsedAsset, InThis);"));
+			Context.AddLine(TEXT("}"));
+			Context.DecreaseIndent();
+			Context.AddLine(TEXT("}"));
+		}
+		Context.DecreaseIndent();
+		Context.AddLine(TEXT("}"));
 	}
 
 	// 4. REMAINING DEPENDENCIES
@@ -1782,13 +1853,7 @@ void FEmitDefaultValueHelper::AddStaticFunctionsForDependencies(FEmitterLocalCon
 			else
 			{
 				// To reduce the size of __StaticDependenciesAssets, all __StaticDependenciesAssets of listed BPs will be called.
-				FNativizationSummary::FDependencyRecord& DependencyRecord = FDependenciesGlobalMapHelper::FindDependencyRecord(OriginalClass);
-				ensure(DependencyRecord.Index >= 0);
-				if (DependencyRecord.NativeLine.IsEmpty())
-				{
-					DependencyRecord.NativeLine = CreateAssetToLoadString(OriginalClass);
-				}
-				Context.AddLine(FString::Printf(TEXT("const int16 __OwnIndex = %d;"), DependencyRecord.Index));
+				Context.AddLine(FString::Printf(TEXT("const int32 __OwnIndex = %s;"), *EmitObjectRefIndex(OriginalClass)));
 				Context.AddLine(FString(TEXT("if(FBlueprintDependencyData::ContainsDependencyData(AssetsToLoad, __OwnIndex)) { return; }")));
 				Context.AddLine(TEXT("if(GEventDrivenLoaderEnabled && EVENT_DRIVEN_ASYNC_LOAD_ACTIVE_AT_RUNTIME){ __StaticDependencies_DirectlyUsedAssets(AssetsToLoad); }"));
 				Context.AddLine(TEXT("else"));
@@ -1961,8 +2026,6 @@ void FEmitDefaultValueHelper::GenerateCustomDynamicClassInitialization(FEmitterL
 			});
 		}
 
-		Context.AddLine(TEXT("FConvertedBlueprintsDependencies::FillUsedAssetsInDynamicClass(InDynamicClass, &__StaticDependencies_DirectlyUsedAssets);"));
-
 		ensure(0 == Context.MiscConvertedSubobjects.Num());
 		for (UObject* LocalTemplate : Context.TemplateFromSubobjectsOfClass)
 		{
@@ -2025,6 +2088,7 @@ void FEmitDefaultValueHelper::GenerateCustomDynamicClassInitialization(FEmitterL
 
 void FEmitDefaultValueHelper::GenerateConstructor(FEmitterLocalContext& Context)
 {
+	BP_CONVERTER_PHASE_SCOPE(GenerateConstructor);
 	UBlueprintGeneratedClass* BPGC = CastChecked<UBlueprintGeneratedClass>(Context.GetCurrentlyGeneratedClass());
 	const FString CppClassName = FEmitHelper::GetCppName(BPGC);
 
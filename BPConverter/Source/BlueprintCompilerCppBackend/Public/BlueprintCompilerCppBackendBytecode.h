@@ -0,0 +1,51 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "UObject/StrongObjectPtr.h"
+#include "Kismet2/CompilerResultsLog.h"
+
+class UBlueprintGeneratedClass;
+class UEdGraph;
+class UK2Node_FunctionEntry;
+struct FKismetFunctionContext;
+
+/**
+ * Alternate front end of the C++ backend. Instead of duplicating the Blueprint
+ * and recompiling it, the statements of every function are rebuilt from the
+ * bytecode of the already compiled class. Only a subset of the bytecode is
+ * understood (no ubergraph, latent actions, delegates, containers or struct
+ * literals). When anything else is found the translation fails, and the caller
+ * is expected to fall back to the Kismet compiler.
+ */
+class BLUEPRINTCOMPILERCPPBACKEND_API FBlueprintBytecodeTranslator
+{
+public:
+	explicit FBlueprintBytecodeTranslator(UBlueprintGeneratedClass* InSourceClass);
+
+	/**
+	 * Builds a function context for each function of the class. The contexts
+	 * reference data owned by the translator, so they must not outlive it.
+	 *
+	 * @return False when the class cannot be translated, see GetFailureReason().
+	 */
+	bool Translate(TIndirectArray<FKismetFunctionContext>& OutFunctions);
+
+	const FString& GetFailureReason() const { return FailureReason; }
+
+	/** Can be disabled with bDontTranslateBytecode in BlueprintNativizationSettings. */
+	static bool IsEnabled();
+
+private:
+	bool Fail(const FString& Reason);
+
+	UBlueprintGeneratedClass* SourceClass;
+	FCompilerResultsLog MessageLog;
+
+	// Statements are keyed by graph nodes. All statements of a function are owned by this single node.
+	TStrongObjectPtr<UEdGraph> StandInGraph;
+	UK2Node_FunctionEntry* StandInNode;
+
+	FString FailureReason;
+};
@@ -4,22 +4,33 @@
 
 #include "CoreMinimal.h"
 #include "UObject/SoftObjectPtr.h"
+#include "HAL/CriticalSection.h"
 #include "Engine/Blueprint.h"
 #include "BlueprintRetrived.h"
 
 class UBlueprintGeneratedClass;
 class UUserDefinedEnum;
 class UUserDefinedStruct;
+struct FIoHash;
 
 /** The struct gathers dependencies of a converted BPGC */
 struct BLUEPRINTCOMPILERCPPBACKEND_API FGatherConvertedClassDependencies
 {
 private:
-	static TMap<UStruct*, TSharedPtr<FGatherConvertedClassDependencies>> CachedConvertedClassDependencies;
+	// Struct and hash of the nativization options. The same struct can be gathered with different options (e.g. by the conversion hash and by the emitter), the entries must not evict each other.
+	typedef TPair<TWeakObjectPtr<UStruct>, uint32> FCacheKey;
+
+	// Keyed by a weak pointer, so entries of garbage collected structs (e.g. the temporary duplicates made for conversion) are never matched by a new struct reusing the address.
+	static TMap<FCacheKey, TSharedPtr<FGatherConvertedClassDependencies>> CachedConvertedClassDependencies;
+	// Guards the cache, classes can be emitted on several threads at once. It's held while dependencies are gathered, so a struct is never gathered twice.
+	static FCriticalSection CachedDependenciesCriticalSection;
 
 protected:
 	UStruct* OriginalStruct;
 
+	// Hash of NativizationOptions, part of the keys of the in-memory and the on-disk caches.
+	uint32 NativizationOptionsHash;
+
 public:
 	// Dependencies:
 	TSet<UObject*> Assets;
@@ -38,8 +49,23 @@ public:
 	FCompilerNativizationOptions NativizationOptions;
 
 public:
+	/** Gathering can create objects (e.g. CDOs), so a struct that is not cached yet can only be gathered on the game thread. */
 	static TSharedPtr<FGatherConvertedClassDependencies> Get(UStruct* InStruct, const FCompilerNativizationOptions& InNativizationOptions);
 
+	/**
+	 * Caches the dependencies of the class, of its parent class and of all the converted types it (transitively) depends on.
+	 * That's everything the emitter asks for, so the code of the class can then be emitted on a worker thread.
+	 */
+	static void CacheDependenciesForEmission(UStruct* InStruct, const FCompilerNativizationOptions& InNativizationOptions);
+
+	/** Drops the cached dependencies of the struct and of every cached struct that (transitively) depends on it. Call it when the struct is recompiled. */
+	static void InvalidateCachedDependencies(const UStruct* InStruct);
+
+	/** Drops cache entries whose struct was garbage collected. */
+	static void RemoveStaleCachedDependencies();
+
+	static void ClearCachedDependencies();
+
 	UStruct* GetActualStruct() const
 	{
 		return OriginalStruct;
@@ -60,6 +86,9 @@ public:
 
 	static bool IsFieldFromExcludedPackage(const UField* Field, const TSet<FName>& InExcludedModules);
 
+	/** Session independent hash of the options, safe to be stored on disk. */
+	static uint32 HashNativizationOptions(const FCompilerNativizationOptions& InNativizationOptions);
+
 private:
 	// Private token only allows members or friends to call MakeShared
 	struct FPrivateToken { explicit FPrivateToken() = default; };
@@ -68,5 +97,17 @@ public:
 	FGatherConvertedClassDependencies(FPrivateToken, UStruct* InStruct, const FCompilerNativizationOptions& InNativizationOptions);
 
 protected:
+	void GatherDependencies();
+
 	void DependenciesForHeader();
+
+private:
+	bool References(const UObject* Object) const;
+
+	// Optional on-disk cache (see bCacheGatheredDependenciesOnDisk), keyed by the saved hash of the struct's package.
+	// An entry also stores the saved hashes of the packages of the dependencies, it's outdated when any of them was saved since.
+	FString GetDiskCacheFilename() const;
+	bool GetDependencyPackageHashes(TArray<FString>& OutPackageNames, TArray<FIoHash>& OutSavedHashes) const;
+	bool LoadFromDiskCache();
+	void SaveToDiskCache() const;
 };
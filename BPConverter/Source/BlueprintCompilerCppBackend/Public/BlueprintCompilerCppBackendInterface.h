@@ -22,6 +22,10 @@ public:
 	// Generate a wrapper class, that helps accessing non-native properties and calling non-native functions
 	virtual FString GenerateWrapperForClass(UClass* SourceClass, const FCompilerNativizationOptions& NativizationOptions) = 0;
 
+	// Evaluates the pure calls with constant inputs, so they are emitted as constants. It runs UObject code, so it must be called on the game thread,
+	// then GenerateCodeFromClass can run on any thread. Calls that were not folded here are only folded when the code is generated on the game thread.
+	virtual void FoldConstantCalls(const TIndirectArray<FKismetFunctionContext>& Functions) = 0;
+
 	virtual ~IBlueprintCompilerCppBackend() {}
 };
 
@@ -4,6 +4,10 @@
 
 #include "CoreMinimal.h"
 #include "UObject/SoftObjectPath.h"
+#include "HAL/PlatformTime.h"
+#include "HAL/CriticalSection.h"
+#include "Misc/ScopeLock.h"
+#include "ProfilingDebugging/CpuProfilerTrace.h"
 #include "BlueprintCompilerCppBackendInterface.h"
 
 class UBlueprint;
@@ -31,10 +35,11 @@ struct FNativizationSummary
 
 	int32 MemberVariablesFromGraph;
 
-	// The NativeLine is stored and the key is String-Reference, so the object doesn't need to be loaded.
+	// The strings are stored and the key is String-Reference, so the object doesn't need to be loaded.
 	struct FDependencyRecord
 	{
-		FString NativeLine;
+		// Arguments of FBlueprintDependencyObjectRef: package path, package name, object name, class package, class name and outer name.
+		TArray<FString> ObjectRefStrings;
 		int32 Index;
 
 		FDependencyRecord() : Index(-1) {}
@@ -44,9 +49,28 @@ struct FNativizationSummary
 
 	TMap<FName, TSet<TSoftObjectPtr<UPackage>>> ModulesRequiredByPlatform;
 
+	// Time (in seconds) spent in each conversion phase, see BP_CONVERTER_PHASE_SCOPE. Nested phases are included in the outer ones.
+	TMap<FName, double> PhaseSeconds;
+
+	// Guards the summary, the code of several classes can be emitted at once (see FDeferredDependencyRecords).
+	FCriticalSection CriticalSection;
+
 	FNativizationSummary() : MemberVariablesFromGraph(0) {}
 };
 
+/**
+ * Global dependency records requested by the code of one class, while it is emitted on a worker thread.
+ * The generated code refers to them through placeholders. The records get their indices when 
+ * IBlueprintCompilerCppBackendModule::ResolveDeferredDependencies is called, on the game thread. So the 
+ * indices don't depend on the order in which worker threads emit the classes.
+ */
+struct FDeferredDependencyRecords
+{
+	// The requested objects and their FDependencyRecord::ObjectRefStrings, in the order of their first use.
+	TArray<TPair<FSoftObjectPath, TArray<FString>>> Records;
+	TMap<FSoftObjectPath, int32> RecordIndices;
+};
+
 /**
  * The public interface to this module
  */
@@ -105,5 +129,49 @@ public:
 
 	virtual FString DependenciesGlobalMapHeaderCode() = 0;
 	virtual FString DependenciesGlobalMapBodyCode(const FString& PCHFilename) = 0;
+
+	/**
+	 * Makes the code emitted by the calling thread refer to global dependency records through placeholders,
+	 * which are collected in the given records. Pass nullptr to stop. Used to emit several classes at once.
+	 */
+	virtual void DeferDependencyRecords(FDeferredDependencyRecords* Records) = 0;
+
+	/**
+	 * Adds the deferred records to the global dependency map (in the order they were requested), and replaces
+	 * their placeholders with the final indices. Call it on the game thread, for every class in a fixed order.
+	 */
+	virtual void ResolveDeferredDependencies(const FDeferredDependencyRecords& Records, FString& InOutSource) = 0;
+};
+
+/**
+ * Times a conversion phase, adding the time to FNativizationSummary::PhaseSeconds 
+ * of the summary that is currently set on the backend module (if any). Use it 
+ * through BP_CONVERTER_PHASE_SCOPE, so the phase also shows up in Unreal Insights.
+ */
+class FScopedNativizationPhase
+{
+public:
+	explicit FScopedNativizationPhase(const TCHAR* InPhaseName)
+		: PhaseName(InPhaseName)
+		, StartTime(FPlatformTime::Seconds())
+	{}
+
+	~FScopedNativizationPhase()
+	{
+		IBlueprintCompilerCppBackendModule& BackEndModule = (IBlueprintCompilerCppBackendModule&)IBlueprintCompilerCppBackendModule::Get();
+		TSharedPtr<FNativizationSummary> NativizationSummary = BackEndModule.NativizationSummary();
+		if (NativizationSummary.IsValid())
+		{
+			FScopeLock Lock(&NativizationSummary->CriticalSection);
+			NativizationSummary->PhaseSeconds.FindOrAdd(FName(PhaseName)) += FPlatformTime::Seconds() - StartTime;
+		}
+	}
+
+private:
+	const TCHAR* PhaseName;
+	double StartTime;
 };
 
+#define BP_CONVERTER_PHASE_SCOPE(PhaseName) \
+	TRACE_CPUPROFILER_EVENT_SCOPE(BPConverter_##PhaseName); \
+	FScopedNativizationPhase ANONYMOUS_VARIABLE(NativizationPhase)(TEXT(#PhaseName))
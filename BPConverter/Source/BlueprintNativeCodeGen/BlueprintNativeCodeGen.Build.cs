@@ -24,6 +24,7 @@ public class BlueprintNativeCodeGen : ModuleRules
                 "Slate",
                 "EditorStyle",
                 "KismetCompiler",
+                "BlueprintGraph",
                 "Json",
                 "JsonUtilities",
                 "BlueprintCompilerCppBackend",
@@ -32,14 +33,9 @@ public class BlueprintNativeCodeGen : ModuleRules
                 "Kismet",
                 "DesktopWidgets",
 				"ToolMenus",
-				"UMGEditor"
+				"UMGEditor",
+				"AssetRegistry"
             }
 		);
-
-        DynamicallyLoadedModuleNames.AddRange(
-			new string[] {
-				"AssetRegistry",
-			}
-		);
 	}
 }
@@ -0,0 +1,673 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "BPConvertCommandlet.h"
+#include "Misc/Paths.h"
+#include "Misc/FileHelper.h"
+#include "Misc/ScopeExit.h"
+#include "Misc/App.h"
+#include "Async/Async.h"
+#include "Async/ParallelFor.h"
+#include "Async/TaskGraphInterfaces.h"
+#include "HAL/PlatformMemory.h"
+#include "ProfilingDebugging/CountersTrace.h"
+#include "Modules/ModuleManager.h"
+#include "AssetRegistry/AssetRegistryModule.h"
+#include "AssetRegistry/IAssetRegistry.h"
+#include "Engine/Blueprint.h"
+#include "Engine/BlueprintGeneratedClass.h"
+#include "IBlueprintCompilerCppBackendModule.h"
+#include "NativeCodeGenerationTool.h"
+#include "BlueprintNativeCodeGenUtils.h"
+#include "BlueprintNativeCodeGenManifest.h"
+
+DEFINE_LOG_CATEGORY_STATIC(LogBPConvertCommandlet, Log, All);
+
+TRACE_DECLARE_INT_COUNTER(BPConverter_ConvertedAssets, TEXT("BPConverter/ConvertedAssets"));
+TRACE_DECLARE_INT_COUNTER(BPConverter_GeneratedLines, TEXT("BPConverter/GeneratedLines"));
+
+/*******************************************************************************
+ * BPConvertCommandletImpl
+ ******************************************************************************/
+
+namespace BPConvertCommandletImpl
+{
+	static const FString AssetsSwitch     = TEXT("Assets");
+	static const FString FoldersSwitch    = TEXT("Folders");
+	static const FString CollectionSwitch = TEXT("Collection");
+	static const FString OutputSwitch     = TEXT("Output");
+	static const FString PlatformSwitch   = TEXT("Platform");
+	static const FString IncrementalSwitch = TEXT("Incremental");
+	static const FString StatsCsvSwitch   = TEXT("StatsCsv");
+	static const FString PluginFileExt    = TEXT(".uplugin");
+	static const FString DefaultPluginName = TEXT("NativizedAssets");
+
+	/**
+	 * Splits a switch value into its entries. Both '+' and ',' are accepted as
+	 * delimiters, as '+' is the usual separator for list switches on the command line.
+	 */
+	static TArray<FString> ParseList(const FString& Value);
+
+	/**
+	 * Reads the object paths listed in a collection file. Works with the
+	 * editor's .collection files (header lines are skipped) and with plain
+	 * text files that list one path per line.
+	 */
+	static bool LoadCollectionFile(const FString& FilePath, TArray<FString>& OutObjectPaths);
+
+	/** Turns the -Output value into the plugin file path expected by the manifest. */
+	static FString ResolvePluginPath(const FString& OutputValue);
+
+	/**
+	 * Generated sources of one asset, waiting to be saved. Holds no UObject
+	 * references, so it can be handed over to a worker thread.
+	 */
+	struct FPendingSourceFiles
+	{
+		/** Pairs of file path and file contents. */
+		TArray<TPair<FString, FString>> Files;
+	};
+
+	/** Saves the files (the unchanged ones are skipped). Called from worker threads. */
+	static bool SaveSourceFiles(const FPendingSourceFiles& SourceFiles, FBlueprintNativeCodeGenFileWriter& FileWriter);
+
+	/**
+	 * An asset whose code is emitted by a worker thread. It's prepared on the game thread, and 
+	 * saved on it again, in the order of the assets (so the global dependency indices don't 
+	 * depend on the order in which the workers finish).
+	 */
+	struct FAssetToEmit
+	{
+		const FAssetData* AssetInfo = nullptr;
+		UBlueprint* Blueprint = nullptr;
+		FString ConversionHash;
+		/** Index of the asset's FAssetConversionStats. */
+		int32 StatsIndex = INDEX_NONE;
+		TUniquePtr<FBlueprintNativeCodeGenUtils::FPreparedCppCode> PreparedCode;
+
+		// Filled by the worker thread:
+		FDeferredDependencyRecords DeferredDependencies;
+		FString HeaderSource;
+		FString CppSource;
+		double EmitSeconds = 0.0;
+	};
+
+	/** Emits the code of a prepared asset. Called from worker threads. */
+	static void EmitSourceFiles(FAssetToEmit& AssetToEmit);
+
+	/**
+	 * Number of assets that are compiled before their code is emitted in parallel. The compiled
+	 * Blueprints stay in memory until the batch is saved, so it's a few per worker thread.
+	 */
+	static int32 GetEmitBatchSize();
+
+	/** Checks that the files generated for the record are still on disk. */
+	static bool AreGeneratedFilesPresent(const FConvertedAssetRecord& ConversionRecord, const UBlueprint& Blueprint);
+
+	/** Measurements of one asset's conversion, written to the -StatsCsv file. */
+	struct FAssetConversionStats
+	{
+		FString AssetPath;
+		const TCHAR* Result = TEXT("");
+		double TotalSeconds = 0.0;
+		/** Time spent in each phase, see FNativizationSummary::PhaseSeconds. */
+		TMap<FName, double> PhaseSeconds;
+		int32 HeaderLines = 0;
+		int32 CppLines = 0;
+		/** Peak physical memory used by the process, once the asset was converted. */
+		uint64 PeakUsedPhysical = 0;
+	};
+
+	static int32 CountLines(const FString& Source);
+
+	/** Saves one row per asset, with a column for every phase that was seen. */
+	static bool SaveStatsCsv(const FString& FilePath, const TArray<FAssetConversionStats>& AllStats);
+}
+
+//------------------------------------------------------------------------------
+static TArray<FString> BPConvertCommandletImpl::ParseList(const FString& Value)
+{
+	TArray<FString> Entries;
+	const TCHAR* Delimiters[] = { TEXT("+"), TEXT(",") };
+	Value.ParseIntoArray(Entries, Delimiters, UE_ARRAY_COUNT(Delimiters), /*InCullEmpty =*/true);
+	for (FString& Entry : Entries)
+	{
+		Entry.TrimStartAndEndInline();
+		Entry.TrimQuotesInline();
+	}
+	return Entries;
+}
+
+//------------------------------------------------------------------------------
+static bool BPConvertCommandletImpl::LoadCollectionFile(const FString& FilePath, TArray<FString>& OutObjectPaths)
+{
+	TArray<FString> Lines;
+	if (!FFileHelper::LoadFileToStringArray(Lines, *FilePath))
+	{
+		return false;
+	}
+
+	for (FString& Line : Lines)
+	{
+		Line.TrimStartAndEndInline();
+		// anything that isn't a content path ("FileVersion:", "Type:", "Guid:", etc.) is collection metadata
+		if (Line.StartsWith(TEXT("/")))
+		{
+			OutObjectPaths.Add(Line);
+		}
+	}
+	return true;
+}
+
+//------------------------------------------------------------------------------
+static FString BPConvertCommandletImpl::ResolvePluginPath(const FString& OutputValue)
+{
+	FString PluginPath = OutputValue;
+	FPaths::NormalizeFilename(PluginPath);
+	if (!PluginPath.EndsWith(PluginFileExt))
+	{
+		PluginPath = FPaths::Combine(*PluginPath, *DefaultPluginName) + PluginFileExt;
+	}
+	return PluginPath;
+}
+
+//------------------------------------------------------------------------------
+static bool BPConvertCommandletImpl::SaveSourceFiles(const FPendingSourceFiles& SourceFiles, FBlueprintNativeCodeGenFileWriter& FileWriter)
+{
+	bool bSuccess = true;
+	for (const TPair<FString, FString>& File : SourceFiles.Files)
+	{
+		bSuccess &= FileWriter.WriteFile(File.Key, File.Value);
+	}
+	return bSuccess;
+}
+
+//------------------------------------------------------------------------------
+static void BPConvertCommandletImpl::EmitSourceFiles(FAssetToEmit& AssetToEmit)
+{
+	const double StartTime = FPlatformTime::Seconds();
+
+	IBlueprintCompilerCppBackendModule& CodeGenBackend = (IBlueprintCompilerCppBackendModule&)IBlueprintCompilerCppBackendModule::Get();
+	CodeGenBackend.DeferDependencyRecords(&AssetToEmit.DeferredDependencies);
+	ON_SCOPE_EXIT
+	{
+		CodeGenBackend.DeferDependencyRecords(nullptr);
+	};
+	FBlueprintNativeCodeGenUtils::EmitCppCode(*AssetToEmit.PreparedCode, AssetToEmit.HeaderSource, AssetToEmit.CppSource);
+
+	AssetToEmit.EmitSeconds = FPlatformTime::Seconds() - StartTime;
+}
+
+//------------------------------------------------------------------------------
+static int32 BPConvertCommandletImpl::GetEmitBatchSize()
+{
+	if (!FApp::ShouldUseThreadingForPerformance())
+	{
+		return 1;
+	}
+	// the game thread emits too, while it waits for the workers
+	return 2 * (FTaskGraphInterface::Get().GetNumWorkerThreads() + 1);
+}
+
+//------------------------------------------------------------------------------
+static bool BPConvertCommandletImpl::AreGeneratedFilesPresent(const FConvertedAssetRecord& ConversionRecord, const UBlueprint& Blueprint)
+{
+	if (!FPaths::FileExists(ConversionRecord.GeneratedHeaderPath))
+	{
+		return false;
+	}
+	// interfaces don't produce a cpp file
+	return (Blueprint.BlueprintType == BPTYPE_Interface) || FPaths::FileExists(ConversionRecord.GeneratedCppPath);
+}
+
+//------------------------------------------------------------------------------
+static int32 BPConvertCommandletImpl::CountLines(const FString& Source)
+{
+	int32 LineCount = 0;
+	for (const TCHAR Char : Source)
+	{
+		LineCount += (Char == TEXT('\n')) ? 1 : 0;
+	}
+	return LineCount;
+}
+
+//------------------------------------------------------------------------------
+static bool BPConvertCommandletImpl::SaveStatsCsv(const FString& FilePath, const TArray<FAssetConversionStats>& AllStats)
+{
+	TArray<FName> Phases;
+	for (const FAssetConversionStats& Stats : AllStats)
+	{
+		for (const TPair<FName, double>& Phase : Stats.PhaseSeconds)
+		{
+			Phases.AddUnique(Phase.Key);
+		}
+	}
+	Phases.Sort(FNameLexicalLess());
+
+	FString Csv = TEXT("Asset,Result,TotalSeconds");
+	for (const FName Phase : Phases)
+	{
+		Csv += FString::Printf(TEXT(",%sSeconds"), *Phase.ToString());
+	}
+	Csv += TEXT(",HeaderLines,CppLines,PeakUsedPhysicalMB\n");
+
+	for (const FAssetConversionStats& Stats : AllStats)
+	{
+		Csv += FString::Printf(TEXT("\"%s\",%s,%.4f"), *Stats.AssetPath, Stats.Result, Stats.TotalSeconds);
+		for (const FName Phase : Phases)
+		{
+			const double* PhaseSeconds = Stats.PhaseSeconds.Find(Phase);
+			Csv += FString::Printf(TEXT(",%.4f"), PhaseSeconds ? *PhaseSeconds : 0.0);
+		}
+		Csv += FString::Printf(TEXT(",%d,%d,%llu\n"), Stats.HeaderLines, Stats.CppLines, Stats.PeakUsedPhysical / (1024 * 1024));
+	}
+	return FFileHelper::SaveStringToFile(Csv, *FilePath);
+}
+
+/*******************************************************************************
+ * UBPConvertCommandlet
+ ******************************************************************************/
+
+//------------------------------------------------------------------------------
+UBPConvertCommandlet::UBPConvertCommandlet(const FObjectInitializer& ObjectInitializer)
+	: Super(ObjectInitializer)
+{
+	IsClient = false;
+	IsEditor = true;
+	IsServer = false;
+	LogToConsole = true;
+
+	HelpDescription = TEXT("Converts Blueprints to C++ (into the NativizedAssets plugin layout) without any UI.");
+	HelpUsage = TEXT("<Project> -run=BPConvert [-Assets=<Path>+<Path>] [-Folders=<Path>+<Path>] [-Collection=<File>] [-Output=<Dir or .uplugin>] [-Platform=<PlatformName>] [-Incremental] [-StatsCsv=<File>]");
+	HelpParamNames.Add(BPConvertCommandletImpl::AssetsSwitch);
+	HelpParamDescriptions.Add(TEXT("Package or object paths of the Blueprints to convert."));
+	HelpParamNames.Add(BPConvertCommandletImpl::FoldersSwitch);
+	HelpParamDescriptions.Add(TEXT("Content folders to search (recursively) for Blueprints."));
+	HelpParamNames.Add(BPConvertCommandletImpl::CollectionSwitch);
+	HelpParamDescriptions.Add(TEXT("A collection (or plain text) file listing one object path per line."));
+	HelpParamNames.Add(BPConvertCommandletImpl::OutputSwitch);
+	HelpParamDescriptions.Add(TEXT("Target plugin directory or .uplugin file."));
+	HelpParamNames.Add(BPConvertCommandletImpl::PlatformSwitch);
+	HelpParamDescriptions.Add(TEXT("Platform name stored in the nativization options."));
+	HelpParamNames.Add(BPConvertCommandletImpl::IncrementalSwitch);
+	HelpParamDescriptions.Add(TEXT("Only converts the Blueprints that changed (or whose dependencies changed) since the previous run."));
+	HelpParamNames.Add(BPConvertCommandletImpl::StatsCsvSwitch);
+	HelpParamDescriptions.Add(TEXT("A .csv file to write per-asset conversion timings, generated line counts and peak memory to."));
+}
+
+//------------------------------------------------------------------------------
+int32 UBPConvertCommandlet::Main(const FString& Params)
+{
+	using namespace BPConvertCommandletImpl;
+
+	TArray<FString> Tokens, Switches;
+	TMap<FString, FString> ParamVals;
+	UCommandlet::ParseCommandLine(*Params, Tokens, Switches, ParamVals);
+
+	TArray<FAssetData> AssetsToConvert;
+	if (!GatherAssetsToConvert(ParamVals, AssetsToConvert))
+	{
+		UE_LOG(LogBPConvertCommandlet, Error, TEXT("Usage: %s"), *HelpUsage);
+		return 1;
+	}
+
+	if (AssetsToConvert.Num() == 0)
+	{
+		UE_LOG(LogBPConvertCommandlet, Warning, TEXT("No Blueprints matched the given -%s, -%s or -%s switches; nothing to convert."), *AssetsSwitch, *FoldersSwitch, *CollectionSwitch);
+		return 0;
+	}
+
+	FCompilerNativizationOptions NativizationOptions;
+	if (const FString* PlatformValue = ParamVals.Find(PlatformSwitch))
+	{
+		NativizationOptions.PlatformName = FName(**PlatformValue);
+	}
+
+	const FString* OutputValue = ParamVals.Find(OutputSwitch);
+	FBlueprintNativeCodeGenManifest Manifest = OutputValue
+		? FBlueprintNativeCodeGenManifest(ResolvePluginPath(*OutputValue), NativizationOptions)
+		: FBlueprintNativeCodeGenManifest(NativizationOptions);
+
+	UE_LOG(LogBPConvertCommandlet, Display, TEXT("Converting %d Blueprint(s) into '%s'."), AssetsToConvert.Num(), *Manifest.GetTargetPaths().PluginRootDir());
+
+	IBlueprintCompilerCppBackendModule& CodeGenBackend = (IBlueprintCompilerCppBackendModule&)IBlueprintCompilerCppBackendModule::Get();
+	ON_SCOPE_EXIT
+	{
+		CodeGenBackend.NativizationSummary().Reset();
+	};
+	TSharedPtr<FNativizationSummary> NativizationSummary(new FNativizationSummary());
+	// set here as well, FinalizePlugin needs it even if no asset has to be generated
+	CodeGenBackend.NativizationSummary() = NativizationSummary;
+
+	// the previous manifest lists the files generated before, so the ones of deleted assets can be removed (see FinalizePlugin)
+	TUniquePtr<FBlueprintNativeCodeGenManifest> PreviousManifest;
+	const FString PreviousManifestPath = Manifest.GetTargetPaths().ManifestFilePath(Manifest.GetManifestChunkId());
+	if (FPaths::FileExists(PreviousManifestPath))
+	{
+		PreviousManifest = MakeUnique<FBlueprintNativeCodeGenManifest>(PreviousManifestPath);
+	}
+
+	// the manifest whose records can be reused by an incremental conversion
+	const FBlueprintNativeCodeGenManifest* ReusableManifest = nullptr;
+	if (Switches.Contains(IncrementalSwitch))
+	{
+		if (!PreviousManifest)
+		{
+			UE_LOG(LogBPConvertCommandlet, Display, TEXT("No previous manifest found at '%s'; converting everything."), *PreviousManifestPath);
+		}
+		else if (!PreviousManifest->IsCurrentVersion())
+		{
+			UE_LOG(LogBPConvertCommandlet, Display, TEXT("The previous manifest '%s' was written by an older converter; converting everything."), *PreviousManifestPath);
+		}
+		else
+		{
+			ReusableManifest = PreviousManifest.Get();
+			// reused files refer to the global dependency table by index, so the previous indices must be kept
+			ReusableManifest->RestoreGlobalDependencies(*NativizationSummary);
+		}
+	}
+
+	FBlueprintNativeCodeGenFileWriter FileWriter;
+	int32 ConvertedCount = 0;
+	int32 UpToDateCount = 0;
+	int32 FailedCount = 0;
+	const FString* StatsCsvValue = ParamVals.Find(StatsCsvSwitch);
+	TArray<FAssetConversionStats> AllStats;
+	AllStats.Reserve(AssetsToConvert.Num());
+	// the sources are written by worker threads, while the next batch is compiled on this one
+	TArray<TFuture<bool>> PendingWrites;
+
+	auto CountResult = [&](EConversionResult Result, FAssetConversionStats& Stats)
+	{
+		switch (Result)
+		{
+		case EConversionResult::Converted:
+			++ConvertedCount;
+			Stats.Result = TEXT("Converted");
+			TRACE_COUNTER_INCREMENT(BPConverter_ConvertedAssets);
+			TRACE_COUNTER_ADD(BPConverter_GeneratedLines, Stats.HeaderLines + Stats.CppLines);
+			break;
+		case EConversionResult::UpToDate:
+			++UpToDateCount;
+			Stats.Result = TEXT("UpToDate");
+			break;
+		default:
+			++FailedCount;
+			Stats.Result = TEXT("Failed");
+			break;
+		}
+	};
+
+	const int32 EmitBatchSize = GetEmitBatchSize();
+	for (int32 BatchStart = 0; BatchStart < AssetsToConvert.Num(); BatchStart += EmitBatchSize)
+	{
+		const int32 BatchEnd = FMath::Min(BatchStart + EmitBatchSize, AssetsToConvert.Num());
+
+		// 1. Compile the Blueprints of the batch. Only the game thread can modify UObjects.
+		TArray<FAssetToEmit> AssetsToEmit;
+		for (int32 AssetIndex = BatchStart; AssetIndex < BatchEnd; ++AssetIndex)
+		{
+			const FAssetData& AssetInfo = AssetsToConvert[AssetIndex];
+			UE_LOG(LogBPConvertCommandlet, Display, TEXT("[%d/%d] %s"), AssetIndex + 1, AssetsToConvert.Num(), *AssetInfo.GetObjectPathString());
+
+			FAssetConversionStats& Stats = AllStats.AddDefaulted_GetRef();
+			Stats.AssetPath = AssetInfo.GetObjectPathString();
+			const TMap<FName, double> PhaseSecondsBefore = NativizationSummary->PhaseSeconds;
+			const double StartTime = FPlatformTime::Seconds();
+
+			FAssetToEmit AssetToEmit;
+			const EConversionResult Result = PrepareAsset(AssetInfo, Manifest, ReusableManifest, NativizationSummary, AssetToEmit);
+
+			// no worker is running, so the summary only holds the phases of this asset
+			Stats.TotalSeconds = FPlatformTime::Seconds() - StartTime;
+			for (const TPair<FName, double>& Phase : NativizationSummary->PhaseSeconds)
+			{
+				const double* SecondsBefore = PhaseSecondsBefore.Find(Phase.Key);
+				Stats.PhaseSeconds.Add(Phase.Key, Phase.Value - (SecondsBefore ? *SecondsBefore : 0.0));
+			}
+
+			if (AssetToEmit.PreparedCode)
+			{
+				AssetToEmit.StatsIndex = AllStats.Num() - 1;
+				AssetsToEmit.Add(MoveTemp(AssetToEmit));
+			}
+			else
+			{
+				CountResult(Result, Stats);
+				Stats.PeakUsedPhysical = FPlatformMemory::GetStats().PeakUsedPhysical;
+			}
+		}
+
+		// 2. Emit their code in parallel. This thread waits (and helps), so nothing is compiled or garbage collected meanwhile.
+		ParallelFor(AssetsToEmit.Num(), [&AssetsToEmit](int32 Index)
+		{
+			EmitSourceFiles(AssetsToEmit[Index]);
+		}, EParallelForFlags::Unbalanced);
+
+		// 3. Record the assets in their order, and queue their files to be written.
+		for (FAssetToEmit& AssetToEmit : AssetsToEmit)
+		{
+			FAssetConversionStats& Stats = AllStats[AssetToEmit.StatsIndex];
+			const double StartTime = FPlatformTime::Seconds();
+			const EConversionResult Result = SaveAsset(AssetToEmit, Manifest, FileWriter, PendingWrites, Stats);
+			CountResult(Result, Stats);
+
+			Stats.PhaseSeconds.FindOrAdd(TEXT("EmitCppCode")) += AssetToEmit.EmitSeconds;
+			Stats.TotalSeconds += AssetToEmit.EmitSeconds + (FPlatformTime::Seconds() - StartTime);
+			Stats.PeakUsedPhysical = FPlatformMemory::GetStats().PeakUsedPhysical;
+		}
+		// releases the compiled duplicates
+		AssetsToEmit.Empty();
+
+		// conversion duplicates and recompiles every Blueprint; don't let the garbage pile up over a large batch
+		CollectGarbage(RF_NoFlags);
+	}
+
+	bool bSuccess = (FailedCount == 0);
+	for (TFuture<bool>& PendingWrite : PendingWrites)
+	{
+		bSuccess &= PendingWrite.Get();
+	}
+	if ((ConvertedCount + UpToDateCount) > 0)
+	{
+		Manifest.RecordGlobalDependencies(*NativizationSummary);
+		if (!Manifest.Save())
+		{
+			UE_LOG(LogBPConvertCommandlet, Error, TEXT("Failed to save the manifest: %s"), *Manifest.GetTargetPaths().ManifestFilePath(Manifest.GetManifestChunkId()));
+			bSuccess = false;
+		}
+		if (!FBlueprintNativeCodeGenUtils::FinalizePlugin(Manifest, PreviousManifest.Get(), FileWriter))
+		{
+			UE_LOG(LogBPConvertCommandlet, Error, TEXT("Failed to finalize the plugin: %s"), *Manifest.GetTargetPaths().PluginFilePath());
+			bSuccess = false;
+		}
+	}
+	FileWriter.LogSummary();
+
+	if (StatsCsvValue && !SaveStatsCsv(*StatsCsvValue, AllStats))
+	{
+		UE_LOG(LogBPConvertCommandlet, Error, TEXT("Failed to save the conversion stats: %s"), **StatsCsvValue);
+		bSuccess = false;
+	}
+
+	UE_LOG(LogBPConvertCommandlet, Display, TEXT("Converted %d Blueprint(s), %d up to date, %d failed."), ConvertedCount, UpToDateCount, FailedCount);
+	return bSuccess ? 0 : 1;
+}
+
+//------------------------------------------------------------------------------
+bool UBPConvertCommandlet::GatherAssetsToConvert(const TMap<FString, FString>& ParamVals, TArray<FAssetData>& OutAssets) const
+{
+	using namespace BPConvertCommandletImpl;
+
+	const FString* AssetsValue = ParamVals.Find(AssetsSwitch);
+	const FString* FoldersValue = ParamVals.Find(FoldersSwitch);
+	const FString* CollectionValue = ParamVals.Find(CollectionSwitch);
+	if (!AssetsValue && !FoldersValue && !CollectionValue)
+	{
+		UE_LOG(LogBPConvertCommandlet, Error, TEXT("Nothing to convert. Specify at least one of -%s, -%s or -%s."), *AssetsSwitch, *FoldersSwitch, *CollectionSwitch);
+		return false;
+	}
+
+	IAssetRegistry& AssetRegistry = FModuleManager::LoadModuleChecked<FAssetRegistryModule>(TEXT("AssetRegistry")).Get();
+	// the registry isn't populated asynchronously when running a commandlet
+	AssetRegistry.SearchAllAssets(/*bSynchronousSearch =*/true);
+
+	TArray<FString> ObjectPaths;
+	if (AssetsValue)
+	{
+		ObjectPaths.Append(ParseList(*AssetsValue));
+	}
+	if (CollectionValue && !LoadCollectionFile(*CollectionValue, ObjectPaths))
+	{
+		UE_LOG(LogBPConvertCommandlet, Error, TEXT("Failed to read the collection file: %s"), **CollectionValue);
+		return false;
+	}
+
+	TArray<FAssetData> FoundAssets;
+	for (const FString& ObjectPath : ObjectPaths)
+	{
+		const int32 FoundBefore = FoundAssets.Num();
+		if (FPackageName::IsValidObjectPath(ObjectPath))
+		{
+			FAssetData AssetData = AssetRegistry.GetAssetByObjectPath(FSoftObjectPath(ObjectPath));
+			if (AssetData.IsValid())
+			{
+				FoundAssets.Add(MoveTemp(AssetData));
+			}
+		}
+		else
+		{
+			AssetRegistry.GetAssetsByPackageName(FName(*ObjectPath), FoundAssets);
+		}
+
+		if (FoundAssets.Num() == FoundBefore)
+		{
+			UE_LOG(LogBPConvertCommandlet, Warning, TEXT("Cannot find an asset for '%s'."), *ObjectPath);
+		}
+	}
+
+	if (FoldersValue)
+	{
+		FARFilter Filter;
+		Filter.bRecursivePaths = true;
+		Filter.bRecursiveClasses = true;
+		Filter.ClassPaths.Add(UBlueprint::StaticClass()->GetClassPathName());
+		for (const FString& Folder : ParseList(*FoldersValue))
+		{
+			FString PackagePath = Folder;
+			PackagePath.RemoveFromEnd(TEXT("/"));
+			Filter.PackagePaths.Add(FName(*PackagePath));
+		}
+		AssetRegistry.GetAssets(Filter, FoundAssets);
+	}
+
+	TSet<FSoftObjectPath> VisitedAssets;
+	for (FAssetData& AssetData : FoundAssets)
+	{
+		bool bAlreadyAdded = false;
+		VisitedAssets.Add(AssetData.GetSoftObjectPath(), &bAlreadyAdded);
+		if (bAlreadyAdded)
+		{
+			continue;
+		}
+
+		UClass* AssetClass = AssetData.GetClass();
+		if (!AssetClass || !AssetClass->IsChildOf<UBlueprint>())
+		{
+			UE_LOG(LogBPConvertCommandlet, Warning, TEXT("Skipping '%s', it is not a Blueprint."), *AssetData.GetObjectPathString());
+			continue;
+		}
+		OutAssets.Add(MoveTemp(AssetData));
+	}
+	return true;
+}
+
+//------------------------------------------------------------------------------
+UBPConvertCommandlet::EConversionResult UBPConvertCommandlet::PrepareAsset(const FAssetData& AssetInfo, FBlueprintNativeCodeGenManifest& Manifest, const FBlueprintNativeCodeGenManifest* PreviousManifest, TSharedPtr<FNativizationSummary> NativizationSummary, BPConvertCommandletImpl::FAssetToEmit& OutAssetToEmit) const
+{
+	using namespace BPConvertCommandletImpl;
+
+	UBlueprint* Blueprint = Cast<UBlueprint>(AssetInfo.GetAsset());
+	if (!Blueprint)
+	{
+		UE_LOG(LogBPConvertCommandlet, Error, TEXT("Failed to load '%s'."), *AssetInfo.GetObjectPathString());
+		return EConversionResult::Failed;
+	}
+
+	if (!FNativeCodeGenerationTool::CanGenerate(*Blueprint))
+	{
+		UE_LOG(LogBPConvertCommandlet, Error, TEXT("Cannot convert '%s'. It has errors, or its type is not supported."), *Blueprint->GetPathName());
+		return EConversionResult::Failed;
+	}
+
+	// The same options are hashed and generated with, so the hash changes exactly when the generated code can change
+	const FCompilerNativizationOptions& NativizationOptions = Manifest.GetCompilerNativizationOptions();
+	const FString ConversionHash = FBlueprintNativeCodeGenUtils::ComputeConversionHash(Blueprint->GeneratedClass, NativizationOptions);
+	if (PreviousManifest && !ConversionHash.IsEmpty())
+	{
+		const FConvertedAssetRecord* PreviousRecord = PreviousManifest->FindConversionRecord(AssetInfo.PackageName);
+		if (PreviousRecord && (PreviousRecord->ConversionHash == ConversionHash) && AreGeneratedFilesPresent(*PreviousRecord, *Blueprint))
+		{
+			UE_LOG(LogBPConvertCommandlet, Display, TEXT("'%s' is up to date."), *Blueprint->GetPathName());
+			Manifest.ReuseConversionRecord(AssetInfo.PackageName, *PreviousRecord);
+			Manifest.GatherModuleDependencies(Blueprint->GetOutermost());
+			return EConversionResult::UpToDate;
+		}
+	}
+
+	OutAssetToEmit.PreparedCode = FBlueprintNativeCodeGenUtils::PrepareCppCode(Blueprint->GeneratedClass, NativizationSummary, NativizationOptions);
+	if (!OutAssetToEmit.PreparedCode)
+	{
+		UE_LOG(LogBPConvertCommandlet, Error, TEXT("Failed to compile '%s'."), *Blueprint->GetPathName());
+		return EConversionResult::Failed;
+	}
+	OutAssetToEmit.AssetInfo = &AssetInfo;
+	OutAssetToEmit.Blueprint = Blueprint;
+	OutAssetToEmit.ConversionHash = ConversionHash;
+	return EConversionResult::Converted;
+}
+
+//------------------------------------------------------------------------------
+UBPConvertCommandlet::EConversionResult UBPConvertCommandlet::SaveAsset(BPConvertCommandletImpl::FAssetToEmit& AssetToEmit, FBlueprintNativeCodeGenManifest& Manifest, FBlueprintNativeCodeGenFileWriter& FileWriter, TArray<TFuture<bool>>& OutPendingWrites, BPConvertCommandletImpl::FAssetConversionStats& OutStats) const
+{
+	using namespace BPConvertCommandletImpl;
+
+	if (AssetToEmit.HeaderSource.IsEmpty())
+	{
+		UE_LOG(LogBPConvertCommandlet, Error, TEXT("No code was generated for '%s'."), *AssetToEmit.Blueprint->GetPathName());
+		return EConversionResult::Failed;
+	}
+
+	IBlueprintCompilerCppBackendModule& CodeGenBackend = (IBlueprintCompilerCppBackendModule&)IBlueprintCompilerCppBackendModule::Get();
+	CodeGenBackend.ResolveDeferredDependencies(AssetToEmit.DeferredDependencies, AssetToEmit.HeaderSource);
+	CodeGenBackend.ResolveDeferredDependencies(AssetToEmit.DeferredDependencies, AssetToEmit.CppSource);
+
+	OutStats.HeaderLines = CountLines(AssetToEmit.HeaderSource);
+	OutStats.CppLines = CountLines(AssetToEmit.CppSource);
+
+	const FAssetData& AssetInfo = *AssetToEmit.AssetInfo;
+	FConvertedAssetRecord& ConversionRecord = Manifest.CreateConversionRecord(AssetInfo.PackageName, AssetInfo);
+	ConversionRecord.ConversionHash = AssetToEmit.ConversionHash;
+	Manifest.GatherModuleDependencies(AssetToEmit.Blueprint->GetOutermost());
+
+	FPendingSourceFiles SourceFiles;
+	SourceFiles.Files.Emplace(ConversionRecord.GeneratedHeaderPath, MoveTemp(AssetToEmit.HeaderSource));
+	// interfaces don't produce a cpp file
+	if (!AssetToEmit.CppSource.IsEmpty())
+	{
+		SourceFiles.Files.Emplace(ConversionRecord.GeneratedCppPath, MoveTemp(AssetToEmit.CppSource));
+	}
+
+	if (FApp::ShouldUseThreadingForPerformance())
+	{
+		// the writer outlives the task, Main() waits for all pending writes
+		OutPendingWrites.Add(Async(EAsyncExecution::ThreadPool, [SourceFiles = MoveTemp(SourceFiles), FileWriterPtr = &FileWriter]()
+		{
+			return SaveSourceFiles(SourceFiles, *FileWriterPtr);
+		}));
+	}
+	else
+	{
+		OutPendingWrites.Add(MakeFulfilledPromise<bool>(SaveSourceFiles(SourceFiles, FileWriter)).GetFuture());
+	}
+	return EConversionResult::Converted;
+}
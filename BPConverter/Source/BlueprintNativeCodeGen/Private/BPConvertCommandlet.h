@@ -0,0 +1,75 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "UObject/ObjectMacros.h"
+#include "Commandlets/Commandlet.h"
+#include "Async/Future.h"
+#include "BPConvertCommandlet.generated.h"
+
+struct FAssetData;
+struct FBlueprintNativeCodeGenManifest;
+struct FNativizationSummary;
+class FBlueprintNativeCodeGenFileWriter;
+namespace BPConvertCommandletImpl { struct FAssetConversionStats; struct FAssetToEmit; }
+
+/**
+ * Converts Blueprints to C++ without any UI, so whole folders or projects can
+ * be nativized on headless build machines.
+ *
+ * Usage:
+ *   UnrealEditor-Cmd <Project> -run=BPConvert [-Assets=<Path>+<Path>] [-Folders=<Path>+<Path>]
+ *                    [-Collection=<File>] [-Output=<Dir or .uplugin>] [-Platform=<PlatformName>] [-Incremental]
+ *                    [-StatsCsv=<File>]
+ *
+ *   -Assets      Package or object paths of the Blueprints to convert.
+ *   -Folders     Content folders; every Blueprint found (recursively) is converted.
+ *   -Collection  A text file (a .collection file or a plain list), one object path per line.
+ *   -Output      Target plugin directory or .uplugin file. Defaults to Intermediate/Plugins/NativizedAssets.
+ *   -Platform    Platform name stored in the nativization options.
+ *   -Incremental Skips Blueprints whose conversion hash matches the one stored in the existing manifest.
+ *   -StatsCsv    Writes per-asset timings (per conversion phase), generated line counts and peak memory to the file.
+ *
+ * The generated files follow the FBlueprintNativeCodeGenManifest layout, and the
+ * plugin is finalized (module, build file and descriptor) once all assets are converted.
+ * Assets are converted in batches. The Blueprints of a batch are compiled one by one
+ * on the game thread, then their code is emitted in parallel by task graph workers,
+ * and the generated files are written by thread pool workers. Files whose contents
+ * didn't change are not rewritten, and sources of assets that are not converted
+ * anymore are deleted.
+ */
+UCLASS()
+class UBPConvertCommandlet : public UCommandlet
+{
+	GENERATED_UCLASS_BODY()
+
+public:
+	//~ Begin UCommandlet Interface
+	virtual int32 Main(const FString& Params) override;
+	//~ End UCommandlet Interface
+
+private:
+	enum class EConversionResult
+	{
+		Converted,
+		UpToDate,
+		Failed,
+	};
+
+	/** Collects the Blueprint assets named by the -Assets, -Folders and -Collection switches. */
+	bool GatherAssetsToConvert(const TMap<FString, FString>& ParamVals, TArray<FAssetData>& OutAssets) const;
+
+	/**
+	 * Compiles a single asset (on the game thread), so its code can be emitted by a worker
+	 * thread. When a previous manifest is given, and its record for the asset has the same 
+	 * conversion hash, the record is reused and nothing has to be emitted (UpToDate).
+	 */
+	EConversionResult PrepareAsset(const FAssetData& AssetInfo, FBlueprintNativeCodeGenManifest& Manifest, const FBlueprintNativeCodeGenManifest* PreviousManifest, TSharedPtr<FNativizationSummary> NativizationSummary, BPConvertCommandletImpl::FAssetToEmit& OutAssetToEmit) const;
+
+	/**
+	 * Records the emitted code of an asset in the manifest (on the game thread), and queues it
+	 * to be saved, by a worker thread, to the paths recorded in the manifest.
+	 */
+	EConversionResult SaveAsset(BPConvertCommandletImpl::FAssetToEmit& AssetToEmit, FBlueprintNativeCodeGenManifest& Manifest, FBlueprintNativeCodeGenFileWriter& FileWriter, TArray<TFuture<bool>>& OutPendingWrites, BPConvertCommandletImpl::FAssetConversionStats& OutStats) const;
+};
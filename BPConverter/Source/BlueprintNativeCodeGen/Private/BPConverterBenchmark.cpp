@@ -0,0 +1,448 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "CoreMinimal.h"
+#include "Misc/AutomationTest.h"
+#include "Misc/Paths.h"
+#include "Misc/FileHelper.h"
+#include "Misc/CommandLine.h"
+#include "Misc/PackageName.h"
+#include "Misc/ScopeExit.h"
+#include "HAL/PlatformMemory.h"
+#include "HAL/PlatformTime.h"
+#include "UObject/Package.h"
+#include "UObject/UObjectGlobals.h"
+#include "GameFramework/Actor.h"
+#include "Components/SceneComponent.h"
+#include "Engine/Blueprint.h"
+#include "Engine/BlueprintGeneratedClass.h"
+#include "Engine/SimpleConstructionScript.h"
+#include "Engine/SCS_Node.h"
+#include "EdGraph/EdGraph.h"
+#include "EdGraphSchema_K2.h"
+#include "K2Node_CallFunction.h"
+#include "K2Node_CustomEvent.h"
+#include "K2Node_FunctionEntry.h"
+#include "K2Node_VariableGet.h"
+#include "K2Node_VariableSet.h"
+#include "Kismet/KismetMathLibrary.h"
+#include "Kismet/KismetSystemLibrary.h"
+#include "Kismet2/BlueprintEditorUtils.h"
+#include "Kismet2/KismetEditorUtilities.h"
+#include "Dom/JsonObject.h"
+#include "Serialization/JsonWriter.h"
+#include "Serialization/JsonSerializer.h"
+#include "IBlueprintCompilerCppBackendModule.h"
+#include "BlueprintNativeCodeGenUtils.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+/*******************************************************************************
+ * BPConverterBenchmarkImpl
+ ******************************************************************************/
+
+namespace BPConverterBenchmarkImpl
+{
+	/** Describes the shape of the synthetic Blueprint, see FBenchmarkParams::Parse for the syntax. */
+	struct FBenchmarkParams
+	{
+		// Total number of graph nodes, spread over all the functions and execution groups.
+		int32 Nodes = 30;
+		int32 Functions = 1;
+		int32 Variables = 1;
+		// Number of custom events in the event graph, each one starting its own chain of nodes.
+		int32 ExecutionGroups = 1;
+		// Delay nodes, spread over the execution groups (latent actions are not allowed in functions).
+		int32 LatentNodes = 0;
+		int32 Components = 0;
+		// How many times the Blueprint is converted, the reported times are averaged.
+		int32 Iterations = 3;
+
+		/** Parses "Nodes=300 Functions=4 ...", unspecified values keep their defaults. */
+		static FBenchmarkParams Parse(const TCHAR* Params);
+
+		TSharedRef<FJsonObject> ToJson() const;
+	};
+
+	/** Wall time and memory of a benchmark stage. */
+	struct FStageStats
+	{
+		double Seconds = 0.0;
+		int64 UsedPhysicalDelta = 0;
+	};
+
+	// Each unit reads a variable, adds one to it and writes it back: Get -> Add_IntInt -> Set.
+	static const int32 NodesPerUnit = 3;
+
+	static UBlueprint* CreateBenchmarkBlueprint(const FBenchmarkParams& Params, const FString& CaseName);
+	static void AddComponents(UBlueprint* Blueprint, int32 NumComponents);
+	static UEdGraphPin* AddVariableIncrement(UEdGraph& Graph, UEdGraphPin* ExecPin, FName VariableName);
+	static UEdGraphPin* AddDelay(UEdGraph& Graph, UEdGraphPin* ExecPin);
+	static void AddNodeChain(UEdGraph& Graph, UEdGraphPin* ExecPin, const TArray<FName>& VariableNames, int32 NumUnits, int32 NumLatentNodes);
+	static FString GetResultsDirectory();
+}
+
+//------------------------------------------------------------------------------
+BPConverterBenchmarkImpl::FBenchmarkParams BPConverterBenchmarkImpl::FBenchmarkParams::Parse(const TCHAR* Params)
+{
+	FBenchmarkParams Result;
+	FParse::Value(Params, TEXT("Nodes="), Result.Nodes);
+	FParse::Value(Params, TEXT("Functions="), Result.Functions);
+	FParse::Value(Params, TEXT("Variables="), Result.Variables);
+	FParse::Value(Params, TEXT("ExecutionGroups="), Result.ExecutionGroups);
+	FParse::Value(Params, TEXT("LatentNodes="), Result.LatentNodes);
+	FParse::Value(Params, TEXT("Components="), Result.Components);
+	FParse::Value(Params, TEXT("Iterations="), Result.Iterations);
+
+	Result.Nodes = FMath::Max(Result.Nodes, 0);
+	Result.Functions = FMath::Max(Result.Functions, 0);
+	// every chain needs a variable to operate on
+	Result.Variables = FMath::Max(Result.Variables, 1);
+	Result.LatentNodes = FMath::Max(Result.LatentNodes, 0);
+	// latent nodes can only live in the event graph
+	Result.ExecutionGroups = FMath::Max(Result.ExecutionGroups, (Result.LatentNodes > 0) ? 1 : 0);
+	// the nodes need at least one graph to be placed in
+	Result.ExecutionGroups = FMath::Max(Result.ExecutionGroups, (Result.Functions == 0) ? 1 : 0);
+	Result.Components = FMath::Max(Result.Components, 0);
+	Result.Iterations = FMath::Max(Result.Iterations, 1);
+	return Result;
+}
+
+//------------------------------------------------------------------------------
+TSharedRef<FJsonObject> BPConverterBenchmarkImpl::FBenchmarkParams::ToJson() const
+{
+	TSharedRef<FJsonObject> JsonObject = MakeShared<FJsonObject>();
+	JsonObject->SetNumberField(TEXT("Nodes"), Nodes);
+	JsonObject->SetNumberField(TEXT("Functions"), Functions);
+	JsonObject->SetNumberField(TEXT("Variables"), Variables);
+	JsonObject->SetNumberField(TEXT("ExecutionGroups"), ExecutionGroups);
+	JsonObject->SetNumberField(TEXT("LatentNodes"), LatentNodes);
+	JsonObject->SetNumberField(TEXT("Components"), Components);
+	JsonObject->SetNumberField(TEXT("Iterations"), Iterations);
+	return JsonObject;
+}
+
+//------------------------------------------------------------------------------
+static UEdGraphPin* BPConverterBenchmarkImpl::AddVariableIncrement(UEdGraph& Graph, UEdGraphPin* ExecPin, FName VariableName)
+{
+	const UEdGraphSchema_K2* Schema = GetDefault<UEdGraphSchema_K2>();
+
+	FGraphNodeCreator<UK2Node_VariableGet> GetNodeCreator(Graph);
+	UK2Node_VariableGet* GetNode = GetNodeCreator.CreateNode();
+	GetNode->VariableReference.SetSelfMember(VariableName);
+	GetNodeCreator.Finalize();
+
+	FGraphNodeCreator<UK2Node_CallFunction> AddNodeCreator(Graph);
+	UK2Node_CallFunction* AddNode = AddNodeCreator.CreateNode();
+	AddNode->SetFromFunction(UKismetMathLibrary::StaticClass()->FindFunctionByName(GET_FUNCTION_NAME_CHECKED(UKismetMathLibrary, Add_IntInt)));
+	AddNodeCreator.Finalize();
+
+	FGraphNodeCreator<UK2Node_VariableSet> SetNodeCreator(Graph);
+	UK2Node_VariableSet* SetNode = SetNodeCreator.CreateNode();
+	SetNode->VariableReference.SetSelfMember(VariableName);
+	SetNodeCreator.Finalize();
+
+	AddNode->FindPinChecked(TEXT("B"))->DefaultValue = TEXT("1");
+	ensure(Schema->TryCreateConnection(GetNode->GetValuePin(), AddNode->FindPinChecked(TEXT("A"))));
+	ensure(Schema->TryCreateConnection(AddNode->GetReturnValuePin(), SetNode->FindPinChecked(VariableName, EGPD_Input)));
+	ensure(Schema->TryCreateConnection(ExecPin, SetNode->GetExecPin()));
+	return SetNode->GetThenPin();
+}
+
+//------------------------------------------------------------------------------
+static UEdGraphPin* BPConverterBenchmarkImpl::AddDelay(UEdGraph& Graph, UEdGraphPin* ExecPin)
+{
+	FGraphNodeCreator<UK2Node_CallFunction> DelayNodeCreator(Graph);
+	UK2Node_CallFunction* DelayNode = DelayNodeCreator.CreateNode();
+	DelayNode->SetFromFunction(UKismetSystemLibrary::StaticClass()->FindFunctionByName(GET_FUNCTION_NAME_CHECKED(UKismetSystemLibrary, Delay)));
+	DelayNodeCreator.Finalize();
+
+	DelayNode->FindPinChecked(TEXT("Duration"))->DefaultValue = TEXT("0.1");
+	ensure(GetDefault<UEdGraphSchema_K2>()->TryCreateConnection(ExecPin, DelayNode->GetExecPin()));
+	return DelayNode->GetThenPin();
+}
+
+//------------------------------------------------------------------------------
+static void BPConverterBenchmarkImpl::AddNodeChain(UEdGraph& Graph, UEdGraphPin* ExecPin, const TArray<FName>& VariableNames, int32 NumUnits, int32 NumLatentNodes)
+{
+	check(ExecPin && VariableNames.Num());
+	// interleave the latent nodes with the rest, so the generated code has to resume in the middle of the chain
+	const int32 UnitsPerDelay = NumUnits / (NumLatentNodes + 1);
+	int32 DelaysLeft = NumLatentNodes;
+	for (int32 UnitIndex = 0; UnitIndex < NumUnits; ++UnitIndex)
+	{
+		if (DelaysLeft && UnitIndex && (UnitIndex % FMath::Max(UnitsPerDelay, 1) == 0))
+		{
+			ExecPin = AddDelay(Graph, ExecPin);
+			--DelaysLeft;
+		}
+		ExecPin = AddVariableIncrement(Graph, ExecPin, VariableNames[UnitIndex % VariableNames.Num()]);
+	}
+	for (; DelaysLeft > 0; --DelaysLeft)
+	{
+		ExecPin = AddDelay(Graph, ExecPin);
+	}
+}
+
+//------------------------------------------------------------------------------
+static void BPConverterBenchmarkImpl::AddComponents(UBlueprint* Blueprint, int32 NumComponents)
+{
+	USimpleConstructionScript* SCS = Blueprint->SimpleConstructionScript;
+	if (!ensure(SCS))
+	{
+		return;
+	}
+	for (int32 ComponentIndex = 0; ComponentIndex < NumComponents; ++ComponentIndex)
+	{
+		USCS_Node* NewNode = SCS->CreateNode(USceneComponent::StaticClass(), *FString::Printf(TEXT("BenchComponent_%d"), ComponentIndex));
+		const TArray<USCS_Node*>& RootNodes = SCS->GetRootNodes();
+		if (RootNodes.Num())
+		{
+			RootNodes[0]->AddChildNode(NewNode);
+		}
+		else
+		{
+			SCS->AddNode(NewNode);
+		}
+	}
+}
+
+//------------------------------------------------------------------------------
+static UBlueprint* BPConverterBenchmarkImpl::CreateBenchmarkBlueprint(const FBenchmarkParams& Params, const FString& CaseName)
+{
+	// the converter refuses Blueprints from the transient package
+	const FName PackageName = MakeUniqueObjectName(nullptr, UPackage::StaticClass(), *FString::Printf(TEXT("/Temp/BPConverterBenchmark/BP_Bench_%s"), *CaseName));
+	UPackage* Package = CreatePackage(*PackageName.ToString());
+	UBlueprint* Blueprint = FKismetEditorUtilities::CreateBlueprint(AActor::StaticClass(), Package, *FPackageName::GetShortName(PackageName)
+		, BPTYPE_Normal, UBlueprint::StaticClass(), UBlueprintGeneratedClass::StaticClass());
+	check(Blueprint);
+
+	TArray<FName> VariableNames;
+	for (int32 VariableIndex = 0; VariableIndex < Params.Variables; ++VariableIndex)
+	{
+		const FName VariableName(*FString::Printf(TEXT("BenchVar_%d"), VariableIndex));
+		FEdGraphPinType PinType;
+		PinType.PinCategory = UEdGraphSchema_K2::PC_Int;
+		ensure(FBlueprintEditorUtils::AddMemberVariable(Blueprint, VariableName, PinType));
+		VariableNames.Add(VariableName);
+	}
+
+	AddComponents(Blueprint, Params.Components);
+
+	const int32 NumChains = Params.Functions + Params.ExecutionGroups;
+	const int32 TotalUnits = Params.Nodes / NodesPerUnit;
+	int32 ChainIndex = 0;
+	// spread the remainder over the first chains, so the node count matches as close as possible
+	auto UnitsForChain = [&]() -> int32
+	{
+		const int32 Units = (TotalUnits / NumChains) + ((ChainIndex < (TotalUnits % NumChains)) ? 1 : 0);
+		++ChainIndex;
+		return Units;
+	};
+
+	for (int32 FunctionIndex = 0; FunctionIndex < Params.Functions; ++FunctionIndex)
+	{
+		UEdGraph* FunctionGraph = FBlueprintEditorUtils::CreateNewGraph(Blueprint, *FString::Printf(TEXT("BenchFunction_%d"), FunctionIndex)
+			, UEdGraph::StaticClass(), UEdGraphSchema_K2::StaticClass());
+		FBlueprintEditorUtils::AddFunctionGraph<UClass>(Blueprint, FunctionGraph, /*bIsUserCreated=*/true, nullptr);
+
+		TArray<UK2Node_FunctionEntry*> EntryNodes;
+		FunctionGraph->GetNodesOfClass(EntryNodes);
+		check(EntryNodes.Num() == 1);
+		AddNodeChain(*FunctionGraph, EntryNodes[0]->FindPinChecked(UEdGraphSchema_K2::PN_Then), VariableNames, UnitsForChain(), 0);
+	}
+
+	UEdGraph* EventGraph = FBlueprintEditorUtils::FindEventGraph(Blueprint);
+	check(EventGraph || !Params.ExecutionGroups);
+	for (int32 GroupIndex = 0; GroupIndex < Params.ExecutionGroups; ++GroupIndex)
+	{
+		FGraphNodeCreator<UK2Node_CustomEvent> EventNodeCreator(*EventGraph);
+		UK2Node_CustomEvent* EventNode = EventNodeCreator.CreateNode();
+		EventNode->CustomFunctionName = *FString::Printf(TEXT("BenchEvent_%d"), GroupIndex);
+		EventNodeCreator.Finalize();
+
+		const int32 LatentNodes = (Params.LatentNodes / Params.ExecutionGroups) + ((GroupIndex < (Params.LatentNodes % Params.ExecutionGroups)) ? 1 : 0);
+		AddNodeChain(*EventGraph, EventNode->FindPinChecked(UEdGraphSchema_K2::PN_Then), VariableNames, UnitsForChain(), LatentNodes);
+	}
+
+	FBlueprintEditorUtils::MarkBlueprintAsStructurallyModified(Blueprint);
+	return Blueprint;
+}
+
+//------------------------------------------------------------------------------
+static FString BPConverterBenchmarkImpl::GetResultsDirectory()
+{
+	FString ResultsDir;
+	if (!FParse::Value(FCommandLine::Get(), TEXT("BPConverterBenchmarkDir="), ResultsDir))
+	{
+		ResultsDir = FPaths::Combine(FPaths::AutomationDir(), TEXT("BPConverterBenchmark"));
+	}
+	return ResultsDir;
+}
+
+/*******************************************************************************
+ * FBPConverterBenchmark
+ ******************************************************************************/
+
+/**
+ * Builds a synthetic Blueprint in memory, converts it with
+ * FBlueprintNativeCodeGenUtils::GenerateCppCode and writes the time, memory
+ * and output size of every phase to <Saved>/Automation/BPConverterBenchmark/<Case>.json
+ * (or to -BPConverterBenchmarkDir=), so CI can track the converter performance:
+ *
+ *	UnrealEditor-Cmd <Project> -ExecCmds="Automation RunTests Project.Blueprints.NativeBackend.Benchmark;Quit" -unattended -nullrhi
+ */
+IMPLEMENT_COMPLEX_AUTOMATION_TEST(FBPConverterBenchmark, "Project.Blueprints.NativeBackend.Benchmark", EAutomationTestFlags::EditorContext | EAutomationTestFlags::PerfFilter)
+
+void FBPConverterBenchmark::GetTests(TArray<FString>& OutBeautifiedNames, TArray<FString>& OutTestCommands) const
+{
+	OutBeautifiedNames.Add(TEXT("Small"));
+	OutTestCommands.Add(TEXT("Nodes=30 Functions=1 Variables=2 ExecutionGroups=1 LatentNodes=0 Components=1"));
+
+	OutBeautifiedNames.Add(TEXT("Medium"));
+	OutTestCommands.Add(TEXT("Nodes=300 Functions=4 Variables=8 ExecutionGroups=4 LatentNodes=4 Components=8"));
+
+	OutBeautifiedNames.Add(TEXT("Large"));
+	OutTestCommands.Add(TEXT("Nodes=3000 Functions=16 Variables=32 ExecutionGroups=16 LatentNodes=32 Components=32"));
+
+	OutBeautifiedNames.Add(TEXT("LatentHeavy"));
+	OutTestCommands.Add(TEXT("Nodes=600 Functions=0 Variables=4 ExecutionGroups=2 LatentNodes=64 Components=0"));
+
+	OutBeautifiedNames.Add(TEXT("ComponentHeavy"));
+	OutTestCommands.Add(TEXT("Nodes=30 Functions=1 Variables=2 ExecutionGroups=1 LatentNodes=0 Components=256"));
+
+	// an extra case can be passed on the command line, e.g. -BPConverterBenchmark="Nodes=10000 Functions=64"
+	FString CustomParams;
+	if (FParse::Value(FCommandLine::Get(), TEXT("BPConverterBenchmark="), CustomParams, /*bShouldStopOnSeparator=*/false))
+	{
+		OutBeautifiedNames.Add(TEXT("Custom"));
+		OutTestCommands.Add(CustomParams);
+	}
+}
+
+bool FBPConverterBenchmark::RunTest(const FString& Parameters)
+{
+	using namespace BPConverterBenchmarkImpl;
+
+	const FBenchmarkParams Params = FBenchmarkParams::Parse(*Parameters);
+	FString CaseName = TEXT("Custom");
+	{
+		TArray<FString> CaseNames, CaseParams;
+		GetTests(CaseNames, CaseParams);
+		const int32 CaseIndex = CaseParams.IndexOfByKey(Parameters);
+		if (CaseIndex != INDEX_NONE)
+		{
+			CaseName = CaseNames[CaseIndex];
+		}
+	}
+
+	TMap<FName, FStageStats> StageStats;
+	auto RunStage = [&StageStats](FName StageName, TFunctionRef<void()> Stage)
+	{
+		const int64 UsedPhysicalBefore = (int64)FPlatformMemory::GetStats().UsedPhysical;
+		const double StartTime = FPlatformTime::Seconds();
+		Stage();
+		FStageStats& Stats = StageStats.FindOrAdd(StageName);
+		Stats.Seconds += FPlatformTime::Seconds() - StartTime;
+		Stats.UsedPhysicalDelta += (int64)FPlatformMemory::GetStats().UsedPhysical - UsedPhysicalBefore;
+	};
+
+	UBlueprint* Blueprint = nullptr;
+	RunStage(TEXT("CreateBlueprint"), [&]()
+	{
+		Blueprint = CreateBenchmarkBlueprint(Params, CaseName);
+	});
+	ON_SCOPE_EXIT
+	{
+		if (Blueprint)
+		{
+			Blueprint->GetOutermost()->MarkAsGarbage();
+			Blueprint->MarkAsGarbage();
+		}
+		CollectGarbage(GARBAGE_COLLECTION_KEEPFLAGS);
+	};
+
+	RunStage(TEXT("CompileBlueprint"), [&]()
+	{
+		FKismetEditorUtilities::CompileBlueprint(Blueprint, EBlueprintCompileOptions::SkipGarbageCollection);
+	});
+	if (!TestTrue(TEXT("Synthetic Blueprint compiles"), (Blueprint->Status != BS_Error) && (Blueprint->GeneratedClass != nullptr)))
+	{
+		return false;
+	}
+
+	TSharedPtr<FString> HeaderSource(new FString());
+	TSharedPtr<FString> CppSource(new FString());
+	TMap<FName, double> ConversionPhaseSeconds;
+	for (int32 Iteration = 0; Iteration < Params.Iterations; ++Iteration)
+	{
+		TSharedPtr<FNativizationSummary> NativizationSummary(new FNativizationSummary());
+		RunStage(TEXT("GenerateCppCode"), [&]()
+		{
+			FBlueprintNativeCodeGenUtils::GenerateCppCode(Blueprint->GeneratedClass, HeaderSource, CppSource, NativizationSummary, FCompilerNativizationOptions{});
+		});
+		for (const TPair<FName, double>& Phase : NativizationSummary->PhaseSeconds)
+		{
+			ConversionPhaseSeconds.FindOrAdd(Phase.Key) += Phase.Value;
+		}
+	}
+	TestFalse(TEXT("Generated header is not empty"), HeaderSource->IsEmpty());
+	TestFalse(TEXT("Generated cpp is not empty"), CppSource->IsEmpty());
+
+	const double IterationScale = 1.0 / Params.Iterations;
+	StageStats.FindChecked(TEXT("GenerateCppCode")).Seconds *= IterationScale;
+	StageStats.FindChecked(TEXT("GenerateCppCode")).UsedPhysicalDelta /= Params.Iterations;
+
+	TSharedRef<FJsonObject> StagesJson = MakeShared<FJsonObject>();
+	for (const TPair<FName, FStageStats>& Stage : StageStats)
+	{
+		TSharedRef<FJsonObject> StageJson = MakeShared<FJsonObject>();
+		StageJson->SetNumberField(TEXT("Seconds"), Stage.Value.Seconds);
+		StageJson->SetNumberField(TEXT("UsedPhysicalDeltaBytes"), (double)Stage.Value.UsedPhysicalDelta);
+		StagesJson->SetObjectField(Stage.Key.ToString(), StageJson);
+	}
+
+	TSharedRef<FJsonObject> PhasesJson = MakeShared<FJsonObject>();
+	for (const TPair<FName, double>& Phase : ConversionPhaseSeconds)
+	{
+		PhasesJson->SetNumberField(Phase.Key.ToString(), Phase.Value * IterationScale);
+	}
+
+	auto CountLines = [](const FString& Source) -> int32
+	{
+		int32 LineCount = 0;
+		for (const TCHAR Char : Source)
+		{
+			LineCount += (Char == TEXT('\n')) ? 1 : 0;
+		}
+		return LineCount;
+	};
+	TSharedRef<FJsonObject> OutputJson = MakeShared<FJsonObject>();
+	OutputJson->SetNumberField(TEXT("HeaderChars"), HeaderSource->Len());
+	OutputJson->SetNumberField(TEXT("CppChars"), CppSource->Len());
+	OutputJson->SetNumberField(TEXT("HeaderLines"), CountLines(*HeaderSource));
+	OutputJson->SetNumberField(TEXT("CppLines"), CountLines(*CppSource));
+
+	TSharedRef<FJsonObject> ResultJson = MakeShared<FJsonObject>();
+	ResultJson->SetStringField(TEXT("Case"), CaseName);
+	ResultJson->SetStringField(TEXT("Platform"), FPlatformProperties::IniPlatformName());
+	ResultJson->SetObjectField(TEXT("Parameters"), Params.ToJson());
+	ResultJson->SetObjectField(TEXT("Stages"), StagesJson);
+	ResultJson->SetObjectField(TEXT("ConversionPhases"), PhasesJson);
+	ResultJson->SetObjectField(TEXT("Output"), OutputJson);
+	ResultJson->SetNumberField(TEXT("PeakUsedPhysicalBytes"), (double)FPlatformMemory::GetStats().PeakUsedPhysical);
+
+	FString ResultText;
+	TSharedRef<TJsonWriter<>> JsonWriter = TJsonWriterFactory<>::Create(&ResultText);
+	FJsonSerializer::Serialize(ResultJson, JsonWriter);
+
+	const FString ResultPath = FPaths::Combine(GetResultsDirectory(), CaseName + TEXT(".json"));
+	if (!TestTrue(TEXT("Benchmark results saved"), FFileHelper::SaveStringToFile(ResultText, *ResultPath)))
+	{
+		return false;
+	}
+	AddInfo(FString::Printf(TEXT("GenerateCppCode: %.4fs, %d header and %d cpp lines. Results: %s")
+		, StageStats.FindChecked(TEXT("GenerateCppCode")).Seconds, CountLines(*HeaderSource), CountLines(*CppSource), *ResultPath));
+	return true;
+}
+
+#endif // WITH_DEV_AUTOMATION_TESTS
@@ -0,0 +1,58 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "BPConverterTestLibrary.h"
+#include "Engine/Engine.h"
+#include "Engine/World.h"
+#include "LatentActions.h"
+
+/*******************************************************************************
+ * BPConverterTestLibraryImpl
+ ******************************************************************************/
+
+namespace BPConverterTestLibraryImpl
+{
+	/** Writes the output through the reference kept since the call, like the engine latent functions do. */
+	class FLatentOutputAction : public FPendingLatentAction
+	{
+	public:
+		FLatentOutputAction(int32& InOutput, const FLatentActionInfo& LatentInfo)
+			: Output(InOutput)
+			, ExecutionFunction(LatentInfo.ExecutionFunction)
+			, OutputLink(LatentInfo.Linkage)
+			, CallbackTarget(LatentInfo.CallbackTarget)
+		{
+		}
+
+		virtual void UpdateOperation(FLatentResponse& Response) override
+		{
+			Output = 1;
+			Response.FinishAndTriggerIf(true, ExecutionFunction, OutputLink, CallbackTarget);
+		}
+
+	private:
+		int32& Output;
+		FName ExecutionFunction;
+		int32 OutputLink;
+		FWeakObjectPtr CallbackTarget;
+	};
+}
+
+/*******************************************************************************
+ * UBPConverterTestLibrary
+ ******************************************************************************/
+
+//------------------------------------------------------------------------------
+void UBPConverterTestLibrary::LatentOutput(const UObject* WorldContextObject, int32& Output, FLatentActionInfo LatentInfo)
+{
+	using namespace BPConverterTestLibraryImpl;
+
+	UWorld* World = GEngine ? GEngine->GetWorldFromContextObject(WorldContextObject, EGetWorldErrorMode::LogAndReturnNull) : nullptr;
+	if (World)
+	{
+		FLatentActionManager& LatentActionManager = World->GetLatentActionManager();
+		if (!LatentActionManager.FindExistingAction<FLatentOutputAction>(LatentInfo.CallbackTarget, LatentInfo.UUID))
+		{
+			LatentActionManager.AddNewAction(LatentInfo.CallbackTarget, LatentInfo.UUID, new FLatentOutputAction(Output, LatentInfo));
+		}
+	}
+}
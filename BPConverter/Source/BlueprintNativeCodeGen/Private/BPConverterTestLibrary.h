@@ -0,0 +1,24 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "UObject/ObjectMacros.h"
+#include "Engine/LatentActionManager.h"
+#include "Kismet/BlueprintFunctionLibrary.h"
+#include "BPConverterTestLibrary.generated.h"
+
+/**
+ * Functions called by the Blueprints that the converter tests build in memory
+ * (see BPUberGraphVariablesTests.cpp). Engine functions don't cover every shape.
+ */
+UCLASS()
+class UBPConverterTestLibrary : public UBlueprintFunctionLibrary
+{
+	GENERATED_BODY()
+
+public:
+	/** Latent function with an output, the output is written when the action completes (on the next update). */
+	UFUNCTION(BlueprintCallable, meta = (Latent, LatentInfo = "LatentInfo", WorldContext = "WorldContextObject"))
+	static void LatentOutput(const UObject* WorldContextObject, int32& Output, FLatentActionInfo LatentInfo);
+};
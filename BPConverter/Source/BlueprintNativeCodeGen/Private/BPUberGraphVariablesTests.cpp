@@ -0,0 +1,121 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "CoreMinimal.h"
+#include "Misc/AutomationTest.h"
+#include "Misc/PackageName.h"
+#include "Misc/ScopeExit.h"
+#include "UObject/Package.h"
+#include "UObject/UnrealType.h"
+#include "GameFramework/Actor.h"
+#include "Engine/Blueprint.h"
+#include "Engine/BlueprintGeneratedClass.h"
+#include "EdGraph/EdGraph.h"
+#include "EdGraphSchema_K2.h"
+#include "K2Node_CallFunction.h"
+#include "K2Node_CustomEvent.h"
+#include "Kismet2/BlueprintEditorUtils.h"
+#include "Kismet2/KismetEditorUtilities.h"
+#include "IBlueprintCompilerCppBackendModule.h"
+#include "BlueprintNativeCodeGenUtils.h"
+#include "BPConverterTestLibrary.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+/*******************************************************************************
+ * BPUberGraphVariablesTestsImpl
+ ******************************************************************************/
+
+namespace BPUberGraphVariablesTestsImpl
+{
+	/** An actor Blueprint, its event graph calls UBPConverterTestLibrary::LatentOutput and doesn't connect the output. */
+	static UBlueprint* CreateLatentOutputBlueprint();
+
+	/** The ubergraph variable that holds the output of the call, the latent action writes it when it completes. */
+	static const FProperty* FindLatentOutputVariable(const UClass* GeneratedClass);
+}
+
+//------------------------------------------------------------------------------
+static UBlueprint* BPUberGraphVariablesTestsImpl::CreateLatentOutputBlueprint()
+{
+	// the converter refuses Blueprints from the transient package
+	const FName PackageName = MakeUniqueObjectName(nullptr, UPackage::StaticClass(), TEXT("/Temp/BPUberGraphVariablesTests/BP_LatentOutput"));
+	UPackage* Package = CreatePackage(*PackageName.ToString());
+	UBlueprint* Blueprint = FKismetEditorUtilities::CreateBlueprint(AActor::StaticClass(), Package, *FPackageName::GetShortName(PackageName)
+		, BPTYPE_Normal, UBlueprint::StaticClass(), UBlueprintGeneratedClass::StaticClass());
+	check(Blueprint);
+
+	UEdGraph* EventGraph = FBlueprintEditorUtils::FindEventGraph(Blueprint);
+	check(EventGraph);
+
+	FGraphNodeCreator<UK2Node_CustomEvent> EventNodeCreator(*EventGraph);
+	UK2Node_CustomEvent* EventNode = EventNodeCreator.CreateNode();
+	EventNode->CustomFunctionName = TEXT("LatentOutputEvent");
+	EventNodeCreator.Finalize();
+
+	FGraphNodeCreator<UK2Node_CallFunction> LatentNodeCreator(*EventGraph);
+	UK2Node_CallFunction* LatentNode = LatentNodeCreator.CreateNode();
+	LatentNode->SetFromFunction(UBPConverterTestLibrary::StaticClass()->FindFunctionByName(GET_FUNCTION_NAME_CHECKED(UBPConverterTestLibrary, LatentOutput)));
+	LatentNodeCreator.Finalize();
+
+	// the output pin stays unconnected, nothing reads it after the resume
+	ensure(GetDefault<UEdGraphSchema_K2>()->TryCreateConnection(EventNode->FindPinChecked(UEdGraphSchema_K2::PN_Then), LatentNode->GetExecPin()));
+
+	FBlueprintEditorUtils::MarkBlueprintAsStructurallyModified(Blueprint);
+	FKismetEditorUtilities::CompileBlueprint(Blueprint, EBlueprintCompileOptions::SkipGarbageCollection);
+	return Blueprint;
+}
+
+//------------------------------------------------------------------------------
+static const FProperty* BPUberGraphVariablesTestsImpl::FindLatentOutputVariable(const UClass* GeneratedClass)
+{
+	const FString OutputName = FString::Printf(TEXT("%s_Output"), *GET_FUNCTION_NAME_CHECKED(UBPConverterTestLibrary, LatentOutput).ToString());
+	for (TFieldIterator<FProperty> It(GeneratedClass, EFieldIteratorFlags::ExcludeSuper); It; ++It)
+	{
+		if (It->HasAllPropertyFlags(CPF_Transient | CPF_DuplicateTransient) && It->GetName().EndsWith(OutputName))
+		{
+			return *It;
+		}
+	}
+	return nullptr;
+}
+
+/*******************************************************************************
+ * Tests
+ ******************************************************************************/
+
+static const uint32 UberGraphVariablesTestFlags = EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter;
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FBPUberGraphVariablesLatentOutputTest, "Project.Blueprints.NativeBackend.UberGraphVariables.LatentOutput", UberGraphVariablesTestFlags)
+bool FBPUberGraphVariablesLatentOutputTest::RunTest(const FString& Parameters)
+{
+	using namespace BPUberGraphVariablesTestsImpl;
+
+	UBlueprint* Blueprint = CreateLatentOutputBlueprint();
+	ON_SCOPE_EXIT
+	{
+		Blueprint->GetOutermost()->MarkAsGarbage();
+		Blueprint->MarkAsGarbage();
+		CollectGarbage(GARBAGE_COLLECTION_KEEPFLAGS);
+	};
+	if (!TestTrue(TEXT("Test Blueprint compiles"), (Blueprint->Status != BS_Error) && (Blueprint->GeneratedClass != nullptr)))
+	{
+		return false;
+	}
+
+	const FProperty* OutputVariable = FindLatentOutputVariable(Blueprint->GeneratedClass);
+	if (!TestNotNull(TEXT("Ubergraph variable of the latent output"), OutputVariable))
+	{
+		return false;
+	}
+
+	TSharedPtr<FString> HeaderSource(new FString());
+	TSharedPtr<FString> CppSource(new FString());
+	TSharedPtr<FNativizationSummary> NativizationSummary(new FNativizationSummary());
+	FBlueprintNativeCodeGenUtils::GenerateCppCode(Blueprint->GeneratedClass, HeaderSource, CppSource, NativizationSummary, FCompilerNativizationOptions{});
+
+	// Promoted to a local of the event function, the latent action would write into a dead stack slot
+	TestTrue(TEXT("The latent output stays a member of the class"), HeaderSource->Contains(OutputVariable->GetName(), ESearchCase::CaseSensitive));
+	return true;
+}
+
+#endif // WITH_DEV_AUTOMATION_TESTS
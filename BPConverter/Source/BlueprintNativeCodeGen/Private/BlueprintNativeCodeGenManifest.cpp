@@ -441,21 +441,24 @@ FString FBlueprintNativeCodeGenPaths::RuntimePCHFilename() const
 
 //------------------------------------------------------------------------------
 FBlueprintNativeCodeGenManifest::FBlueprintNativeCodeGenManifest(int32 ManifestId)
-	: ManifestChunkId(ManifestId)
+	: ManifestVersion(CurrentManifestVersion)
+	, ManifestChunkId(ManifestId)
 {
 	InitDestPaths(FBlueprintNativeCodeGenPaths::GetDefaultPluginPath(NAME_None));
 }
 
 //------------------------------------------------------------------------------
 FBlueprintNativeCodeGenManifest::FBlueprintNativeCodeGenManifest(const FCompilerNativizationOptions& InCompilerNativizationOptions, int32 ManifestId)
-	: ManifestChunkId(ManifestId)
+	: ManifestVersion(CurrentManifestVersion)
+	, ManifestChunkId(ManifestId)
 	, NativizationOptions(InCompilerNativizationOptions)
 {
 	InitDestPaths(FBlueprintNativeCodeGenPaths::GetDefaultPluginPath(InCompilerNativizationOptions.PlatformName));
 }
 
 FBlueprintNativeCodeGenManifest::FBlueprintNativeCodeGenManifest(const FString& PluginPath, const FCompilerNativizationOptions& InCompilerNativizationOptions, int32 ManifestId)
-	: ManifestChunkId(ManifestId)
+	: ManifestVersion(CurrentManifestVersion)
+	, ManifestChunkId(ManifestId)
 	, NativizationOptions(InCompilerNativizationOptions)
 {
 	InitDestPaths(PluginPath);
@@ -463,6 +466,7 @@ FBlueprintNativeCodeGenManifest::FBlueprintNativeCodeGenManifest(const FString&
 
 //------------------------------------------------------------------------------
 FBlueprintNativeCodeGenManifest::FBlueprintNativeCodeGenManifest(const FString& ManifestFilePathIn)
+	: ManifestVersion(0)
 {
 	ensureAlwaysMsgf( BlueprintNativeCodeGenManifestImpl::LoadManifest(ManifestFilePathIn, this), TEXT("Missing Manifest for Blueprint code generation: %s"), *ManifestFilePathIn);
 }
@@ -494,6 +498,13 @@ FConvertedAssetRecord& FBlueprintNativeCodeGenManifest::CreateConversionRecord(c
 	return *ConversionRecord;
 }
 
+//------------------------------------------------------------------------------
+FConvertedAssetRecord& FBlueprintNativeCodeGenManifest::ReuseConversionRecord(const FAssetId Key, const FConvertedAssetRecord& PreviousRecord)
+{
+	check(UnconvertedDependencies.Find(Key) == nullptr);
+	return ConvertedAssets.Add(Key, PreviousRecord);
+}
+
 //------------------------------------------------------------------------------
 FUnconvertedDependencyRecord& FBlueprintNativeCodeGenManifest::CreateUnconvertedDependencyRecord(const FAssetId UnconvertedAssetKey, const FAssetData& AssetInfo)
 {
@@ -522,6 +533,34 @@ void FBlueprintNativeCodeGenManifest::AddSingleModuleDependency(UPackage* Packag
 	ModuleDependencies.AddUnique(Package);
 }
 
+//------------------------------------------------------------------------------
+void FBlueprintNativeCodeGenManifest::RecordGlobalDependencies(const FNativizationSummary& NativizationSummary)
+{
+	GlobalDependencies.Reset();
+	GlobalDependencies.SetNum(NativizationSummary.DependenciesGlobalMap.Num());
+	for (const TPair<FSoftObjectPath, FNativizationSummary::FDependencyRecord>& Entry : NativizationSummary.DependenciesGlobalMap)
+	{
+		if (ensure(GlobalDependencies.IsValidIndex(Entry.Value.Index)))
+		{
+			FNativizedDependencyRecord& Record = GlobalDependencies[Entry.Value.Index];
+			Record.ObjectPath = Entry.Key.ToString();
+			Record.ObjectRefStrings = Entry.Value.ObjectRefStrings;
+		}
+	}
+}
+
+//------------------------------------------------------------------------------
+void FBlueprintNativeCodeGenManifest::RestoreGlobalDependencies(FNativizationSummary& NativizationSummary) const
+{
+	check(NativizationSummary.DependenciesGlobalMap.Num() == 0);
+	for (int32 Index = 0; Index < GlobalDependencies.Num(); ++Index)
+	{
+		FNativizationSummary::FDependencyRecord& Record = NativizationSummary.DependenciesGlobalMap.Add(FSoftObjectPath(GlobalDependencies[Index].ObjectPath));
+		Record.ObjectRefStrings = GlobalDependencies[Index].ObjectRefStrings;
+		Record.Index = Index;
+	}
+}
+
 //------------------------------------------------------------------------------
 bool FBlueprintNativeCodeGenManifest::Save() const
 {
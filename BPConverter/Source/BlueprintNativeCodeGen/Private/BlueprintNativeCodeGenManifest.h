@@ -10,6 +10,7 @@
 
 struct FAssetData;
 struct FBlueprintNativeCodeGenPaths;
+struct FNativizationSummary;
 
 /*******************************************************************************
  * FCodeGenAssetRecord
@@ -38,6 +39,29 @@ public:
 
 	UPROPERTY()
 	FString GeneratedCppPath;
+
+	/** Hash of everything the generated files depend on (see FBlueprintNativeCodeGenUtils::ComputeConversionHash). Empty when unknown. */
+	UPROPERTY()
+	FString ConversionHash;
+};
+
+/*******************************************************************************
+ * FNativizedDependencyRecord
+ ******************************************************************************/
+
+/** An entry of the global dependency table, which the generated code refers to by index. */
+USTRUCT()
+struct FNativizedDependencyRecord
+{
+	GENERATED_USTRUCT_BODY()
+
+public:
+	UPROPERTY()
+	FString ObjectPath;
+
+	/** The FBlueprintDependencyObjectRef arguments (see FNativizationSummary::FDependencyRecord). */
+	UPROPERTY()
+	TArray<FString> ObjectRefStrings;
 };
 
 /*******************************************************************************
@@ -141,6 +165,16 @@ public:
 	 */
 	FConvertedAssetRecord& CreateConversionRecord(const FAssetId Key, const FAssetData& AssetInfo);
 
+	/**
+	 * Copies a record from a previous conversion, whose generated files are 
+	 * still up to date (so the asset doesn't have to be converted again).
+	 * 
+	 * @param  Key				Identifies the asset.
+	 * @param  PreviousRecord	The record stored in the previous manifest.
+	 * @return The record added to this manifest.
+	 */
+	FConvertedAssetRecord& ReuseConversionRecord(const FAssetId Key, const FConvertedAssetRecord& PreviousRecord);
+
 	/**
 	 * 
 	 * 
@@ -180,6 +214,27 @@ public:
 	 */
 	const FUnconvertedRecord& GetUnconvertedDependencies() const { return UnconvertedDependencies; }
 
+	/**
+	 * @return The record of the specified asset, or null if the asset was not converted.
+	 */
+	const FConvertedAssetRecord* FindConversionRecord(const FAssetId Key) const { return ConvertedAssets.Find(Key); }
+
+	/**
+	 * Stores the global dependency table, so the indices used by the generated
+	 * code can be restored by an incremental conversion.
+	 * 
+	 * @param  NativizationSummary    The summary filled out by the backend.
+	 */
+	void RecordGlobalDependencies(const FNativizationSummary& NativizationSummary);
+
+	/**
+	 * Fills out the global dependency table of the summary with the entries 
+	 * recorded by RecordGlobalDependencies(), keeping their indices.
+	 * 
+	 * @param  NativizationSummary    The summary that the backend will continue to fill out.
+	 */
+	void RestoreGlobalDependencies(FNativizationSummary& NativizationSummary) const;
+
 	/**
 	 * @return compiler nativization options
 	 */
@@ -201,6 +256,11 @@ public:
 	/** */
 	int32 GetManifestChunkId() const { return ManifestChunkId; }
 
+	/**
+	 * @return False if this manifest was saved by an older converter, so its records cannot be reused.
+	 */
+	bool IsCurrentVersion() const { return ManifestVersion == CurrentManifestVersion; }
+
 private:
 	/**
 	 * 
@@ -219,6 +279,13 @@ private:
 	void Clear();
 
 private:
+	/** Bump when the layout of the manifest records changes. */
+	static const int32 CurrentManifestVersion = 1;
+
+	/** CurrentManifestVersion at the time this manifest was saved (0 for manifests that predate the version). */
+	UPROPERTY()
+	int32 ManifestVersion;
+
 	/** To uniquely identify related manifests (split between child cook processes), so the files remain distinct. */
 	UPROPERTY()
 	int32 ManifestChunkId;
@@ -242,4 +309,8 @@ private:
 
 	UPROPERTY()
 	FCompilerNativizationOptions NativizationOptions;
+
+	/** The global dependency table, ordered by index. */
+	UPROPERTY()
+	TArray<FNativizedDependencyRecord> GlobalDependencies;
 };
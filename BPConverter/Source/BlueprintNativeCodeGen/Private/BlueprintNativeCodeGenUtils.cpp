@@ -4,7 +4,9 @@
 #include "BlueprintCompilationManager.h"
 #include "Engine/Blueprint.h"
 #include "HAL/FileManager.h"
+#include "Misc/FileHelper.h"
 #include "Misc/Paths.h"
+#include "Misc/PackageName.h"
 #include "Misc/ConfigCacheIni.h"
 #include "Misc/App.h"
 #include "Engine/UserDefinedEnum.h"
@@ -23,11 +25,19 @@
 #include "Interfaces/IPluginManager.h"
 #include "KismetCompiler.h"
 #include "Kismet2/CompilerResultsLog.h"
+#include "BlueprintCompilerCppBackendGatherDependencies.h"
+#include "BlueprintCompilerCppBackendBytecode.h"
+#include "Hash/Blake3.h"
+#include "IO/IoHash.h"
+#include "ProfilingDebugging/CountersTrace.h"
 
 #include "BPConverterDebugHelper.h"
 
 DEFINE_LOG_CATEGORY(LogBlueprintCodeGen)
 
+TRACE_DECLARE_INT_COUNTER(BPConverter_FilesWritten, TEXT("BPConverter/FilesWritten"));
+TRACE_DECLARE_INT_COUNTER(BPConverter_FilesUnchanged, TEXT("BPConverter/FilesUnchanged"));
+
 class FKismetCompilerContextExt : public FKismetCompilerContext
 {
 public:
@@ -44,6 +54,9 @@ namespace BlueprintNativeCodeGenUtilsImpl
 	static FString EngineModuleName = TEXT("Engine");
 	static FString EngineHeaderFile = TEXT("Engine.h");
 
+	// Bump when the generated code changes, so incremental conversions don't reuse files generated by an older converter.
+	static const int32 ConverterVersion = 2;
+
 	// Used to cache the set of plugin dependencies.
 	static TSet<FString> PluginDependencies;
 	
@@ -51,9 +64,10 @@ namespace BlueprintNativeCodeGenUtilsImpl
 	 * Creates and fills out a new .uplugin file for the converted assets.
 	 * 
 	 * @param  TargetPaths	Defines the file path/name for the plugin file.
+	 * @param  FileWriter	Saves the file (if it changed).
 	 * @return True if the file was successfully saved, otherwise false.
 	 */
-	static bool GeneratePluginDescFile(const FBlueprintNativeCodeGenPaths& TargetPaths);
+	static bool GeneratePluginDescFile(const FBlueprintNativeCodeGenPaths& TargetPaths, FBlueprintNativeCodeGenFileWriter& FileWriter);
 
 	/**
 	 * Creates a module implementation and header file for the converted assets'
@@ -62,17 +76,19 @@ namespace BlueprintNativeCodeGenUtilsImpl
 	 * 
 	 * @param  TargetPaths    Defines the file path/name for the target files.
 	 * @param  bExcludeMonolithicEngineHeaders	Whether or not to exclude monolithic engine headers.
+	 * @param  FileWriter	Saves the files (if they changed).
 	 * @return True if the files were successfully generated, otherwise false.
 	 */
-	static bool GenerateModuleSourceFiles(const FBlueprintNativeCodeGenPaths& TargetPaths, bool bExcludeMonolithicEngineHeaders);
+	static bool GenerateModuleSourceFiles(const FBlueprintNativeCodeGenPaths& TargetPaths, bool bExcludeMonolithicEngineHeaders, FBlueprintNativeCodeGenFileWriter& FileWriter);
 
 	/**
 	 * Creates and fills out a new .Build.cs file for the plugin's runtime module.
 	 * 
 	 * @param  Manifest    Defines where the module file should be saved, what it should be named, etc..
+	 * @param  FileWriter  Saves the file (if it changed).
 	 * @return True if the file was successfully saved, otherwise false.
 	 */
-	static bool GenerateModuleBuildFile(const FBlueprintNativeCodeGenManifest& Manifest);
+	static bool GenerateModuleBuildFile(const FBlueprintNativeCodeGenManifest& Manifest, FBlueprintNativeCodeGenFileWriter& FileWriter);
 
 	/**
 	 * Determines what the expected native class will be for an asset that was  
@@ -86,11 +102,21 @@ namespace BlueprintNativeCodeGenUtilsImpl
 	/** */
 	static FString NativizedDependenciesFileName() { return TEXT("NativizedAssets_Dependencies"); }
 	/** */
-	static bool GenerateNativizedDependenciesSourceFiles(const FBlueprintNativeCodeGenPaths& TargetPaths, bool bExcludeMonolithicEngineHeaders);
+	static bool GenerateNativizedDependenciesSourceFiles(const FBlueprintNativeCodeGenPaths& TargetPaths, bool bExcludeMonolithicEngineHeaders, FBlueprintNativeCodeGenFileWriter& FileWriter);
+
+	/**
+	 * Deletes the source files in the runtime module, that belong neither to
+	 * an asset in the manifest, nor to the module itself (left over from 
+	 * assets that are not converted anymore).
+	 * 
+	 * @param  Manifest    The manifest containing lists of converted files.
+	 * @param  FileWriter  Deletes the files.
+	 */
+	static void DeleteStaleSourceFiles(const FBlueprintNativeCodeGenManifest& Manifest, const FBlueprintNativeCodeGenManifest& PreviousManifest, FBlueprintNativeCodeGenFileWriter& FileWriter);
 }
 
 //------------------------------------------------------------------------------
-static bool BlueprintNativeCodeGenUtilsImpl::GeneratePluginDescFile(const FBlueprintNativeCodeGenPaths& TargetPaths)
+static bool BlueprintNativeCodeGenUtilsImpl::GeneratePluginDescFile(const FBlueprintNativeCodeGenPaths& TargetPaths, FBlueprintNativeCodeGenFileWriter& FileWriter)
 {
 	FPluginDescriptor PluginDesc;
 	
@@ -191,16 +217,18 @@ static bool BlueprintNativeCodeGenUtilsImpl::GeneratePluginDescFile(const FBluep
 		}
 	}
 	
-	bool bSuccess = PluginDesc.Save(FilePath, ErrorMessage);
+	FString PluginDescText;
+	PluginDesc.Write(PluginDescText);
+	bool bSuccess = FileWriter.WriteFile(FilePath, PluginDescText);
 	if (!bSuccess)
 	{
-		UE_LOG(LogBlueprintCodeGen, Error, TEXT("Failed to generate the plugin description file: %s"), *ErrorMessage.ToString());
+		UE_LOG(LogBlueprintCodeGen, Error, TEXT("Failed to generate the plugin description file: %s"), *FilePath);
 	}
 	return bSuccess;
 }
 
 //------------------------------------------------------------------------------
-static bool BlueprintNativeCodeGenUtilsImpl::GenerateModuleSourceFiles(const FBlueprintNativeCodeGenPaths& TargetPaths, bool bExcludeMonolithicEngineHeaders)
+static bool BlueprintNativeCodeGenUtilsImpl::GenerateModuleSourceFiles(const FBlueprintNativeCodeGenPaths& TargetPaths, bool bExcludeMonolithicEngineHeaders, FBlueprintNativeCodeGenFileWriter& FileWriter)
 {
 	FText FailureReason;
 
@@ -217,13 +245,18 @@ static bool BlueprintNativeCodeGenUtilsImpl::GenerateModuleSourceFiles(const FBl
 	GConfig->GetArray(TEXT("BlueprintNativizationSettings"), TEXT("FilesToIncludeInModuleHeader"), FilesToIncludeInModuleHeader, GEditorIni);
 	PchIncludes.Append(FilesToIncludeInModuleHeader);
 
-	bool bSuccess = GameProjectUtils::GeneratePluginModuleHeaderFile(TargetPaths.RuntimeModuleFile(FBlueprintNativeCodeGenPaths::HFile), PchIncludes, FailureReason);
+	bool bSuccess = FileWriter.WriteGeneratedFile(TargetPaths.RuntimeModuleFile(FBlueprintNativeCodeGenPaths::HFile), [&](const FString& StagingFilePath)
+	{
+		return GameProjectUtils::GeneratePluginModuleHeaderFile(StagingFilePath, PchIncludes, FailureReason);
+	});
 
 	if (bSuccess)
 	{
 		const FString NoStartupCode = TEXT("");
-		bSuccess &= GameProjectUtils::GeneratePluginModuleCPPFile(TargetPaths.RuntimeModuleFile(FBlueprintNativeCodeGenPaths::CppFile),
-			TargetPaths.RuntimeModuleName(), NoStartupCode, FailureReason);
+		bSuccess &= FileWriter.WriteGeneratedFile(TargetPaths.RuntimeModuleFile(FBlueprintNativeCodeGenPaths::CppFile), [&](const FString& StagingFilePath)
+		{
+			return GameProjectUtils::GeneratePluginModuleCPPFile(StagingFilePath, TargetPaths.RuntimeModuleName(), NoStartupCode, FailureReason);
+		});
 	}
 
 	if (!bSuccess)
@@ -234,9 +267,8 @@ static bool BlueprintNativeCodeGenUtilsImpl::GenerateModuleSourceFiles(const FBl
 }
 
 //------------------------------------------------------------------------------
-static bool BlueprintNativeCodeGenUtilsImpl::GenerateNativizedDependenciesSourceFiles(const FBlueprintNativeCodeGenPaths& TargetPaths, bool bExcludeMonolithicEngineHeaders)
+static bool BlueprintNativeCodeGenUtilsImpl::GenerateNativizedDependenciesSourceFiles(const FBlueprintNativeCodeGenPaths& TargetPaths, bool bExcludeMonolithicEngineHeaders, FBlueprintNativeCodeGenFileWriter& FileWriter)
 {
-	FText FailureReason;
 	bool bSuccess = true;
 
 	IBlueprintCompilerCppBackendModule& CodeGenBackend = (IBlueprintCompilerCppBackendModule&)IBlueprintCompilerCppBackendModule::Get();
@@ -245,24 +277,24 @@ static bool BlueprintNativeCodeGenUtilsImpl::GenerateNativizedDependenciesSource
 	{
 		const FString HeaderFilePath = FPaths::Combine(*TargetPaths.RuntimeSourceDir(FBlueprintNativeCodeGenPaths::HFile), *BaseFilename) + TEXT(".h");
 		const FString HeaderFileContent = CodeGenBackend.DependenciesGlobalMapHeaderCode();
-		bSuccess &= GameProjectUtils::WriteOutputFile(HeaderFilePath, HeaderFileContent, FailureReason);
+		bSuccess &= FileWriter.WriteFile(HeaderFilePath, HeaderFileContent);
 	}
 
 	{
 		const FString SourceFilePath = FPaths::Combine(*TargetPaths.RuntimeSourceDir(FBlueprintNativeCodeGenPaths::CppFile), *BaseFilename) + TEXT(".cpp");
 		const FString SourceFileContent = CodeGenBackend.DependenciesGlobalMapBodyCode(bExcludeMonolithicEngineHeaders ? BaseFilename : TargetPaths.RuntimeModuleName());
-		bSuccess &= GameProjectUtils::WriteOutputFile(SourceFilePath, SourceFileContent, FailureReason);
+		bSuccess &= FileWriter.WriteFile(SourceFilePath, SourceFileContent);
 	}
 
 	if (!bSuccess)
 	{
-		UE_LOG(LogBlueprintCodeGen, Error, TEXT("Failed to generate NativizedDependencies source files: %s"), *FailureReason.ToString());
+		UE_LOG(LogBlueprintCodeGen, Error, TEXT("Failed to generate NativizedDependencies source files."));
 	}
 	return bSuccess;
 }
 
 //------------------------------------------------------------------------------
-static bool BlueprintNativeCodeGenUtilsImpl::GenerateModuleBuildFile(const FBlueprintNativeCodeGenManifest& Manifest)
+static bool BlueprintNativeCodeGenUtilsImpl::GenerateModuleBuildFile(const FBlueprintNativeCodeGenManifest& Manifest, FBlueprintNativeCodeGenFileWriter& FileWriter)
 {
 	FModuleManager& ModuleManager = FModuleManager::Get();
 
@@ -352,8 +384,11 @@ static bool BlueprintNativeCodeGenUtilsImpl::GenerateModuleBuildFile(const FBlue
 	FBlueprintNativeCodeGenPaths TargetPaths = Manifest.GetTargetPaths();
 	
 	FText ErrorMessage;
-	bool bSuccess = GameProjectUtils::GeneratePluginModuleBuildFile(TargetPaths.RuntimeBuildFile(), TargetPaths.RuntimeModuleName(),
-		PublicDependencies, PrivateDependencies, ErrorMessage, Manifest.GetCompilerNativizationOptions().bExcludeMonolithicHeaders);
+	bool bSuccess = FileWriter.WriteGeneratedFile(TargetPaths.RuntimeBuildFile(), [&](const FString& StagingFilePath)
+	{
+		return GameProjectUtils::GeneratePluginModuleBuildFile(StagingFilePath, TargetPaths.RuntimeModuleName(),
+			PublicDependencies, PrivateDependencies, ErrorMessage, Manifest.GetCompilerNativizationOptions().bExcludeMonolithicHeaders);
+	});
 
 	if (!bSuccess)
 	{
@@ -362,6 +397,48 @@ static bool BlueprintNativeCodeGenUtilsImpl::GenerateModuleBuildFile(const FBlue
 	return bSuccess;
 }
 
+//------------------------------------------------------------------------------
+static void BlueprintNativeCodeGenUtilsImpl::DeleteStaleSourceFiles(const FBlueprintNativeCodeGenManifest& Manifest, const FBlueprintNativeCodeGenManifest& PreviousManifest, FBlueprintNativeCodeGenFileWriter& FileWriter)
+{
+	// A run can convert a subset of the assets (-Assets=, -Folders=), so a record missing from the current manifest 
+	// doesn't make its files stale. Only the files of assets that were deleted (or renamed) since are removed.
+	auto IsStale = [&Manifest](const FName AssetId, bool bConverted) -> bool
+	{
+		const bool bStillRecorded = bConverted ? (Manifest.FindConversionRecord(AssetId) != nullptr) : Manifest.GetUnconvertedDependencies().Contains(AssetId);
+		return !bStillRecorded && !FPackageName::DoesPackageExist(AssetId.ToString());
+	};
+
+	TSet<FString> StaleFiles;
+	for (const TPair<FName, FConvertedAssetRecord>& Entry : PreviousManifest.GetConversionRecord())
+	{
+		if (IsStale(Entry.Key, /*bConverted =*/true))
+		{
+			StaleFiles.Add(FBlueprintNativeCodeGenFileWriter::GetComparablePath(Entry.Value.GeneratedHeaderPath));
+			StaleFiles.Add(FBlueprintNativeCodeGenFileWriter::GetComparablePath(Entry.Value.GeneratedCppPath));
+		}
+	}
+	for (const TPair<FName, FUnconvertedDependencyRecord>& Entry : PreviousManifest.GetUnconvertedDependencies())
+	{
+		if (IsStale(Entry.Key, /*bConverted =*/false))
+		{
+			StaleFiles.Add(FBlueprintNativeCodeGenFileWriter::GetComparablePath(Entry.Value.GeneratedWrapperPath));
+		}
+	}
+
+	// another asset may have taken over the file name
+	for (const TPair<FName, FConvertedAssetRecord>& Entry : Manifest.GetConversionRecord())
+	{
+		StaleFiles.Remove(FBlueprintNativeCodeGenFileWriter::GetComparablePath(Entry.Value.GeneratedHeaderPath));
+		StaleFiles.Remove(FBlueprintNativeCodeGenFileWriter::GetComparablePath(Entry.Value.GeneratedCppPath));
+	}
+	for (const TPair<FName, FUnconvertedDependencyRecord>& Entry : Manifest.GetUnconvertedDependencies())
+	{
+		StaleFiles.Remove(FBlueprintNativeCodeGenFileWriter::GetComparablePath(Entry.Value.GeneratedWrapperPath));
+	}
+
+	FileWriter.DeleteStaleFiles(StaleFiles);
+}
+
 //------------------------------------------------------------------------------
 static UClass* BlueprintNativeCodeGenUtilsImpl::ResolveReplacementType(const FConvertedAssetRecord& ConversionRecord)
 {
@@ -396,15 +473,19 @@ static UClass* BlueprintNativeCodeGenUtilsImpl::ResolveReplacementType(const FCo
  ******************************************************************************/
 
 //------------------------------------------------------------------------------
-bool FBlueprintNativeCodeGenUtils::FinalizePlugin(const FBlueprintNativeCodeGenManifest& Manifest)
+bool FBlueprintNativeCodeGenUtils::FinalizePlugin(const FBlueprintNativeCodeGenManifest& Manifest, const FBlueprintNativeCodeGenManifest* PreviousManifest, FBlueprintNativeCodeGenFileWriter& FileWriter)
 {
 	bool bSuccess = true;
 	const bool bExcludeMonolithicHeaders = Manifest.GetCompilerNativizationOptions().bExcludeMonolithicHeaders;
 	FBlueprintNativeCodeGenPaths TargetPaths = Manifest.GetTargetPaths();
-	bSuccess = bSuccess && BlueprintNativeCodeGenUtilsImpl::GenerateModuleBuildFile(Manifest);
-	bSuccess = bSuccess && BlueprintNativeCodeGenUtilsImpl::GenerateModuleSourceFiles(TargetPaths, bExcludeMonolithicHeaders);
-	bSuccess = bSuccess && BlueprintNativeCodeGenUtilsImpl::GenerateNativizedDependenciesSourceFiles(TargetPaths, bExcludeMonolithicHeaders);
-	bSuccess = bSuccess && BlueprintNativeCodeGenUtilsImpl::GeneratePluginDescFile(TargetPaths);
+	bSuccess = bSuccess && BlueprintNativeCodeGenUtilsImpl::GenerateModuleBuildFile(Manifest, FileWriter);
+	bSuccess = bSuccess && BlueprintNativeCodeGenUtilsImpl::GenerateModuleSourceFiles(TargetPaths, bExcludeMonolithicHeaders, FileWriter);
+	bSuccess = bSuccess && BlueprintNativeCodeGenUtilsImpl::GenerateNativizedDependenciesSourceFiles(TargetPaths, bExcludeMonolithicHeaders, FileWriter);
+	bSuccess = bSuccess && BlueprintNativeCodeGenUtilsImpl::GeneratePluginDescFile(TargetPaths, FileWriter);
+	if (bSuccess && PreviousManifest)
+	{
+		BlueprintNativeCodeGenUtilsImpl::DeleteStaleSourceFiles(Manifest, *PreviousManifest, FileWriter);
+	}
 	return bSuccess;
 }
 
@@ -430,46 +511,148 @@ public:
 //------------------------------------------------------------------------------
 void FBlueprintNativeCodeGenUtils::GenerateCppCode(UObject* Obj, TSharedPtr<FString> OutHeaderSource, TSharedPtr<FString> OutCppSource, TSharedPtr<FNativizationSummary> NativizationSummary, const FCompilerNativizationOptions& NativizationOptions)
 {
+	BP_CONVERTER_PHASE_SCOPE(GenerateCppCode);
+
 	auto UDEnum = Cast<UUserDefinedEnum>(Obj);
 	auto UDStruct = Cast<UUserDefinedStruct>(Obj);
-	auto BPGC = Cast<UClass>(Obj);
-	auto InBlueprintObj = BPGC ? Cast<UBlueprint>(BPGC->ClassGeneratedBy) : Cast<UBlueprint>(Obj);
 
 	OutHeaderSource->Empty();
 	OutCppSource->Empty();
 
-	if (InBlueprintObj)
+	if (UDEnum || UDStruct)
 	{
-		if (EBlueprintStatus::BS_Error == InBlueprintObj->Status)
+		if (OutHeaderSource.IsValid())
 		{
-			UE_LOG(LogBlueprintCodeGen, Error, TEXT("Cannot convert \"%s\". It has errors."), *InBlueprintObj->GetPathName());
-			return;
+			// TODO @zhouminyi
+			BP_CONVERTER_DEBUG("GenerateCppCodeForEnum and GenerateCppCodeForStruct were removed!");
+
+			//IKismetCompilerInterface& Compiler = FModuleManager::LoadModuleChecked<IKismetCompilerInterface>(KISMET_COMPILER_MODULENAME);
+			//if (UDEnum)
+			//{
+			//	Compiler.GenerateCppCodeForEnum(UDEnum, NativizationOptions, *OutHeaderSource, *OutCppSource);
+			//}
+			//else if (UDStruct)
+			//{
+			//	Compiler.GenerateCppCodeForStruct(UDStruct, NativizationOptions, *OutHeaderSource, *OutCppSource);
+			//}
 		}
+		return;
+	}
+
+	check(OutHeaderSource.IsValid());
+	check(OutCppSource.IsValid());
+	if (TUniquePtr<FPreparedCppCode> PreparedCode = PrepareCppCode(Obj, NativizationSummary, NativizationOptions))
+	{
+		EmitCppCode(*PreparedCode, *OutHeaderSource, *OutCppSource);
+	}
+}
+
+//------------------------------------------------------------------------------
+FBlueprintNativeCodeGenUtils::FPreparedCppCode::FPreparedCppCode()
+	: ClassToEmit(nullptr)
+	, bIsInterface(false)
+	, DuplicateBP(nullptr)
+	, TempPackage(nullptr)
+{
+}
+
+//------------------------------------------------------------------------------
+FBlueprintNativeCodeGenUtils::FPreparedCppCode::~FPreparedCppCode()
+{
+	check(IsInGameThread());
+
+	// the backend refers to the terms of the functions
+	Backend.Reset();
+	// the function contexts refer to the compiler context and to the translator
+	TranslatedFunctions.Empty();
+	CompilerContext.Reset();
+
+	if (DuplicateBP)
+	{
+		IKismetCompilerInterface& Compiler = FModuleManager::LoadModuleChecked<IKismetCompilerInterface>(KISMET_COMPILER_MODULENAME);
+		Compiler.RemoveBlueprintGeneratedClasses(DuplicateBP);
+
+		DuplicateBP->RemoveFromRoot();
+		DuplicateBP->MarkAsGarbage();
+	}
+	if (TempPackage)
+	{
+		TempPackage->RemoveFromRoot();
+		TempPackage->MarkAsGarbage();
+	}
+}
+
+//------------------------------------------------------------------------------
+TIndirectArray<FKismetFunctionContext>& FBlueprintNativeCodeGenUtils::FPreparedCppCode::GetFunctions()
+{
+	return CompilerContext.IsValid()
+		? TFunctionListAccessor<FKismetCompilerContext>::Get(*CompilerContext.Get())
+		: TranslatedFunctions;
+}
+
+//------------------------------------------------------------------------------
+TUniquePtr<FBlueprintNativeCodeGenUtils::FPreparedCppCode> FBlueprintNativeCodeGenUtils::PrepareCppCode(UObject* Obj, TSharedPtr<FNativizationSummary> NativizationSummary, const FCompilerNativizationOptions& NativizationOptions)
+{
+	check(IsInGameThread());
+
+	auto BPGC = Cast<UClass>(Obj);
+	auto InBlueprintObj = BPGC ? Cast<UBlueprint>(BPGC->ClassGeneratedBy) : Cast<UBlueprint>(Obj);
+	if (!InBlueprintObj)
+	{
+		ensure(false);
+		return nullptr;
+	}
+
+	if (EBlueprintStatus::BS_Error == InBlueprintObj->Status)
+	{
+		UE_LOG(LogBlueprintCodeGen, Error, TEXT("Cannot convert \"%s\". It has errors."), *InBlueprintObj->GetPathName());
+		return nullptr;
+	}
+
+	check(InBlueprintObj->GetOutermost() != GetTransientPackage());
+	if (!ensureMsgf(InBlueprintObj->GeneratedClass, TEXT("Invalid generated class for %s"), *InBlueprintObj->GetName()))
+	{
+		return nullptr;
+	}
+
+	IBlueprintCompilerCppBackendModule& CodeGenBackend = (IBlueprintCompilerCppBackendModule&)IBlueprintCompilerCppBackendModule::Get();
+	// set before anything is done, so all the phases are accounted in the summary
+	CodeGenBackend.NativizationSummary() = NativizationSummary;
+
+	FDisableGatheringDataOnScope DisableFib;
+
+	TUniquePtr<FPreparedCppCode> PreparedCode = MakeUnique<FPreparedCppCode>();
+	PreparedCode->bIsInterface = (EBlueprintType::BPTYPE_Interface == InBlueprintObj->BlueprintType);
+	PreparedCode->NativizationOptions = NativizationOptions;
 
-		check(InBlueprintObj->GetOutermost() != GetTransientPackage());
-		if (!ensureMsgf(InBlueprintObj->GeneratedClass, TEXT("Invalid generated class for %s"), *InBlueprintObj->GetName()))
+	// Classes without an ubergraph can be converted from their bytecode, skipping the duplication and the recompilation
+	if (FBlueprintBytecodeTranslator::IsEnabled() && BPGC)
+	{
+		PreparedCode->Translator = MakeUnique<FBlueprintBytecodeTranslator>(CastChecked<UBlueprintGeneratedClass>(InBlueprintObj->GeneratedClass));
+		if (PreparedCode->Translator->Translate(PreparedCode->TranslatedFunctions))
 		{
-			return;
+			PreparedCode->ClassToEmit = InBlueprintObj->GeneratedClass;
 		}
-		check(OutHeaderSource.IsValid());
-		check(OutCppSource.IsValid());
-
-		FDisableGatheringDataOnScope DisableFib;
+		else
+		{
+			UE_LOG(LogBlueprintCodeGen, Verbose, TEXT("Cannot translate the bytecode of \"%s\" (%s). It will be recompiled."), *InBlueprintObj->GetPathName(), *PreparedCode->Translator->GetFailureReason());
+			PreparedCode->TranslatedFunctions.Empty();
+			PreparedCode->Translator.Reset();
+		}
+	}
 
+	if (!PreparedCode->ClassToEmit)
+	{
 		const FString TempPackageName = FString::Printf(TEXT("%s%s"), TEXT("/Temp/__TEMP_BP__"), *InBlueprintObj->GetOutermost()->GetPathName());
 		UPackage* TempPackage = CreatePackage(*TempPackageName);
 		check(TempPackage);
-
-		ON_SCOPE_EXIT
-		{
-			TempPackage->RemoveFromRoot();
-			TempPackage->MarkAsGarbage();
-		};
+		PreparedCode->TempPackage = TempPackage;
 
 		TextNamespaceUtil::ForcePackageNamespace(TempPackage, TextNamespaceUtil::GetPackageNamespace(InBlueprintObj));
 
 		UBlueprint* DuplicateBP = nullptr;
 		{
+			BP_CONVERTER_PHASE_SCOPE(DuplicateBlueprint);
 			FBlueprintDuplicationScopeFlags BPDuplicationFlags(FBlueprintDuplicationScopeFlags::NoExtraCompilation
 				| FBlueprintDuplicationScopeFlags::TheSameTimelineGuid
 				| FBlueprintDuplicationScopeFlags::ValidatePinsUsingSourceClass
@@ -477,71 +660,193 @@ void FBlueprintNativeCodeGenUtils::GenerateCppCode(UObject* Obj, TSharedPtr<FStr
 			DuplicateBP = DuplicateObject<UBlueprint>(InBlueprintObj, TempPackage, *InBlueprintObj->GetName());
 		}
 		ensure((nullptr != DuplicateBP->GeneratedClass) && (InBlueprintObj->GeneratedClass != DuplicateBP->GeneratedClass));
-		ON_SCOPE_EXIT
-		{
-			DuplicateBP->RemoveFromRoot();
-			DuplicateBP->MarkAsGarbage();
-		};
-		IBlueprintCompilerCppBackendModule& CodeGenBackend = (IBlueprintCompilerCppBackendModule&)IBlueprintCompilerCppBackendModule::Get();
+		PreparedCode->DuplicateBP = DuplicateBP;
 		CodeGenBackend.GetOriginalClassMap().Add(*DuplicateBP->GeneratedClass, *InBlueprintObj->GeneratedClass);
-		CodeGenBackend.NativizationSummary() = NativizationSummary;
 
+		PreparedCode->ResultsLog = MakeUnique<FCompilerResultsLog>(false);
+
+		FKismetCompilerOptions KismetCompilerOptions;
+		KismetCompilerOptions.bSaveIntermediateProducts = false;
+		KismetCompilerOptions.bRegenerateSkelton = false;
+		KismetCompilerOptions.bIsDuplicationInstigated = false;
+		KismetCompilerOptions.bReinstanceAndStubOnFailure = false;
+		KismetCompilerOptions.bSkipDefaultObjectValidation = false;
+		KismetCompilerOptions.bSkipFiBSearchMetaUpdate = false;
+		KismetCompilerOptions.bUseDeltaSerializationDuringReinstancing = false;
+		KismetCompilerOptions.bSkipNewVariableDefaultsDetection = false;
+
+		PreparedCode->CompilerContext = FKismetCompilerContext::GetCompilerForBP(DuplicateBP, *PreparedCode->ResultsLog, KismetCompilerOptions);
+
+		// Important: this prevents propgating changes to the ClassDefaultObject while it is nullptr during compilation.
+		DuplicateBP->bBeingCompiled = true;
+
+		{
+			BP_CONVERTER_PHASE_SCOPE(CompileClassLayout);
+			PreparedCode->CompilerContext->CompileClassLayout(EInternalCompilerFlags::PostponeLocalsGenerationUntilPhaseTwo);
+		}
 		{
-			FCompilerResultsLog ResultsLog = FCompilerResultsLog(false);
+			BP_CONVERTER_PHASE_SCOPE(CompileFunctions);
+			PreparedCode->CompilerContext->CompileFunctions(EInternalCompilerFlags::PostponeLocalsGenerationUntilPhaseTwo);
+		}
 
-			FKismetCompilerOptions KismetCompilerOptions;
-			KismetCompilerOptions.bSaveIntermediateProducts = false;
-			KismetCompilerOptions.bRegenerateSkelton = false;
-			KismetCompilerOptions.bIsDuplicationInstigated = false;
-			KismetCompilerOptions.bReinstanceAndStubOnFailure = false;
-			KismetCompilerOptions.bSkipDefaultObjectValidation = false;
-			KismetCompilerOptions.bSkipFiBSearchMetaUpdate = false;
-			KismetCompilerOptions.bUseDeltaSerializationDuringReinstancing = false;
-			KismetCompilerOptions.bSkipNewVariableDefaultsDetection = false;
+		DuplicateBP->bBeingCompiled = false;
+		PreparedCode->ClassToEmit = DuplicateBP->GeneratedClass;
+	}
 
-			TSharedPtr<FKismetCompilerContext> CompilerContext = FKismetCompilerContext::GetCompilerForBP(DuplicateBP, ResultsLog, KismetCompilerOptions);
+	// Gathered here, so the emission (that may run on a worker thread) finds them in the cache.
+	FGatherConvertedClassDependencies::CacheDependenciesForEmission(PreparedCode->ClassToEmit, NativizationOptions);
 
-			// Important: this prevents propgating changes to the ClassDefaultObject while it is nullptr during compilation.
-			DuplicateBP->bBeingCompiled = true;
+	// Folding calls library functions, that can't be done on a worker thread
+	PreparedCode->Backend.Reset(IBlueprintCompilerCppBackendModuleInterface::Get().Create());
+	PreparedCode->Backend->FoldConstantCalls(PreparedCode->GetFunctions());
 
-			CompilerContext->CompileClassLayout(EInternalCompilerFlags::PostponeLocalsGenerationUntilPhaseTwo);
-			CompilerContext->CompileFunctions(EInternalCompilerFlags::PostponeLocalsGenerationUntilPhaseTwo);
+	return PreparedCode;
+}
+
+//------------------------------------------------------------------------------
+void FBlueprintNativeCodeGenUtils::EmitCppCode(FPreparedCppCode& PreparedCode, FString& OutHeaderSource, FString& OutCppSource)
+{
+	BP_CONVERTER_PHASE_SCOPE(EmitCppCode);
 
-			auto& FunctionList = TFunctionListAccessor<FKismetCompilerContext>::Get(*CompilerContext.Get());
+	check(PreparedCode.ClassToEmit && PreparedCode.Backend.IsValid());
+	OutHeaderSource = PreparedCode.Backend->GenerateCodeFromClass(PreparedCode.ClassToEmit, PreparedCode.GetFunctions(), false, PreparedCode.NativizationOptions, OutCppSource);
 
-			DuplicateBP->bBeingCompiled = false;
+	if (PreparedCode.bIsInterface)
+	{
+		OutCppSource.Empty(); // ugly temp hack
+	}
+}
 
-			TUniquePtr<IBlueprintCompilerCppBackend> Backend_CPP(IBlueprintCompilerCppBackendModuleInterface::Get().Create());
-			*OutHeaderSource = Backend_CPP->GenerateCodeFromClass(DuplicateBP->GeneratedClass, FunctionList, false, FCompilerNativizationOptions(), *OutCppSource);
-		}
+//------------------------------------------------------------------------------
+FString FBlueprintNativeCodeGenUtils::ComputeConversionHash(UObject* Obj, const FCompilerNativizationOptions& NativizationOptions)
+{
+	UStruct* AssetStruct = Cast<UStruct>(Obj);
+	const UPackage* AssetPackage = AssetStruct ? AssetStruct->GetOutermost() : nullptr;
+	if (!AssetPackage || AssetPackage->GetSavedHash().IsZero())
+	{
+		return FString();
+	}
 
-		IKismetCompilerInterface& Compiler = FModuleManager::LoadModuleChecked<IKismetCompilerInterface>(KISMET_COMPILER_MODULENAME);
-		Compiler.RemoveBlueprintGeneratedClasses(DuplicateBP);
+	TSharedPtr<FGatherConvertedClassDependencies> Dependencies = FGatherConvertedClassDependencies::Get(AssetStruct, NativizationOptions);
+	if (!Dependencies.IsValid())
+	{
+		return FString();
+	}
 
-		if (EBlueprintType::BPTYPE_Interface == DuplicateBP->BlueprintType && OutCppSource.IsValid())
+	TSet<const UPackage*> DependencyPackages;
+	for (const UObject* Dependency : Dependencies->AllDependencies())
+	{
+		const UPackage* DependencyPackage = Dependency ? Dependency->GetOutermost() : nullptr;
+		// native code changes are not tracked, they require ConverterVersion to be bumped (or a full conversion)
+		if (DependencyPackage && (DependencyPackage != AssetPackage) && !DependencyPackage->HasAnyPackageFlags(PKG_CompiledIn))
 		{
-			OutCppSource->Empty(); // ugly temp hack
+			DependencyPackages.Add(DependencyPackage);
 		}
 	}
-	else if ((UDEnum || UDStruct) && OutHeaderSource.IsValid())
+	TArray<const UPackage*> SortedPackages = DependencyPackages.Array();
+	SortedPackages.Sort([](const UPackage& A, const UPackage& B)
 	{
-		// TODO @zhouminyi
-		BP_CONVERTER_DEBUG("GenerateCppCodeForEnum and GenerateCppCodeForStruct were removed!");
-
-		//IKismetCompilerInterface& Compiler = FModuleManager::LoadModuleChecked<IKismetCompilerInterface>(KISMET_COMPILER_MODULENAME);
-		//if (UDEnum)
-		//{
-		//	Compiler.GenerateCppCodeForEnum(UDEnum, NativizationOptions, *OutHeaderSource, *OutCppSource);
-		//}
-		//else if (UDStruct)
-		//{
-		//	Compiler.GenerateCppCodeForStruct(UDStruct, NativizationOptions, *OutHeaderSource, *OutCppSource);
-		//}
+		return A.GetFName().LexicalLess(B.GetFName());
+	});
+	SortedPackages.Insert(AssetPackage, 0);
+
+	FBlake3 Hasher;
+	const int32 Version = BlueprintNativeCodeGenUtilsImpl::ConverterVersion;
+	const uint32 OptionsHash = FGatherConvertedClassDependencies::HashNativizationOptions(NativizationOptions);
+	Hasher.Update(&Version, sizeof(Version));
+	Hasher.Update(&OptionsHash, sizeof(OptionsHash));
+	for (const UPackage* Package : SortedPackages)
+	{
+		const FIoHash SavedHash = Package->GetSavedHash();
+		if (SavedHash.IsZero())
+		{
+			// an unsaved dependency cannot be tracked, so the asset is always converted
+			return FString();
+		}
+		const FString PackageName = Package->GetName();
+		Hasher.Update(*PackageName, PackageName.Len() * sizeof(TCHAR));
+		Hasher.Update(SavedHash.GetBytes(), sizeof(FIoHash::ByteArray));
 	}
-	else
+	return LexToString(FIoHash(Hasher.Finalize()));
+}
+
+/*******************************************************************************
+ * FBlueprintNativeCodeGenFileWriter
+ ******************************************************************************/
+
+//------------------------------------------------------------------------------
+bool FBlueprintNativeCodeGenFileWriter::WriteFile(const FString& FilePath, const FString& Contents)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(BPConverter_WriteFile);
+
+	FString ExistingContents;
+	if (FFileHelper::LoadFileToString(ExistingContents, *FilePath, FFileHelper::EHashOptions::None, FILEREAD_Silent) && ExistingContents.Equals(Contents, ESearchCase::CaseSensitive))
 	{
-		ensure(false);
+		++SkippedCount;
+		TRACE_COUNTER_INCREMENT(BPConverter_FilesUnchanged);
+		return true;
 	}
+
+	if (!FFileHelper::SaveStringToFile(Contents, *FilePath))
+	{
+		UE_LOG(LogBlueprintCodeGen, Error, TEXT("Failed to save '%s'."), *FilePath);
+		return false;
+	}
+	++WrittenCount;
+	TRACE_COUNTER_INCREMENT(BPConverter_FilesWritten);
+	return true;
+}
+
+//------------------------------------------------------------------------------
+bool FBlueprintNativeCodeGenFileWriter::WriteGeneratedFile(const FString& FilePath, TFunctionRef<bool(const FString& StagingFilePath)> GenerateFile)
+{
+	const FString StagingFilePath = FPaths::Combine(*FPaths::ProjectIntermediateDir(), TEXT("BPConverter"), TEXT("Staging"), *FPaths::GetCleanFilename(FilePath));
+	ON_SCOPE_EXIT
+	{
+		IFileManager::Get().Delete(*StagingFilePath, /*bRequireExists =*/false, /*bEvenReadOnly =*/true, /*bQuiet =*/true);
+	};
+
+	FString Contents;
+	if (!GenerateFile(StagingFilePath) || !FFileHelper::LoadFileToString(Contents, *StagingFilePath))
+	{
+		return false;
+	}
+	return WriteFile(FilePath, Contents);
+}
+
+//------------------------------------------------------------------------------
+void FBlueprintNativeCodeGenFileWriter::DeleteStaleFiles(const TSet<FString>& StaleFiles)
+{
+	for (const FString& FilePath : StaleFiles)
+	{
+		if (!IFileManager::Get().FileExists(*FilePath))
+		{
+			continue;
+		}
+
+		if (IFileManager::Get().Delete(*FilePath))
+		{
+			++DeletedCount;
+		}
+		else
+		{
+			UE_LOG(LogBlueprintCodeGen, Warning, TEXT("Failed to delete the stale file '%s'."), *FilePath);
+		}
+	}
+}
+
+//------------------------------------------------------------------------------
+void FBlueprintNativeCodeGenFileWriter::LogSummary() const
+{
+	UE_LOG(LogBlueprintCodeGen, Display, TEXT("Generated files: %d written, %d unchanged, %d deleted."), WrittenCount.load(), SkippedCount.load(), DeletedCount.load());
+}
+
+//------------------------------------------------------------------------------
+FString FBlueprintNativeCodeGenFileWriter::GetComparablePath(const FString& FilePath)
+{
+	FString ComparablePath = FPaths::ConvertRelativePathToFull(FilePath);
+	FPaths::NormalizeFilename(ComparablePath);
+	return ComparablePath;
 }
 
 /*******************************************************************************
@@ -6,9 +6,13 @@
 #include "IBlueprintCompilerCppBackendModule.h"
 #include "Misc/FeedbackContext.h"
 #include "Engine/Blueprint.h" // for FCompilerNativizationOptions
+#include <atomic>
 
 class SBuildProgressWidget;
 struct FBlueprintNativeCodeGenManifest;
+class FKismetCompilerContext;
+class FCompilerResultsLog;
+class FBlueprintBytecodeTranslator;
 
 // Forward declares
 class  SBuildProgressWidget;
@@ -16,16 +20,63 @@ struct FBlueprintNativeCodeGenManifest;
 
 DECLARE_LOG_CATEGORY_EXTERN(LogBlueprintCodeGen, Log, All);
 
+/**
+ * Writes generated files, but leaves the ones whose contents didn't change 
+ * untouched. That keeps their timestamps, so UBT doesn't rebuild the module
+ * for nothing. Files can be written from multiple threads at once.
+ */
+class FBlueprintNativeCodeGenFileWriter
+{
+public:
+	/**
+	 * Saves the contents to the file, unless the file already holds the same contents.
+	 *
+	 * @return False if the file had to be saved, and saving failed.
+	 */
+	bool WriteFile(const FString& FilePath, const FString& Contents);
+
+	/**
+	 * For files produced by generators that can only save to disk (GameProjectUtils, etc.). 
+	 * The generator saves to a staging file, which is then passed through WriteFile().
+	 *
+	 * @param  FilePath			The destination of the generated file.
+	 * @param  GenerateFile		Saves the file to the path it is given, returns false on failure.
+	 * @return False if the file couldn't be generated or saved.
+	 */
+	bool WriteGeneratedFile(const FString& FilePath, TFunctionRef<bool(const FString& StagingFilePath)> GenerateFile);
+
+	/**
+	 * Deletes the files that are not generated anymore. Files that don't exist are ignored.
+	 *
+	 * @param  StaleFiles		Full, normalized paths of the files to delete.
+	 */
+	void DeleteStaleFiles(const TSet<FString>& StaleFiles);
+
+	/** Logs how many files were written, skipped and deleted. */
+	void LogSummary() const;
+
+	/** @return The full, normalized version of the path, as expected by DeleteStaleFiles(). */
+	static FString GetComparablePath(const FString& FilePath);
+
+private:
+	std::atomic<int32> WrittenCount { 0 };
+	std::atomic<int32> SkippedCount { 0 };
+	std::atomic<int32> DeletedCount { 0 };
+};
+
 /**  */
 struct FBlueprintNativeCodeGenUtils
 {
 public:
 	/**
 	 * Generated module build file, module source files, and plugin description file for the provided manifest.
+	 * Source files, that the previous manifest recorded for assets which don't exist anymore, are deleted.
 	 *
-	 * @param	Manifest		The manifest containing lists of converted files, etc
+	 * @param	Manifest			The manifest containing lists of converted files, etc
+	 * @param	PreviousManifest	The manifest saved by the previous conversion into the same plugin, if any.
+	 * @param	FileWriter			Writes the files (unchanged files are not touched).
 	 */
-	static bool FinalizePlugin(const FBlueprintNativeCodeGenManifest& Manifest);
+	static bool FinalizePlugin(const FBlueprintNativeCodeGenManifest& Manifest, const FBlueprintNativeCodeGenManifest* PreviousManifest, FBlueprintNativeCodeGenFileWriter& FileWriter);
 
 	/**
 	 * Recompiles the bytecode of a blueprint only. Should only be run for
@@ -37,6 +88,71 @@ public:
 	 */
 	static void GenerateCppCode(UObject* Obj, TSharedPtr<FString> OutHeaderSource, TSharedPtr<FString> OutCppSource, TSharedPtr<FNativizationSummary> NativizationSummary, const FCompilerNativizationOptions& NativizationOptions);
 
+	/**
+	 * A Blueprint class, compiled into the function contexts that code is emitted from. Nothing is 
+	 * modified after it was prepared, so the code can be emitted on any thread, as long as the game
+	 * thread doesn't compile or collect garbage meanwhile. Destroy it on the game thread, it releases
+	 * the duplicated Blueprint (when the class had to be recompiled).
+	 */
+	class FPreparedCppCode
+	{
+	public:
+		FPreparedCppCode();
+		~FPreparedCppCode();
+
+	private:
+		friend struct FBlueprintNativeCodeGenUtils;
+
+		TIndirectArray<FKismetFunctionContext>& GetFunctions();
+
+		UClass* ClassToEmit;
+		bool bIsInterface;
+		// The dependencies are gathered with them on the game thread, the code must be emitted with the same ones
+		FCompilerNativizationOptions NativizationOptions;
+		// Owns the functions of a class translated from its bytecode
+		TUniquePtr<FBlueprintBytecodeTranslator> Translator;
+		TIndirectArray<FKismetFunctionContext> TranslatedFunctions;
+		// Owns the functions of a recompiled class, they log to ResultsLog
+		TUniquePtr<FCompilerResultsLog> ResultsLog;
+		TSharedPtr<FKismetCompilerContext> CompilerContext;
+		UBlueprint* DuplicateBP;
+		UPackage* TempPackage;
+		// Created with the class, the constant calls are folded on the game thread
+		TUniquePtr<IBlueprintCompilerCppBackend> Backend;
+	};
+
+	/**
+	 * The game thread part of GenerateCppCode: translates the bytecode of the Blueprint, or compiles 
+	 * a duplicate of it, and evaluates the constant calls. See EmitCppCode for the rest.
+	 *
+	 * @param  Obj					The asset object that you want to generate source code for (see GenerateCppCode).
+	 * @param  NativizationOptions	The options the code will be emitted with (pass the same ones to ComputeConversionHash).
+	 * @return Null when the asset cannot be converted (errors are logged).
+	 */
+	static TUniquePtr<FPreparedCppCode> PrepareCppCode(UObject* Obj, TSharedPtr<FNativizationSummary> NativizationSummary, const FCompilerNativizationOptions& NativizationOptions);
+
+	/**
+	 * Emits the code of a prepared class, with the options it was prepared with. Can run on a worker 
+	 * thread, and for several classes at once.
+	 *
+	 * @param  PreparedCode		The class, see PrepareCppCode.
+	 * @param  OutHeaderSource	Output destination for the header source.
+	 * @param  OutCppSource		Output destination for the cpp source (empty for interfaces).
+	 */
+	static void EmitCppCode(FPreparedCppCode& PreparedCode, FString& OutHeaderSource, FString& OutCppSource);
+
+	/**
+	 * Hashes everything that the code generated for the asset depends on: the 
+	 * saved hash of its package and of the packages of all its dependencies, 
+	 * the converter version and the nativization options. When the hash did 
+	 * not change, the previously generated code is still valid.
+	 * 
+	 * @param  Obj					The asset object that you want to generate source code for (see GenerateCppCode).
+	 * @param  NativizationOptions	The options the code will be generated with.
+	 * @return The hash as a string, or an empty string when the asset (or any of its dependencies) was never saved.
+	 */
+	static FString ComputeConversionHash(UObject* Obj, const FCompilerNativizationOptions& NativizationOptions);
+
 public: 
 	/** 
 	 * A utility for catching errors/warnings that were logged in nested/scoped calls.
@@ -15,6 +15,7 @@
 #include "HAL/FileManager.h"
 #include "Misc/FileHelper.h"
 #include "Misc/ScopedSlowTask.h"
+#include "Misc/ScopeExit.h"
 #include "Misc/App.h"
 #include "Modules/ModuleManager.h"
 #include "Widgets/Layout/SBox.h"
@@ -64,25 +65,56 @@ struct FGeneratedCodeData
 	FString BaseFilename;
 	TWeakObjectPtr<UBlueprint> Blueprint;
 	TSet<UField*> DependentObjects;
+	// All the converted objects, each one after its dependencies
+	TArray<UField*> ConversionOrder;
 	TSet<UBlueprintGeneratedClass*> UnconvertedNeededClasses;
 
-	void GatherUserDefinedDependencies(UBlueprint& InBlueprint)
+	/** Appends the field to the ConversionOrder, after all (transitive) converted dependencies. */
+	void AddInDependencyOrder(UField* Field, TSet<UField*>& Visited)
 	{
-		FCompilerNativizationOptions BlankOptions{};
-		TSharedPtr<FGatherConvertedClassDependencies> ClassDependencies = FGatherConvertedClassDependencies::Get(InBlueprint.GeneratedClass, BlankOptions);
-		for (auto Iter : ClassDependencies->ConvertedClasses)
-		{
-			DependentObjects.Add(Iter);
-		}
-		for (auto Iter : ClassDependencies->ConvertedStructs)
+		bool bAlreadyVisited = false;
+		Visited.Add(Field, &bAlreadyVisited);
+		if (bAlreadyVisited)
 		{
-			DependentObjects.Add(Cast<UField>(Iter));
+			// Either already ordered, or a cycle. Generated headers forward declare the types, so a cycle can be broken anywhere.
+			return;
 		}
-		for (auto Iter : ClassDependencies->ConvertedEnum)
+
+		if (UStruct* Struct = Cast<UStruct>(Field))
 		{
-			DependentObjects.Add(Iter);
+			// cached, so each dependency graph is gathered once for the whole batch
+			TSharedPtr<FGatherConvertedClassDependencies> Dependencies = FGatherConvertedClassDependencies::Get(Struct, FCompilerNativizationOptions{});
+			for (UUserDefinedEnum* Enum : Dependencies->ConvertedEnum)
+			{
+				AddInDependencyOrder(Enum, Visited);
+			}
+			for (UUserDefinedStruct* DependentStruct : Dependencies->ConvertedStructs)
+			{
+				AddInDependencyOrder(DependentStruct, Visited);
+			}
+			for (UBlueprintGeneratedClass* Class : Dependencies->ConvertedClasses)
+			{
+				AddInDependencyOrder(Class, Visited);
+			}
+			for (UObject* Asset : Dependencies->Assets)
+			{
+				if (UBlueprintGeneratedClass* BPGC = Cast<UBlueprintGeneratedClass>(Asset))
+				{
+					UnconvertedNeededClasses.Add(BPGC);
+				}
+			}
 		}
 
+		ConversionOrder.Add(Field);
+	}
+
+	void GatherUserDefinedDependencies(UBlueprint& InBlueprint)
+	{
+		TSet<UField*> Visited;
+		AddInDependencyOrder(InBlueprint.GeneratedClass, Visited);
+		DependentObjects.Append(ConversionOrder);
+		DependentObjects.Remove(InBlueprint.GeneratedClass);
+
 		if (DependentObjects.Num())
 		{
 			TypeDependencies = LOCTEXT("ConvertedDependencies", "Detected Dependencies:\n").ToString();
@@ -92,25 +124,25 @@ struct FGeneratedCodeData
 			TypeDependencies = LOCTEXT("NoConvertedAssets", "No dependencies found.\n").ToString();
 		}
 
-		for (auto Obj : DependentObjects)
+		// listed in the order they will be converted
+		for (UField* Obj : ConversionOrder)
 		{
-			TypeDependencies += FString::Printf(TEXT("%s \t%s\n"), *Obj->GetClass()->GetName(), *Obj->GetPathName());
+			if (Obj != InBlueprint.GeneratedClass)
+			{
+				TypeDependencies += FString::Printf(TEXT("%s \t%s\n"), *Obj->GetClass()->GetName(), *Obj->GetPathName());
+			}
 		}
 		DependentObjects.Add(InBlueprint.GeneratedClass);
 
 		bool bUnconvertedHeader = false;
-		for (auto Asset : ClassDependencies->Assets)
+		for (UBlueprintGeneratedClass* BPGC : UnconvertedNeededClasses)
 		{
-			if (auto BPGC = Cast<UBlueprintGeneratedClass>(Asset))
+			if (!bUnconvertedHeader)
 			{
-				UnconvertedNeededClasses.Add(BPGC);
-				if (!bUnconvertedHeader)
-				{
-					bUnconvertedHeader = true;
-					TypeDependencies += LOCTEXT("NoConvertedDependencies", "\nUnconverted Dependencies, that require a warpper struct:\n").ToString();
-				}
-				TypeDependencies += FString::Printf(TEXT("%s \t%s\n"), *BPGC->GetClass()->GetName(), *BPGC->GetPathName());
+				bUnconvertedHeader = true;
+				TypeDependencies += LOCTEXT("NoConvertedDependencies", "\nUnconverted Dependencies, that require a warpper struct:\n").ToString();
 			}
+			TypeDependencies += FString::Printf(TEXT("%s \t%s\n"), *BPGC->GetClass()->GetName(), *BPGC->GetPathName());
 		}
 	}
 
@@ -143,28 +175,40 @@ struct FGeneratedCodeData
 			return false;
 		}
 
-		const int WorkParts = 3 +(4 * DependentObjects.Num());
+		const int WorkParts = 1 + (3 * ConversionOrder.Num());
 		FScopedSlowTask SlowTask(WorkParts, LOCTEXT("GeneratingCppFiles", "Generating C++ files.."));
 		SlowTask.MakeDialog();
 
 		IBlueprintCompilerCppBackendModule& CodeGenBackend = (IBlueprintCompilerCppBackendModule&)IBlueprintCompilerCppBackendModule::Get();
+		ON_SCOPE_EXIT
+		{
+			CodeGenBackend.NativizationSummary().Reset();
+		};
+		// shared by the whole batch, like in the commandlet
+		TSharedPtr<FNativizationSummary> NativizationSummary(new FNativizationSummary());
 
+		FBlueprintNativeCodeGenFileWriter FileWriter;
 		TArray<FString> CreatedFiles;
-		//for(auto Obj : DependentObjects)
-		UObject* Obj = Blueprint->GeneratedClass;
+		for (UField* Obj : ConversionOrder)
 		{
-			SlowTask.EnterProgressFrame();
+			SlowTask.EnterProgressFrame(1.0f, FText::Format(LOCTEXT("GeneratingFmt", "Generating {0}.."), FText::FromString(Obj->GetName())));
 
 			TSharedPtr<FString> HeaderSource(new FString());
 			TSharedPtr<FString> CppSource(new FString());
-			TSharedPtr<FNativizationSummary> NativizationSummary(new FNativizationSummary());
 			FBlueprintNativeCodeGenUtils::GenerateCppCode(Obj, HeaderSource, CppSource, NativizationSummary, FCompilerNativizationOptions{});
 			SlowTask.EnterProgressFrame();
 
+			if (HeaderSource->IsEmpty())
+			{
+				// nothing generated (e.g. user defined structs and enums), don't leave empty files behind
+				SlowTask.EnterProgressFrame();
+				continue;
+			}
+
 			const FString BackendBaseFilename = CodeGenBackend.ConstructBaseFilename(Obj, FCompilerNativizationOptions{});
 
 			const FString FullHeaderFilename = FPaths::Combine(*HeaderDirPath, *(BackendBaseFilename + TEXT(".h")));
-			const bool bHeaderSaved = FFileHelper::SaveStringToFile(*HeaderSource, *FullHeaderFilename);
+			const bool bHeaderSaved = FileWriter.WriteFile(FullHeaderFilename, *HeaderSource);
 			if (!bHeaderSaved)
 			{
 				ErrorString += FText::Format(LOCTEXT("HeaderNotSavedFmt", "Header file wasn't saved. Check log for details. {0}\n"), FText::FromString(Obj->GetPathName())).ToString();
@@ -178,7 +222,7 @@ struct FGeneratedCodeData
 			if (!CppSource->IsEmpty())
 			{
 				const FString NewCppFilename = FPaths::Combine(*CppDirPath, *(BackendBaseFilename + TEXT(".cpp")));
-				const bool bCppSaved = FFileHelper::SaveStringToFile(*CppSource, *NewCppFilename);
+				const bool bCppSaved = FileWriter.WriteFile(NewCppFilename, *CppSource);
 				if (!bCppSaved)
 				{
 					ErrorString += FText::Format(LOCTEXT("CppNotSavedFmt", "Cpp file wasn't saved. Check log for details. {0}\n"), FText::FromString(Obj->GetPathName())).ToString();
@@ -191,6 +235,7 @@ struct FGeneratedCodeData
 		}
 
 		SlowTask.EnterProgressFrame();
+		FileWriter.LogSummary();
 
 		bool bSuccess = ErrorString.IsEmpty();
 		if (bSuccess && CreatedFiles.Num() > 0)